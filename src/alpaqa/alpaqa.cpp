@@ -225,10 +225,12 @@ PYBIND11_MODULE(ALPAQA_MODULE_NAME, m) {
         .def(py::pickle(
             [](const alpaqa::EvalCounter::EvalTimer &p) { // __getstate__
                 return py::make_tuple(p.f, p.grad_f, p.g, p.grad_g_prod,
-                                      p.grad_gi, p.hess_L_prod, p.hess_L);
+                                      p.grad_gi, p.hess_L_prod, p.hess_L,
+                                      p.f_grad_f, p.grad_L, p.ψ, p.ψ_grad_ψ,
+                                      p.hess_ψ_prod, p.jac_g, p.hess_L_sparse);
             },
             [](py::tuple t) { // __setstate__
-                if (t.size() != 7)
+                if (t.size() != 14)
                     throw std::runtime_error("Invalid state!");
                 using T = alpaqa::EvalCounter::EvalTimer;
                 return T{
@@ -239,6 +241,13 @@ PYBIND11_MODULE(ALPAQA_MODULE_NAME, m) {
                     py::cast<decltype(T::grad_gi)>(t[4]),
                     py::cast<decltype(T::hess_L_prod)>(t[5]),
                     py::cast<decltype(T::hess_L)>(t[6]),
+                    py::cast<decltype(T::f_grad_f)>(t[7]),
+                    py::cast<decltype(T::grad_L)>(t[8]),
+                    py::cast<decltype(T::ψ)>(t[9]),
+                    py::cast<decltype(T::ψ_grad_ψ)>(t[10]),
+                    py::cast<decltype(T::hess_ψ_prod)>(t[11]),
+                    py::cast<decltype(T::jac_g)>(t[12]),
+                    py::cast<decltype(T::hess_L_sparse)>(t[13]),
                 };
             }))
         .def_readwrite("f", &alpaqa::EvalCounter::EvalTimer::f)
@@ -247,7 +256,15 @@ PYBIND11_MODULE(ALPAQA_MODULE_NAME, m) {
         .def_readwrite("grad_g_prod", &alpaqa::EvalCounter::EvalTimer::grad_g_prod)
         .def_readwrite("grad_gi", &alpaqa::EvalCounter::EvalTimer::grad_gi)
         .def_readwrite("hess_L_prod", &alpaqa::EvalCounter::EvalTimer::hess_L_prod)
-        .def_readwrite("hess_L", &alpaqa::EvalCounter::EvalTimer::hess_L);
+        .def_readwrite("hess_L", &alpaqa::EvalCounter::EvalTimer::hess_L)
+        .def_readwrite("f_grad_f", &alpaqa::EvalCounter::EvalTimer::f_grad_f)
+        .def_readwrite("grad_L", &alpaqa::EvalCounter::EvalTimer::grad_L)
+        .def_readwrite("psi", &alpaqa::EvalCounter::EvalTimer::ψ)
+        .def_readwrite("psi_grad_psi", &alpaqa::EvalCounter::EvalTimer::ψ_grad_ψ)
+        .def_readwrite("hess_psi_prod", &alpaqa::EvalCounter::EvalTimer::hess_ψ_prod)
+        .def_readwrite("jac_g", &alpaqa::EvalCounter::EvalTimer::jac_g)
+        .def_readwrite("hess_L_sparse",
+                       &alpaqa::EvalCounter::EvalTimer::hess_L_sparse);
 
     py::class_<alpaqa::EvalCounter>(m, "EvalCounter",
                                 "C++ documentation: "
@@ -256,10 +273,12 @@ PYBIND11_MODULE(ALPAQA_MODULE_NAME, m) {
             [](const alpaqa::EvalCounter &p) { // __getstate__
                 return py::make_tuple(p.f, p.grad_f, p.g, p.grad_g_prod,
                                       p.grad_gi, p.hess_L_prod, p.hess_L,
+                                      p.f_grad_f, p.grad_L, p.ψ, p.ψ_grad_ψ,
+                                      p.hess_ψ_prod, p.jac_g, p.hess_L_sparse,
                                       p.time);
             },
             [](py::tuple t) { // __setstate__
-                if (t.size() != 8)
+                if (t.size() != 15)
                     throw std::runtime_error("Invalid state!");
                 using T = alpaqa::EvalCounter;
                 return T{
@@ -270,7 +289,14 @@ PYBIND11_MODULE(ALPAQA_MODULE_NAME, m) {
                     py::cast<decltype(T::grad_gi)>(t[4]),
                     py::cast<decltype(T::hess_L_prod)>(t[5]),
                     py::cast<decltype(T::hess_L)>(t[6]),
-                    py::cast<decltype(T::time)>(t[7]),
+                    py::cast<decltype(T::f_grad_f)>(t[7]),
+                    py::cast<decltype(T::grad_L)>(t[8]),
+                    py::cast<decltype(T::ψ)>(t[9]),
+                    py::cast<decltype(T::ψ_grad_ψ)>(t[10]),
+                    py::cast<decltype(T::hess_ψ_prod)>(t[11]),
+                    py::cast<decltype(T::jac_g)>(t[12]),
+                    py::cast<decltype(T::hess_L_sparse)>(t[13]),
+                    py::cast<decltype(T::time)>(t[14]),
                 };
             }))
         .def_readwrite("f", &alpaqa::EvalCounter::f)
@@ -280,6 +306,13 @@ PYBIND11_MODULE(ALPAQA_MODULE_NAME, m) {
         .def_readwrite("grad_gi", &alpaqa::EvalCounter::grad_gi)
         .def_readwrite("hess_L_prod", &alpaqa::EvalCounter::hess_L_prod)
         .def_readwrite("hess_L", &alpaqa::EvalCounter::hess_L)
+        .def_readwrite("f_grad_f", &alpaqa::EvalCounter::f_grad_f)
+        .def_readwrite("grad_L", &alpaqa::EvalCounter::grad_L)
+        .def_readwrite("psi", &alpaqa::EvalCounter::ψ)
+        .def_readwrite("psi_grad_psi", &alpaqa::EvalCounter::ψ_grad_ψ)
+        .def_readwrite("hess_psi_prod", &alpaqa::EvalCounter::hess_ψ_prod)
+        .def_readwrite("jac_g", &alpaqa::EvalCounter::jac_g)
+        .def_readwrite("hess_L_sparse", &alpaqa::EvalCounter::hess_L_sparse)
         .def_readwrite("time", &alpaqa::EvalCounter::time);
 
     py::class_<alpaqa::ProblemWithCounters<alpaqa::Problem>, alpaqa::Problem>(
@@ -375,7 +408,9 @@ PYBIND11_MODULE(ALPAQA_MODULE_NAME, m) {
         .def_readwrite("memory", &alpaqa::LBFGSParams::memory)
         .def_readwrite("cbfgs", &alpaqa::LBFGSParams::cbfgs)
         .def_readwrite("rescale_when_γ_changes",
-                       &alpaqa::LBFGSParams::rescale_when_γ_changes);
+                       &alpaqa::LBFGSParams::rescale_when_γ_changes)
+        .def_readwrite("packed_subspace",
+                       &alpaqa::LBFGSParams::packed_subspace);
 
     py::class_<alpaqa::PolymorphicLBFGSDirection,
                std::shared_ptr<alpaqa::PolymorphicLBFGSDirection>,
@@ -430,7 +465,18 @@ PYBIND11_MODULE(ALPAQA_MODULE_NAME, m) {
                        &alpaqa::PANOCParams::update_lipschitz_in_linesearch)
         .def_readwrite("alternative_linesearch_cond",
                        &alpaqa::PANOCParams::alternative_linesearch_cond)
-        .def_readwrite("lbfgs_stepsize", &alpaqa::PANOCParams::lbfgs_stepsize);
+        .def_readwrite("lbfgs_stepsize", &alpaqa::PANOCParams::lbfgs_stepsize)
+        .def_readwrite("keep_direction_history",
+                       &alpaqa::PANOCParams::keep_direction_history)
+        .def_readwrite(
+            "keep_direction_history_max_Σ_increase",
+            &alpaqa::PANOCParams::keep_direction_history_max_Σ_increase)
+        .def_readwrite("reuse_lipschitz_estimate",
+                       &alpaqa::PANOCParams::reuse_lipschitz_estimate)
+        .def_readwrite("linesearch_parallel_candidates",
+                       &alpaqa::PANOCParams::linesearch_parallel_candidates)
+        .def_readwrite("concurrent_evaluations",
+                       &alpaqa::PANOCParams::concurrent_evaluations);
 
     py::enum_<alpaqa::SolverStatus>(
         m, "SolverStatus", py::arithmetic(),
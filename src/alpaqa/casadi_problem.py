@@ -18,13 +18,21 @@ def generate_casadi_problem(
     g: cs.Function,
     second_order: bool = False,
     name: str = "alpaqa_problem",
+    psi_grad_psi: bool = True,
+    jac_g: bool = True,
 ) -> Tuple[cs.CodeGenerator, int, int, int]:
     """Convert the objective and constraint functions into a CasADi code
     generator.
 
     :param f:            Objective function.
     :param g:            Constraint function.
-    :param second_order: Whether to generate functions for evaluating Hessians.
+    :param second_order: Whether to generate functions for evaluating Hessians
+                         (of the Lagrangian and of the augmented Lagrangian).
+    :param psi_grad_psi: Whether to generate functions that evaluate the
+                         augmented Lagrangian and the vector ŷ, with and
+                         without its gradient, in a single call.
+    :param jac_g:        Whether to generate a function that evaluates the
+                         sparse Jacobian of the constraints.
     :param name: Optional string description of the problem (used for filename).
 
     :return:   * Code generator that generates the functions and derivatives
@@ -50,6 +58,9 @@ def generate_casadi_problem(
     x = xp[0]
     y = cs.SX.sym("y", m)
     v = cs.SX.sym("v", n)
+    Sigma = cs.SX.sym("Sigma", m)
+    zl = cs.SX.sym("zl", m)
+    zu = cs.SX.sym("zu", m)
 
     L = f(*xp) + cs.dot(y, g(*xp)) if m > 0 else f(*xp)
 
@@ -102,6 +113,58 @@ def generate_casadi_problem(
                 [*xp_names, "y", "v"],
                 ["hess_L_prod"],
             ))
+        if m > 0:
+            zeta = g(*xp) + y / Sigma
+            d = zeta - cs.fmin(cs.fmax(zeta, zl), zu)
+            psi = f(*xp) + 0.5 * cs.dot(d, Sigma * d)
+        else:
+            psi = f(*xp)
+        cg.add(
+            cs.Function(
+                "hess_psi_prod",
+                [*xp, y, Sigma, zl, zu, v],
+                [cs.gradient(cs.jtimes(psi, x, v, False), x)],
+                [*xp_names, "y", "Sigma", "zl", "zu", "v"],
+                ["hess_psi_prod"],
+            ))
+    if jac_g:
+        cg.add(
+            cs.Function(
+                "jac_g",
+                [*xp],
+                [cs.jacobian(g(*xp), x)],
+                [*xp_names],
+                ["jac_g"],
+            ))
+    if psi_grad_psi:
+        fx = f(*xp)
+        if m > 0:
+            gx = g(*xp)
+            zeta = gx + y / Sigma
+            d = zeta - cs.fmin(cs.fmax(zeta, zl), zu)
+            yhat = Sigma * d
+            psi = fx + 0.5 * cs.dot(d, yhat)
+            grad_psi = cs.gradient(fx, x) + cs.jtimes(gx, x, yhat, True)
+        else:
+            yhat = cs.SX(0, 1)
+            psi = fx
+            grad_psi = cs.gradient(fx, x)
+        cg.add(
+            cs.Function(
+                "psi_grad_psi",
+                [*xp, y, Sigma, zl, zu],
+                [psi, grad_psi, yhat],
+                [*xp_names, "y", "Sigma", "zl", "zu"],
+                ["psi", "grad_psi", "yhat"],
+            ))
+        cg.add(
+            cs.Function(
+                "psi",
+                [*xp, y, Sigma, zl, zu],
+                [psi, yhat],
+                [*xp_names, "y", "Sigma", "zl", "zu"],
+                ["psi", "yhat"],
+            ))
     return cg, n, m, p
 
 
@@ -118,12 +181,20 @@ def generate_and_compile_casadi_problem(
     g: cs.Function,
     second_order: bool = False,
     name: str = "alpaqa_problem",
+    psi_grad_psi: bool = True,
+    jac_g: bool = True,
 ) -> Union[pa.Problem, pa.ProblemWithParam]:
     """Compile the objective and constraint functions into a alpaqa Problem.
 
     :param f:            Objective function.
     :param g:            Constraint function.
-    :param second_order: Whether to generate functions for evaluating Hessians.
+    :param second_order: Whether to generate functions for evaluating Hessians
+                         (of the Lagrangian and of the augmented Lagrangian).
+    :param psi_grad_psi: Whether to generate functions that evaluate the
+                         augmented Lagrangian and the vector ŷ, with and
+                         without its gradient, in a single call.
+    :param jac_g:        Whether to generate a function that evaluates the
+                         sparse Jacobian of the constraints.
     :param name: Optional string description of the problem (used for filename).
 
     :return:   * Problem specification that can be passed to the solvers.
@@ -139,7 +210,7 @@ def generate_and_compile_casadi_problem(
     cachefile = join(cachedir, 'problems')
 
     key = base64.b64encode(pickle.dumps(
-        (f, g, second_order, name))).decode('ascii')
+        (f, g, second_order, name, psi_grad_psi, jac_g))).decode('ascii')
 
     os.makedirs(cachedir, exist_ok=True)
     with shelve.open(cachefile) as cache:
@@ -159,7 +230,8 @@ def generate_and_compile_casadi_problem(
         builddir = join(projdir, "build")
         os.makedirs(builddir, exist_ok=True)
         probdir = join(cachedir, str(uid))
-        cgen, n, m, p = generate_casadi_problem(f, g, second_order, name)
+        cgen, n, m, p = generate_casadi_problem(f, g, second_order, name,
+                                                psi_grad_psi, jac_g)
         cfile = cgen.generate(join(projdir, ""))
         with open(join(projdir, 'CMakeLists.txt'), 'w') as f:
             f.write(f"""
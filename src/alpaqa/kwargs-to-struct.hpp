@@ -129,6 +129,16 @@ inline const kwargs_to_struct_table_t<alpaqa::PANOCParams>
         {"alternative_linesearch_cond",
          &alpaqa::PANOCParams::alternative_linesearch_cond},
         {"lbfgs_stepsize", &alpaqa::PANOCParams::lbfgs_stepsize},
+        {"keep_direction_history",
+         &alpaqa::PANOCParams::keep_direction_history},
+        {"keep_direction_history_max_Σ_increase",
+         &alpaqa::PANOCParams::keep_direction_history_max_Σ_increase},
+        {"reuse_lipschitz_estimate",
+         &alpaqa::PANOCParams::reuse_lipschitz_estimate},
+        {"linesearch_parallel_candidates",
+         &alpaqa::PANOCParams::linesearch_parallel_candidates},
+        {"concurrent_evaluations",
+         &alpaqa::PANOCParams::concurrent_evaluations},
     };
 
 template <>
@@ -216,6 +226,7 @@ inline const kwargs_to_struct_table_t<alpaqa::LBFGSParams>
         {"memory", &alpaqa::LBFGSParams::memory},
         {"cbfgs", &alpaqa::LBFGSParams::cbfgs},
         {"rescale_when_γ_changes", &alpaqa::LBFGSParams::rescale_when_γ_changes},
+        {"packed_subspace", &alpaqa::LBFGSParams::packed_subspace},
     };
 
 template <>
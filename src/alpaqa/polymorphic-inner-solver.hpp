@@ -339,8 +339,16 @@ class PolymorphicInnerSolver : public PolymorphicInnerSolverBase {
         rvec y,
         /// [out]   Slack variable error @f$ g(x) - z @f$
         rvec err_z) override {
-        auto stats =
-            innersolver(problem, Σ, ε, always_overwrite_results, x, y, err_z);
+        typename InnerSolver::Stats stats;
+        {
+            // The solver itself doesn't need the GIL, the Python callbacks
+            // (problem functions, directions, progress callbacks and output
+            // redirection) acquire it again when they're called. This allows
+            // the solver to call them from other threads without deadlocking.
+            py::gil_scoped_release release;
+            stats = innersolver(problem, Σ, ε, always_overwrite_results, x, y,
+                                err_z);
+        }
         return {
             std::static_pointer_cast<PolymorphicInnerSolverStatsBase>(
                 std::make_shared<WrappedStats>(stats)),
@@ -5,6 +5,7 @@
 
 #include <iomanip>
 #include <iostream>
+#include <utility>
 
 namespace alpaqa {
 
@@ -14,41 +15,92 @@ using std::chrono::microseconds;
 template <class InnerSolverT>
 typename ALMSolver<InnerSolverT>::Stats
 ALMSolver<InnerSolverT>::operator()(const Problem &problem, rvec y, rvec x) {
+    return solve(problem, y, x, nullptr);
+}
+
+template <class InnerSolverT>
+typename ALMSolver<InnerSolverT>::Stats
+ALMSolver<InnerSolverT>::operator()(const Problem &problem, rvec y, rvec x,
+                                    State &state) {
+    return solve(problem, y, x, &state);
+}
+
+template <class InnerSolverT>
+void ALMSolver<InnerSolverT>::save_state(State &state, crvec Σ, real_t ε,
+                                         real_t Δ) const {
+    state.Σ = Σ;
+    state.ε = ε;
+    state.Δ = Δ;
+    if constexpr (inner_warm_start<InnerSolver>::supported)
+        inner_solver.get_warm_start(state.inner);
+    state.valid = true;
+}
+
+template <class InnerSolverT>
+template <class ProblemT>
+typename ALMSolver<InnerSolverT>::Stats
+ALMSolver<InnerSolverT>::solve(const ProblemT &problem, rvec y, rvec x,
+                               State *state) {
     auto start_time = std::chrono::steady_clock::now();
 
+    if (not params.preconditioning)
+        return solve_unpreconditioned(problem, y, x, state, start_time);
+
+    auto &prec = work.prec;
+    detail::apply_preconditioning(problem, x, prec);
+    auto s = solve_unpreconditioned(prec.problem, y, x, state, start_time);
+    y      = prec.g.asDiagonal() * y / prec.f;
+    return s;
+}
+
+template <class InnerSolverT>
+template <class ProblemT>
+typename ALMSolver<InnerSolverT>::Stats
+ALMSolver<InnerSolverT>::solve_unpreconditioned(
+    const ProblemT &p, rvec y, rvec x, State *state,
+    std::chrono::steady_clock::time_point start_time) {
+
+    // The workspace is only reallocated when the number of constraints
+    // changes, so subsequent solves of the same problem don't allocate.
     constexpr auto sigNaN = std::numeric_limits<real_t>::signaling_NaN();
-    vec Σ                 = vec::Constant(problem.m, sigNaN);
-    vec Σ_old             = vec::Constant(problem.m, sigNaN);
-    vec error₁            = vec::Constant(problem.m, sigNaN);
-    vec error₂            = vec::Constant(problem.m, sigNaN);
-    real_t norm_e₁        = sigNaN;
-    real_t norm_e₂        = sigNaN;
+    work.resize(p.m);
+    auto &Σ = work.Σ, &Σ_old = work.Σ_old;
+    auto &error₁ = work.error₁, &error₂ = work.error₂;
+    for (vec *v : {&Σ, &Σ_old, &error₁, &error₂})
+        v->fill(sigNaN);
+    real_t norm_e₁ = sigNaN;
+    real_t norm_e₂ = sigNaN;
 
     Stats s;
 
-    Problem prec_problem;
-    real_t prec_f;
-    vec prec_g;
-
-    if (params.preconditioning)
-        detail::apply_preconditioning(problem, prec_problem, x, prec_f, prec_g);
-    const auto &p = params.preconditioning ? prec_problem : problem;
+    real_t ε                   = params.ε₀;
+    real_t ε_old               = sigNaN;
+    real_t Δ                   = params.Δ;
+    real_t ρ                   = params.ρ;
+    bool first_successful_iter = true;
 
+    // Continue from the state of a previous solve
+    bool warm_start = state && state->valid && state->Σ.size() == Σ.size();
+    // Otherwise, the inner solver doesn't continue from an earlier solve
+    if constexpr (inner_warm_start<InnerSolver>::supported)
+        if (not warm_start)
+            inner_solver.reset_warm_start();
+    if (warm_start) {
+        Σ = state->Σ;
+        ε = state->ε;
+        Δ = state->Δ;
+        if constexpr (inner_warm_start<InnerSolver>::supported)
+            inner_solver.set_warm_start(state->inner);
+    }
     // Initialize the penalty weights
-    if (params.Σ₀ > 0) {
+    else if (params.Σ₀ > 0) {
         Σ.fill(params.Σ₀);
     }
     // Initial penalty weights from problem
     else {
-        detail::initialize_penalty(p, params, x, Σ);
+        detail::initialize_penalty(p, params, x, Σ, error₁);
     }
 
-    real_t ε                   = params.ε₀;
-    real_t ε_old               = sigNaN;
-    real_t Δ                   = params.Δ;
-    real_t ρ                   = params.ρ;
-    bool first_successful_iter = true;
-
     for (unsigned int i = 0; i < params.max_iter; ++i) {
         // TODO: this is unnecessary when the previous iteration lowered the
         // penalty update factor.
@@ -106,8 +158,8 @@ ALMSolver<InnerSolverT>::operator()(const Problem &problem, rvec y, rvec x) {
             s.outer_iterations = i + 1;
             s.elapsed_time     = duration_cast<microseconds>(time_elapsed);
             s.status           = ps.status;
-            if (params.preconditioning)
-                y = prec_g.asDiagonal() * y / prec_f;
+            if (state)
+                save_state(*state, Σ, ε, Δ);
             return s;
         }
 
@@ -154,7 +206,9 @@ ALMSolver<InnerSolverT>::operator()(const Problem &problem, rvec y, rvec x) {
             // Check the termination criteria
             bool alm_converged =
                 ps.ε <= params.ε && inner_converged && norm_e₁ <= params.δ;
-            bool exit = alm_converged || out_of_iter || out_of_time;
+            bool interrupted = stop_signal.stop_requested();
+            bool exit = alm_converged || out_of_iter || out_of_time ||
+                        interrupted;
             if (exit) {
                 s.ε                = ps.ε;
                 s.δ                = norm_e₁;
@@ -164,9 +218,10 @@ ALMSolver<InnerSolverT>::operator()(const Problem &problem, rvec y, rvec x) {
                 s.status           = alm_converged ? SolverStatus::Converged
                                      : out_of_time ? SolverStatus::MaxTime
                                      : out_of_iter ? SolverStatus::MaxIter
+                                     : interrupted ? SolverStatus::Interrupted
                                                    : SolverStatus::Unknown;
-                if (params.preconditioning)
-                    y = prec_g.asDiagonal() * y / prec_f;
+                if (state)
+                    save_state(*state, Σ, ε, Δ);
                 return s;
             }
             // After this line, Σ_old contains the penalty used in the current
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <alpaqa/alm.hpp>
+#include <alpaqa/decl/batch-alm.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <exception>
+#include <thread>
+
+namespace alpaqa {
+
+template <class InnerSolverT>
+template <class ProblemT>
+std::vector<typename BatchALMSolver<InnerSolverT>::Stats>
+BatchALMSolver<InnerSolverT>::operator()(const ProblemT &problem, crmat param,
+                                         rmat y, rmat x) {
+    const auto N = static_cast<size_t>(param.cols());
+    assert(x.cols() == param.cols() && x.rows() == problem.n);
+    assert(y.cols() == param.cols() && y.rows() == problem.m);
+    std::vector<Stats> stats(N);
+    if (N == 0)
+        return stats;
+
+    const size_t chunk_size = std::max(params.chunk_size, 1u);
+    const size_t num_chunks = (N + chunk_size - 1) / chunk_size;
+    size_t num_threads      = params.num_threads;
+    if (num_threads == 0)
+        num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    num_threads = std::min(num_threads, num_chunks);
+
+    // Range of chunks that haven't been claimed yet, for each worker. The
+    // owner takes chunks from the front, other workers steal from the back.
+    struct ChunkRange {
+        std::mutex mtx;
+        size_t begin, end;
+    };
+    std::vector<ChunkRange> ranges(num_threads);
+    for (size_t w = 0; w < num_threads; ++w) {
+        ranges[w].begin = num_chunks * w / num_threads;
+        ranges[w].end   = num_chunks * (w + 1) / num_threads;
+    }
+    auto claim_chunk = [&](size_t w, size_t &chunk) {
+        {
+            std::lock_guard<std::mutex> lck{ranges[w].mtx};
+            if (ranges[w].begin < ranges[w].end) {
+                chunk = ranges[w].begin++;
+                return true;
+            }
+        }
+        if (not params.work_stealing)
+            return false;
+        for (size_t i = 1; i < num_threads; ++i) {
+            auto &victim = ranges[(w + i) % num_threads];
+            std::lock_guard<std::mutex> lck{victim.mtx};
+            if (victim.begin < victim.end) {
+                chunk = --victim.end;
+                return true;
+            }
+        }
+        return false;
+    };
+
+    {
+        std::lock_guard<std::mutex> lck{workers_mtx};
+        workers.clear();
+        workers.reserve(num_threads);
+        for (size_t w = 0; w < num_threads; ++w)
+            workers.emplace_back(solver);
+    }
+
+    std::atomic<bool> failed{false};
+    std::exception_ptr first_error;
+    std::mutex error_mtx;
+
+    auto work = [&](size_t w) {
+        try {
+            // Every worker needs its own copy of the problem, because the
+            // parameters (and any other internal state) are not shared
+            ProblemT p(problem);
+            size_t chunk;
+            while (claim_chunk(w, chunk)) {
+                size_t first = chunk * chunk_size;
+                size_t last  = std::min(first + chunk_size, N);
+                for (size_t i = first; i < last; ++i) {
+                    if (stop_signal.stop_requested() || failed) {
+                        stats[i].status = SolverStatus::Interrupted;
+                        continue;
+                    }
+                    p.set_param(crvec{param.col(i)});
+                    // Solved without a warm-start state, so the inner solver
+                    // doesn't carry anything over from the previous instance
+                    // (the result doesn't depend on the chunking)
+                    stats[i] = workers[w](p, y.col(i), x.col(i));
+                }
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lck{error_mtx};
+            if (not first_error)
+                first_error = std::current_exception();
+            failed = true;
+        }
+    };
+
+    // The calling thread acts as the first worker
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads - 1);
+    for (size_t w = 1; w < num_threads; ++w)
+        threads.emplace_back(work, w);
+    work(0);
+    for (auto &t : threads)
+        t.join();
+
+    {
+        std::lock_guard<std::mutex> lck{workers_mtx};
+        workers.clear();
+    }
+    if (first_error)
+        std::rethrow_exception(first_error);
+    return stats;
+}
+
+template <class InnerSolverT>
+void BatchALMSolver<InnerSolverT>::stop() {
+    stop_signal.stop();
+    std::lock_guard<std::mutex> lck{workers_mtx};
+    for (auto &w : workers)
+        w.stop();
+}
+
+} // namespace alpaqa
@@ -1,11 +1,14 @@
 #pragma once
 
 #include <alpaqa/inner/decl/panoc-fwd.hpp>
+#include <alpaqa/util/atomic_stop_signal.hpp>
 #include <alpaqa/util/problem.hpp>
 #include <alpaqa/util/solverstatus.hpp>
+#include <alpaqa/util/sparse-jacobian.hpp>
 
 #include <chrono>
 #include <string>
+#include <type_traits>
 
 namespace alpaqa {
 
@@ -75,6 +78,45 @@ struct ALMParams {
     bool single_penalty_factor = false;
 };
 
+namespace detail {
+
+/// Preconditioned problem and its scaling factors, see
+/// @ref ALMParams::preconditioning and @ref apply_preconditioning.
+struct Preconditioning {
+    /// The scaled problem, which refers to the original problem and to the
+    /// scaling factors below.
+    Problem problem;
+    /// Scaling factor of the cost function.
+    real_t f = 1;
+    /// Scaling factors of the constraints.
+    vec g;
+    /// Work vectors used to compute the scaling factors.
+    vec grad_f, v, grad_g;
+    /// Work vectors of the scaled functions. Each function has its own, so
+    /// different functions can be evaluated at the same time.
+    vec grad_g_prod_v, grad_L_y, ψ_y, ψ_Σ, ψ_grad_ψ_y, ψ_grad_ψ_Σ;
+    /// Work storage for the sparse Jacobian (if provided by the problem).
+    SparseJacobian jac;
+};
+
+} // namespace detail
+
+/// Type of the state that is kept by the inner solver between calls (e.g.
+/// @ref PANOCSolver::WarmStart), or an empty type if the inner solver doesn't
+/// support warm-starting.
+template <class InnerSolverT, class = void>
+struct inner_warm_start {
+    struct type {};
+    static constexpr bool supported = false;
+};
+
+template <class InnerSolverT>
+struct inner_warm_start<InnerSolverT,
+                        std::void_t<typename InnerSolverT::WarmStart>> {
+    using type                      = typename InnerSolverT::WarmStart;
+    static constexpr bool supported = true;
+};
+
 /// Augmented Lagrangian Method solver
 ///
 /// @ingroup    grp_ALMSolver
@@ -131,6 +173,28 @@ class ALMSolver {
         InnerStatsAccumulator<typename InnerSolver::Stats> inner;
     };
 
+    /// State of the solver at the end of a solve, which can be passed to the
+    /// next solve to warm-start it, e.g. when solving a sequence of similar
+    /// problems in receding-horizon MPC. Without it, each solve starts with
+    /// the initial penalty factors and tolerance again, and the state of the
+    /// inner solver is discarded.
+    /// @see vec_util::shift_horizon
+    struct State {
+        /// Whether the state was saved by a previous solve. If not, or if the
+        /// number of constraints changed, the state is not used.
+        bool valid = false;
+        /// Penalty factors @f$ \Sigma @f$.
+        vec Σ;
+        /// Primal tolerance of the inner solver.
+        real_t ε = NaN;
+        /// Penalty update factor.
+        real_t Δ = NaN;
+        /// State of the inner solver (e.g. Lipschitz estimate, step size and
+        /// L-BFGS memory, see @ref PANOCParams::reuse_lipschitz_estimate and
+        /// @ref PANOCParams::keep_direction_history).
+        typename inner_warm_start<InnerSolver>::type inner;
+    };
+
     ALMSolver(Params params, InnerSolver &&inner_solver)
         : params(params),
           inner_solver(std::forward<InnerSolver>(inner_solver)) {}
@@ -138,6 +202,23 @@ class ALMSolver {
         : params(params), inner_solver(inner_solver) {}
 
     Stats operator()(const Problem &problem, rvec y, rvec x);
+    /// Solve the problem, starting from the given @p state (if it is not
+    /// empty), and overwrite @p state with the final state of this solve.
+    Stats operator()(const Problem &problem, rvec y, rvec x, State &state);
+
+    /// Solve a problem with a static interface (see @ref is_static_problem),
+    /// without the overhead of the type-erased @ref Problem. The inner solver
+    /// should support static problems as well.
+    template <class ProblemT,
+              class = std::enable_if_t<is_static_problem_v<ProblemT>>>
+    Stats operator()(const ProblemT &problem, rvec y, rvec x) {
+        return solve(problem, y, x, nullptr);
+    }
+    template <class ProblemT,
+              class = std::enable_if_t<is_static_problem_v<ProblemT>>>
+    Stats operator()(const ProblemT &problem, rvec y, rvec x, State &state) {
+        return solve(problem, y, x, &state);
+    }
 
     std::string get_name() const {
         return "ALMSolver<" + inner_solver.get_name() + ">";
@@ -145,12 +226,41 @@ class ALMSolver {
 
     /// Abort the computation and return the result so far.
     /// Can be called from other threads or signal handlers.
-    void stop() { inner_solver.stop(); }
+    void stop() {
+        stop_signal.stop();
+        inner_solver.stop();
+    }
 
     const Params &get_params() const { return params; }
 
   private:
+    template <class ProblemT>
+    Stats solve(const ProblemT &problem, rvec y, rvec x, State *state);
+    template <class ProblemT>
+    Stats solve_unpreconditioned(const ProblemT &p, rvec y, rvec x,
+                                 State *state,
+                                 std::chrono::steady_clock::time_point t0);
+    /// Save the final state of a solve.
+    void save_state(State &state, crvec Σ, real_t ε, real_t Δ) const;
+
     Params params;
+    /// Checked after each inner solve, because an inner solver that converges
+    /// doesn't report that it was stopped.
+    AtomicStopSignal stop_signal;
+
+    /// Storage for the penalty factors, constraint violations and the
+    /// preconditioned problem, kept between calls so that solving problems of
+    /// the same size doesn't allocate.
+    struct Workspace {
+        vec Σ, Σ_old, error₁, error₂;
+        detail::Preconditioning prec;
+
+        /// Resize all vectors (no-op if the sizes didn't change).
+        void resize(Eigen::Index m) {
+            for (vec *v : {&Σ, &Σ_old, &error₁, &error₂})
+                v->resize(m);
+        }
+    } work;
 
   public:
     InnerSolver inner_solver;
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <alpaqa/decl/alm.hpp>
+#include <alpaqa/util/atomic_stop_signal.hpp>
+
+#include <mutex>
+#include <vector>
+
+namespace alpaqa {
+
+/// Parameters for the batch solver.
+struct BatchALMParams {
+    /// Number of worker threads. If set to zero (which is the default), the
+    /// number of hardware threads is used.
+    unsigned num_threads = 0;
+    /// Number of problem instances that a worker claims at once. Larger chunks
+    /// reduce the synchronization overhead, smaller chunks give better load
+    /// balancing when the solve times of the instances differ a lot.
+    unsigned chunk_size = 1;
+    /// Allow idle workers to take chunks that were initially assigned to other
+    /// workers. If false, each worker only solves its own contiguous block of
+    /// instances.
+    bool work_stealing = true;
+};
+
+/// Solves many instances of the same parametric problem in parallel, using a
+/// thread pool. Each worker thread has its own copy of the ALM solver (and
+/// thus its own workspaces and inner solver state) and its own copy of the
+/// problem, so the parameters can be set independently. The worker solvers
+/// are copied from @ref BatchALMSolver::solver at the start of each call.
+///
+/// The instances are divided into chunks of @ref BatchALMParams::chunk_size.
+/// Each worker is initially assigned a contiguous range of chunks, which it
+/// processes from the front. Workers that run out of work steal chunks from
+/// the back of the range of other workers.
+///
+/// @ingroup    grp_ALMSolver
+template <class InnerSolverT = PANOCSolver<>>
+class BatchALMSolver {
+  public:
+    using Params    = BatchALMParams;
+    using ALMSolver = alpaqa::ALMSolver<InnerSolverT>;
+    using Stats     = typename ALMSolver::Stats;
+
+    BatchALMSolver(Params params, const ALMSolver &solver)
+        : params(params), solver(solver) {}
+
+    /// Solve one problem instance for each column of @p params.
+    ///
+    /// @param  problem
+    ///         Problem to solve. Should be copyable and have a
+    ///         `set_param(crvec)` member function (e.g. @ref ProblemWithParam),
+    ///         every worker thread uses its own copy.
+    /// @param  param
+    ///         Parameters of all instances (one column per instance).
+    /// @param[inout]   y
+    ///         Initial guesses and solutions for the Lagrange multipliers
+    ///         (one column per instance).
+    /// @param[inout]   x
+    ///         Initial guesses and solutions for the decision variables
+    ///         (one column per instance).
+    /// @returns The statistics of each instance.
+    ///
+    /// If a solve throws an exception, the remaining instances are skipped and
+    /// the first exception is rethrown once all workers have finished.
+    template <class ProblemT>
+    std::vector<Stats> operator()(const ProblemT &problem, crmat param, rmat y,
+                                  rmat x);
+
+    std::string get_name() const { return "Batch" + solver.get_name(); }
+
+    /// Abort the computation. Instances that have not been started yet are
+    /// skipped, the ones that are currently running return their result so
+    /// far. Can be called from other threads.
+    void stop();
+
+    const Params &get_params() const { return params; }
+
+  private:
+    Params params;
+    AtomicStopSignal stop_signal;
+    /// Solvers of the worker threads, so that @ref stop can abort them.
+    std::vector<ALMSolver> workers;
+    std::mutex workers_mtx;
+
+  public:
+    /// Solver that is copied for each worker.
+    ALMSolver solver;
+};
+
+} // namespace alpaqa
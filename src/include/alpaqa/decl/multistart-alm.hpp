@@ -0,0 +1,132 @@
+#pragma once
+
+#include <alpaqa/decl/alm.hpp>
+#include <alpaqa/util/atomic_stop_signal.hpp>
+#include <alpaqa/util/box.hpp>
+
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace alpaqa {
+
+/// Which result the multi-start solver returns, and when it stops.
+enum class MultiStartPolicy {
+    /// Solve from all starting points and return the converged solution with
+    /// the lowest objective.
+    BestOfAll,
+    /// Stop all remaining runs as soon as one run converges to a solution with
+    /// an objective of at most @ref MultiStartALMParams::good_enough_objective.
+    FirstGoodEnough,
+};
+
+/// Parameters for the multi-start solver.
+struct MultiStartALMParams {
+    /// Number of worker threads. If set to zero (which is the default), the
+    /// number of hardware threads is used.
+    unsigned num_threads = 0;
+    /// @see MultiStartPolicy
+    MultiStartPolicy policy = MultiStartPolicy::BestOfAll;
+    /// Objective value that is good enough to stop the other runs when using
+    /// @ref MultiStartPolicy::FirstGoodEnough. The default accepts the first
+    /// run that converges.
+    real_t good_enough_objective = inf;
+    /// A run is cancelled when the objective @f$ f(\hat x^k) @f$ of its
+    /// current inner iterate is larger than the best objective of all
+    /// converged runs so far (the incumbent) plus this tolerance times
+    /// @f$ 1 + |f_\text{incumbent}| @f$. Since the problem is nonconvex, this
+    /// is a heuristic: runs that are cancelled could still have reached a
+    /// better local minimum. Set to infinity (which is the default) to
+    /// disable the cancellation of dominated runs.
+    /// Enabling this option replaces the progress callback of the inner
+    /// solver.
+    real_t dominance_tolerance = inf;
+    /// Number of inner iterations between two comparisons with the incumbent.
+    /// Each comparison costs one extra evaluation of @ref Problem::f.
+    unsigned dominance_check_interval = 10;
+};
+
+/// Solves a nonconvex problem from multiple starting points in parallel, and
+/// returns the best solution. Each run has its own copy of the ALM solver and
+/// of the problem, the problem is copied for each worker thread.
+///
+/// The runs share the best objective of the converged runs so far (the
+/// incumbent), which is used to cancel runs that are clearly worse (see
+/// @ref MultiStartALMParams::dominance_tolerance), and to stop all remaining
+/// runs when a good enough solution has been found (see
+/// @ref MultiStartPolicy::FirstGoodEnough). Runs are cancelled using
+/// @ref ALMSolver::stop.
+///
+/// @ingroup    grp_ALMSolver
+template <class InnerSolverT = PANOCSolver<>>
+class MultiStartALMSolver {
+  public:
+    using Params    = MultiStartALMParams;
+    using ALMSolver = alpaqa::ALMSolver<InnerSolverT>;
+
+    struct Stats {
+        /// Statistics of each run. Runs that were cancelled or never started
+        /// have status @ref SolverStatus::Interrupted.
+        std::vector<typename ALMSolver::Stats> runs;
+        /// Final objective value of each run (NaN if the run never started).
+        vec objective;
+        /// Whether each run was cancelled because it was dominated by the
+        /// incumbent.
+        std::vector<bool> dominated;
+        /// Index of the run whose solution was returned, empty if no run
+        /// converged.
+        std::optional<size_t> best;
+    };
+
+    MultiStartALMSolver(Params params, const ALMSolver &solver)
+        : params(params), solver(solver) {}
+
+    /// Solve the problem starting from each column of @p x₀.
+    ///
+    /// @param  problem
+    ///         Problem to solve. Should be copyable, every worker thread uses
+    ///         its own copy. Wrappers that can't be copied, such as
+    ///         @ref ProblemWithCounters and @ref ProblemWithCache, are not
+    ///         supported.
+    /// @param  x₀
+    ///         Starting points for the decision variables (one column per
+    ///         run), see e.g. @ref perturbed_starts.
+    /// @param[inout]   y
+    ///         Initial guess for the Lagrange multipliers (shared by all runs)
+    ///         and the multipliers of the best solution.
+    /// @param[out]     x
+    ///         The best solution. Not modified if no run converged.
+    ///
+    /// If a run throws an exception, the remaining runs are stopped and the
+    /// first exception is rethrown once all workers have finished.
+    template <class ProblemT>
+    Stats operator()(const ProblemT &problem, crmat x₀, rvec y, rvec x);
+
+    /// Generate @p num_starts starting points: the first one is @p x₀ itself,
+    /// the others are @p x₀ plus Gaussian noise with standard deviation
+    /// @p σ, projected onto the box @p C.
+    static mat perturbed_starts(crvec x₀, const Box &C, unsigned num_starts,
+                                real_t σ, unsigned seed = 0);
+
+    std::string get_name() const { return "MultiStart" + solver.get_name(); }
+
+    /// Abort the computation. Runs that have not been started yet are
+    /// skipped, the ones that are currently running return their result so
+    /// far. Can be called from other threads.
+    void stop();
+
+    const Params &get_params() const { return params; }
+
+  private:
+    Params params;
+    AtomicStopSignal stop_signal;
+    /// Solvers of the individual runs, so that they can be cancelled.
+    std::vector<ALMSolver> runs;
+    std::mutex runs_mtx;
+
+  public:
+    /// Solver that is copied for each run.
+    ALMSolver solver;
+};
+
+} // namespace alpaqa
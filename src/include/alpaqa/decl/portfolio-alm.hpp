@@ -0,0 +1,99 @@
+#pragma once
+
+#include <alpaqa/decl/alm.hpp>
+#include <alpaqa/util/atomic_stop_signal.hpp>
+
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <utility>
+
+namespace alpaqa {
+
+/// Races ALM solvers with different inner solvers (e.g.
+/// @ref PANOCSolver, @ref StructuredPANOCLBFGSSolver, @ref GAAPGASolver and
+/// @ref SecondOrderPANOCSolver) against each other on the same problem, and
+/// returns the result of the first one that converges. The others are then
+/// stopped using @ref ALMSolver::stop, so the solve time is bounded by the
+/// time of the fastest solver in the portfolio (plus the time the others
+/// need to notice the stop request).
+///
+/// Each solver runs on its own thread (the first one on the calling thread)
+/// and uses its own copy of the problem, so evaluators with internal state
+/// (e.g. the parameters of @ref ProblemWithParam) are cloned. The solvers are
+/// copied from @ref PortfolioALMSolver::solvers at the start of each call.
+///
+/// @ingroup    grp_ALMSolver
+template <class... InnerSolversT>
+class PortfolioALMSolver {
+    static_assert(sizeof...(InnerSolversT) > 0,
+                  "The portfolio should contain at least one solver");
+
+  public:
+    using Solvers = std::tuple<ALMSolver<InnerSolversT>...>;
+
+    struct Stats {
+        /// Index of the solver that converged first, whose result was
+        /// returned. Empty if no solver converged.
+        std::optional<size_t> winner;
+        /// Statistics of each solver. Solvers that were stopped because
+        /// another one converged first have status
+        /// @ref SolverStatus::Interrupted.
+        std::tuple<typename ALMSolver<InnerSolversT>::Stats...> solvers;
+        /// Time until the winner converged, or until all solvers finished if
+        /// none converged.
+        std::chrono::microseconds elapsed_time;
+    };
+
+    PortfolioALMSolver(const ALMSolver<InnerSolversT> &...solvers)
+        : solvers(solvers...) {}
+
+    /// Solve the problem with all solvers, starting from the same @p x and
+    /// @p y.
+    ///
+    /// @param  problem
+    ///         Problem to solve. Should be copyable, every solver uses its own
+    ///         copy. Wrappers that can't be copied, such as
+    ///         @ref ProblemWithCounters and @ref ProblemWithCache, are not
+    ///         supported.
+    /// @param[inout]   y
+    ///         Initial guess for the Lagrange multipliers, and the multipliers
+    ///         of the winning solver.
+    /// @param[inout]   x
+    ///         Initial guess for the decision variables, and the solution of
+    ///         the winning solver. Not modified if no solver converged.
+    ///
+    /// If a solver throws an exception, the others keep running. The first
+    /// exception is rethrown only if no solver converged.
+    template <class ProblemT>
+    Stats operator()(const ProblemT &problem, rvec y, rvec x) {
+        return race(problem, y, x,
+                    std::index_sequence_for<InnerSolversT...>{});
+    }
+
+    std::string get_name() const;
+
+    /// Abort the computation of all solvers. Can be called from other threads.
+    void stop();
+
+  private:
+    template <class ProblemT, size_t... Is>
+    Stats race(const ProblemT &problem, rvec y, rvec x,
+               std::index_sequence<Is...>);
+    /// Stop all solvers of the current call.
+    void stop_running();
+
+    AtomicStopSignal stop_signal;
+    /// Copies of the solvers used by the current call, so that they can be
+    /// stopped.
+    std::optional<Solvers> running;
+    std::mutex running_mtx;
+
+  public:
+    /// Solvers that are copied at the start of each call.
+    Solvers solvers;
+};
+
+} // namespace alpaqa
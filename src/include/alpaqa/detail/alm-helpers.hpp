@@ -1,7 +1,11 @@
 #pragma once
 
 #include <alpaqa/decl/alm.hpp>
+#include <alpaqa/inner/detail/panoc-helpers.hpp>
+#include <alpaqa/util/sparse-jacobian.hpp>
+
 #include <stdexcept>
+#include <type_traits>
 
 namespace alpaqa::detail {
 
@@ -50,71 +54,173 @@ inline void update_penalty_weights(const ALMParams &params, real_t Δ,
     }
 }
 
-inline void initialize_penalty(const Problem &p, const ALMParams &params,
-                               crvec x0, rvec Σ) {
+template <class ProblemT>
+inline void initialize_penalty(const ProblemT &p, const ALMParams &params,
+                               crvec x0, rvec Σ, rvec work_m) {
     real_t f0 = p.f(x0);
-    vec g0(p.m);
+    auto &g0  = work_m;
     p.g(x0, g0);
-    // TODO: reuse evaluations of f ang g in PANOC?
+    // These evaluations are reused by the inner solver if p is a
+    // ProblemWithCache
     real_t σ = params.σ₀ * std::max(real_t(1), std::abs(f0)) /
-               std::max(real_t(1), 0.5 * g0.squaredNorm());
+               std::max(real_t(1), real_t(0.5) * g0.squaredNorm());
     σ = std::max(σ, params.Σ_min);
     σ = std::min(σ, params.Σ_max);
     Σ.fill(σ);
 }
 
-inline void apply_preconditioning(const Problem &problem, Problem &prec_problem,
-                                  crvec x, real_t &prec_f, vec &prec_g) {
-    vec grad_f(problem.n);
-    vec v = vec::Zero(problem.m);
-    vec grad_g(problem.n);
-    problem.grad_f(x, grad_f);
-    prec_f = 1. / std::max(grad_f.lpNorm<Eigen::Infinity>(), real_t{1});
+/// Scale the cost and constraints of @p problem based on their gradients in
+/// the starting point @p x, and store the scaled problem in
+/// @p prec.problem. The storage in @p prec is reused, so applying the
+/// preconditioning to a problem with the same dimensions doesn't allocate.
+/// @note   The scaled problem keeps references to @p problem and @p prec, so
+///         both should outlive it.
+template <class ProblemT>
+inline void apply_preconditioning(const ProblemT &problem, crvec x,
+                                  Preconditioning &prec) {
+    auto &grad_f = prec.grad_f, &prec_g = prec.g;
+    grad_f.resize(problem.n);
     prec_g.resize(problem.m);
+    problem.grad_f(x, grad_f);
+    prec.f = 1. / std::max(grad_f.lpNorm<Eigen::Infinity>(), real_t{1});
 
-    for (Eigen::Index i = 0; i < problem.m; ++i) {
-        v(i) = 1;
-        problem.grad_g_prod(x, v, grad_g);
-        v(i)      = 0;
-        prec_g(i) = 1. / std::max(grad_g.lpNorm<Eigen::Infinity>(), real_t{1});
+    // Row norms of the Jacobian: a single evaluation of the sparse Jacobian
+    // if the problem provides it, one gradient-vector product per row otherwise
+    bool sparse_jac = false;
+    if constexpr (std::is_base_of_v<Problem, ProblemT>) {
+        if (problem.jac_g) {
+            auto &jac = prec.jac;
+            jac.set_pattern(problem.jac_g_sparsity);
+            problem.jac_g(x, jac.nonzeros);
+            jac.update();
+            using It = SparseJacobian::matrix_t::InnerIterator;
+            for (Eigen::Index i = 0; i < problem.m; ++i) {
+                real_t norm_inf = 0;
+                for (It it(jac.matrix(), i); it; ++it)
+                    norm_inf = std::max(norm_inf, std::abs(it.value()));
+                prec_g(i) = 1. / std::max(norm_inf, real_t{1});
+            }
+            sparse_jac = true;
+        }
+    }
+    if (not sparse_jac) {
+        auto &v = prec.v, &grad_g = prec.grad_g;
+        v.resize(problem.m);
+        grad_g.resize(problem.n);
+        v.setZero();
+        for (Eigen::Index i = 0; i < problem.m; ++i) {
+            v(i) = 1;
+            problem.grad_g_prod(x, v, grad_g);
+            v(i) = 0;
+            prec_g(i) =
+                1. / std::max(grad_g.lpNorm<Eigen::Infinity>(), real_t{1});
+        }
     }
 
-    auto prec_f_fun      = [&](crvec x) { return problem.f(x) * prec_f; };
-    auto prec_grad_f_fun = [&](crvec x, rvec grad_f) {
+    for (vec *v : {&prec.grad_g_prod_v, &prec.grad_L_y, &prec.ψ_y, &prec.ψ_Σ,
+                   &prec.ψ_grad_ψ_y, &prec.ψ_grad_ψ_Σ})
+        v->resize(problem.m);
+
+    // The functions only capture two references, so assigning them to the
+    // std::function members doesn't allocate
+    auto &p        = prec.problem;
+    p.n            = problem.n;
+    p.m            = problem.m;
+    p.C            = problem.C;
+    p.D.upperbound = prec_g.asDiagonal() * problem.D.upperbound;
+    p.D.lowerbound = prec_g.asDiagonal() * problem.D.lowerbound;
+    p.f            = [&problem, &prec](crvec x) {
+        return problem.f(x) * prec.f;
+    };
+    p.grad_f = [&problem, &prec](crvec x, rvec grad_f) {
         problem.grad_f(x, grad_f);
-        grad_f *= prec_f;
+        grad_f *= prec.f;
     };
-    auto prec_g_fun = [&](crvec x, rvec g) {
+    p.g = [&problem, &prec](crvec x, rvec g) {
         problem.g(x, g);
-        g = prec_g.asDiagonal() * g;
+        g = prec.g.asDiagonal() * g;
     };
-    auto prec_grad_g_fun = [&](crvec x, crvec v, rvec grad_g) {
-        vec prec_v = prec_g.asDiagonal() * v;
+    p.grad_g_prod = [&problem, &prec](crvec x, crvec v, rvec grad_g) {
+        auto &prec_v = prec.grad_g_prod_v;
+        prec_v       = prec.g.asDiagonal() * v;
         problem.grad_g_prod(x, prec_v, grad_g);
     };
-    prec_problem = Problem{
-        problem.n,
-        problem.m,
-        problem.C,
-        Box{prec_g.asDiagonal() * problem.D.upperbound,
-            prec_g.asDiagonal() * problem.D.lowerbound},
-        std::move(prec_f_fun),
-        std::move(prec_grad_f_fun),
-        std::move(prec_g_fun),
-        std::move(prec_grad_g_fun),
-        [](crvec, unsigned, rvec) {
-            throw std::logic_error("Preconditioning for second-order solvers "
-                                   "has not yet been implemented");
-        },
-        [](crvec, crvec, crvec, rvec) {
-            throw std::logic_error("Preconditioning for second-order solvers "
-                                   "has not yet been implemented");
-        },
-        [](crvec, crvec, rmat) {
-            throw std::logic_error("Preconditioning for second-order solvers "
-                                   "has not yet been implemented");
-        },
+    p.grad_gi = [](crvec, unsigned, rvec) {
+        throw std::logic_error("Preconditioning for second-order solvers "
+                               "has not yet been implemented");
+    };
+    p.hess_L_prod = [](crvec, crvec, crvec, rvec) {
+        throw std::logic_error("Preconditioning for second-order solvers "
+                               "has not yet been implemented");
     };
+    p.hess_L = [](crvec, crvec, rmat) {
+        throw std::logic_error("Preconditioning for second-order solvers "
+                               "has not yet been implemented");
+    };
+    // The scaled functions are as thread-safe as the original ones, except
+    // for ∇g(x) y, whose work vector is shared by all calls
+    p.thread_safe             = thread_safety(problem);
+    p.thread_safe.grad_g_prod = false;
+    // Fused evaluations, only forwarded if the original problem provides them
+    p.f_grad_f = nullptr;
+    p.grad_L   = nullptr;
+    p.ψ        = nullptr;
+    p.ψ_grad_ψ = nullptr;
+    p.jac_g    = nullptr;
+    if constexpr (std::is_base_of_v<Problem, ProblemT>) {
+        if (problem.f_grad_f)
+            p.f_grad_f = [&problem, &prec](crvec x, rvec grad_f) {
+                real_t f = problem.f_grad_f(x, grad_f);
+                grad_f *= prec.f;
+                return f * prec.f;
+            };
+        // α∇f(x) + ∇g(x) G y = α (∇f(x) + ∇g(x) G y / α)
+        if (problem.grad_L)
+            p.grad_L = [&problem, &prec](crvec x, crvec y, rvec grad_L) {
+                auto &prec_y = prec.grad_L_y;
+                prec_y       = prec.g.asDiagonal() * y / prec.f;
+                problem.grad_L(x, prec_y, grad_L);
+                grad_L *= prec.f;
+            };
+        // With the scaled cost αf(x), the scaled constraints G g(x) and the
+        // scaled set G D, the augmented Lagrangian of the scaled problem is
+        //   ψ̃(x; y, Σ) = α ψ(x; G y / α, G Σ G / α),
+        // and its vector ŷ is given by ŷ̃ = α G⁻¹ ŷ. The set D argument is
+        // always the scaled set of the scaled problem, so the original set of
+        // the original problem is passed instead.
+        if (problem.ψ)
+            p.ψ = [&problem, &prec](crvec x, crvec y, crvec Σ, const Box &,
+                                    rvec ŷ) {
+                auto &prec_y = prec.ψ_y, &prec_Σ = prec.ψ_Σ;
+                prec_y       = prec.g.asDiagonal() * y / prec.f;
+                prec_Σ       = prec.g.cwiseAbs2().cwiseProduct(Σ) / prec.f;
+                real_t ψ     = problem.ψ(x, prec_y, prec_Σ, problem.D, ŷ);
+                ŷ        = prec.f * prec.g.asDiagonal().inverse() * ŷ;
+                return ψ * prec.f;
+            };
+        if (problem.ψ_grad_ψ)
+            p.ψ_grad_ψ = [&problem, &prec](crvec x, crvec y, crvec Σ,
+                                           const Box &, rvec grad_ψ, rvec ŷ) {
+                auto &prec_y = prec.ψ_grad_ψ_y, &prec_Σ = prec.ψ_grad_ψ_Σ;
+                prec_y       = prec.g.asDiagonal() * y / prec.f;
+                prec_Σ       = prec.g.cwiseAbs2().cwiseProduct(Σ) / prec.f;
+                real_t ψ     = problem.ψ_grad_ψ(x, prec_y, prec_Σ, problem.D,
+                                                grad_ψ, ŷ);
+                grad_ψ *= prec.f;
+                ŷ = prec.f * prec.g.asDiagonal().inverse() * ŷ;
+                return ψ * prec.f;
+            };
+        // The rows of the preconditioned Jacobian are scaled by prec_g
+        if (sparse_jac) {
+            p.jac_g_sparsity = problem.jac_g_sparsity;
+            p.jac_g          = [&problem, &prec](crvec x, rvec J_values) {
+                problem.jac_g(x, J_values);
+                const auto &rows = problem.jac_g_sparsity.row;
+                for (Eigen::Index k = 0; k < J_values.size(); ++k)
+                    J_values(k) *= prec.g(rows[k]);
+            };
+        }
+    }
 }
 
 } // namespace alpaqa::detail
\ No newline at end of file
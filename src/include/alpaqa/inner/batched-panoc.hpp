@@ -0,0 +1,448 @@
+#pragma once
+
+#include <alpaqa/inner/decl/batched-panoc.hpp>
+#include <alpaqa/inner/detail/panoc-helpers.hpp>
+#include <alpaqa/inner/directions/batched-lbfgs.hpp>
+
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+namespace alpaqa {
+
+using std::chrono::duration_cast;
+using std::chrono::microseconds;
+
+inline std::string BatchedPANOCSolver::get_name() const {
+    return "BatchedPANOCSolver<" + lbfgs.get_name() + ">";
+}
+
+inline BatchedPANOCSolver::Stats BatchedPANOCSolver::operator()(
+    /// [in]    Problem description
+    const BatchedProblem &problem,
+    /// [in]    Constraint weights @f$ \Sigma @f$
+    crmat Σ,
+    /// [in]    Tolerance @f$ \varepsilon @f$
+    real_t ε,
+    /// [in]    Overwrite @p x, @p y and @p err_z even if not converged
+    bool always_overwrite_results,
+    /// [inout] Decision variable @f$ x @f$
+    rmat x,
+    /// [inout] Lagrange multipliers @f$ y @f$
+    rmat y,
+    /// [out]   Slack variable error @f$ g(x) - z @f$
+    rmat err_z) {
+
+    using batch_util::rowwise_dot;
+    using batch_util::select_rows;
+
+    auto start_time = std::chrono::steady_clock::now();
+
+    const auto B = x.rows();
+    const auto n = problem.n;
+    const auto m = problem.m;
+    assert(x.cols() == Eigen::Index(n));
+    assert(y.rows() == B && y.cols() == Eigen::Index(m));
+    assert(Σ.rows() == B && Σ.cols() == Eigen::Index(m));
+
+    switch (params.stop_crit) {
+        case PANOCStopCrit::ProjGradUnitNorm: [[fallthrough]];
+        case PANOCStopCrit::ProjGradUnitNorm2: [[fallthrough]];
+        case PANOCStopCrit::Ipopt:
+            throw std::invalid_argument(
+                "[Batched PANOC] Unsupported stopping criterion");
+        default: break;
+    }
+
+    Stats s;
+    s.status.assign(B, SolverStatus::Unknown);
+    s.ε = vec::Constant(B, inf);
+    s.iterations.assign(B, 0);
+
+    // Allocate matrices, init L-BFGS ------------------------------------------
+
+    bool need_grad_̂ψₖ = detail::stop_crit_requires_grad_̂ψₖ(params.stop_crit);
+    work.resize(B, n, m);
+    if (lbfgs.history() != lbfgs.get_params().memory ||
+        lbfgs.batch_size() != B || lbfgs.n() != Eigen::Index(n))
+        lbfgs.resize(B, n);
+
+    auto &xₖ = work.xₖ, &x̂ₖ = work.x̂ₖ, &xₖ₊₁ = work.xₖ₊₁, &x̂ₖ₊₁ = work.x̂ₖ₊₁,
+         &ŷx̂ₖ = work.ŷx̂ₖ, &ŷx̂ₖ₊₁ = work.ŷx̂ₖ₊₁, &pₖ = work.pₖ, &pₖ₊₁ = work.pₖ₊₁,
+         &qₖ = work.qₖ, &grad_ψₖ = work.grad_ψₖ, &grad_̂ψₖ = work.grad_̂ψₖ,
+         &grad_ψₖ₊₁ = work.grad_ψₖ₊₁;
+    auto &work_n = work.work_n, &work_n2 = work.work_n2, &work_m = work.work_m;
+    auto &ψₖ = work.ψₖ, &ψₖ₊₁ = work.ψₖ₊₁, &ψx̂ₖ = work.ψx̂ₖ,
+         &ψx̂ₖ₊₁ = work.ψx̂ₖ₊₁, &φₖ = work.φₖ, &φₖ₊₁ = work.φₖ₊₁, &Lₖ = work.Lₖ,
+         &Lₖ₊₁ = work.Lₖ₊₁, &γₖ = work.γₖ, &γₖ₊₁ = work.γₖ₊₁, &τ = work.τ,
+         &grad_ψₖᵀpₖ = work.grad_ψₖᵀpₖ, &grad_ψₖ₊₁ᵀpₖ₊₁ = work.grad_ψₖ₊₁ᵀpₖ₊₁,
+         &pₖᵀpₖ = work.pₖᵀpₖ, &pₖ₊₁ᵀpₖ₊₁ = work.pₖ₊₁ᵀpₖ₊₁,
+         &pₖ₊₁ᵀpₖ₊₁_ₖ = work.pₖ₊₁ᵀpₖ₊₁_ₖ, &σₖγₖ⁻¹pₖᵀpₖ = work.σₖγₖ⁻¹pₖᵀpₖ,
+         &margin = work.margin, &ls_cond = work.ls_cond, &εₖ = work.εₖ,
+         &work_B = work.work_B;
+    auto &active = work.active, &done = work.done, &write = work.write,
+         &pending = work.pending, &step = work.step,
+         &work_mask = work.work_mask;
+    // Keep track of how many successive iterations didn't update the iterate
+    auto &no_progress = work.no_progress;
+
+    xₖ   = x;
+    xₖ₊₁ = x;
+    // Instances that haven't finished yet
+    active.setConstant(true);
+    no_progress.setZero();
+
+    // Helper functions --------------------------------------------------------
+    // They only overwrite the rows of the instances selected by lanes.
+
+    // ŷ = Σ (ζ - Π(ζ, D)) with ζ = g(x) + Σ⁻¹y, adds ½ dᵀŷ to ψ
+    auto calc_ŷ_add_dᵀŷ = [&](rmat g_ŷ, rvec ψ) {
+        g_ŷ += y.cwiseQuotient(Σ);
+        for (Eigen::Index j = 0; j < g_ŷ.cols(); ++j)
+            g_ŷ.col(j) -= clamp(g_ŷ.col(j),
+                                vec::Constant(B, problem.D.lowerbound(j)),
+                                vec::Constant(B, problem.D.upperbound(j)));
+        ψ += 0.5 * rowwise_dot(Σ, g_ŷ.cwiseAbs2());
+        g_ŷ = g_ŷ.cwiseProduct(Σ);
+    };
+    // ψ(x) = f(x) + ½ dᵀŷ
+    auto calc_ψ_ŷ = [&](const lane_mask &lanes, crmat x, rmat ŷ, rvec ψ) {
+        problem.f(lanes, x, work_B);
+        if (m > 0) /* [[likely]] */ {
+            problem.g(lanes, x, work_m);
+            calc_ŷ_add_dᵀŷ(work_m, work_B);
+            select_rows(lanes, work_m, ŷ);
+        }
+        ψ = lanes.select(work_B.array(), ψ.array()).matrix();
+    };
+    // ∇ψ = ∇f(x) + ∇g(x) ŷ
+    auto calc_grad_ψ_from_ŷ = [&](const lane_mask &lanes, crmat x, crmat ŷ,
+                                  rmat grad_ψ) {
+        problem.grad_f(lanes, x, work_n);
+        if (m > 0) /* [[likely]] */ {
+            problem.grad_g_prod(lanes, x, ŷ, work_n2);
+            work_n += work_n2;
+        }
+        select_rows(lanes, work_n, grad_ψ);
+    };
+    auto calc_ψ_grad_ψ = [&](const lane_mask &lanes, crmat x, rmat grad_ψ,
+                             rvec ψ) {
+        calc_ψ_ŷ(lanes, x, work_m, ψ);
+        calc_grad_ψ_from_ŷ(lanes, x, work_m, grad_ψ);
+    };
+    // ∇ψ(x) without evaluating f(x)
+    auto calc_grad_ψ = [&](const lane_mask &lanes, crmat x, rmat grad_ψ) {
+        if (m > 0) /* [[likely]] */ {
+            problem.g(lanes, x, work_m);
+            calc_ŷ_add_dᵀŷ(work_m, work_B);
+        }
+        calc_grad_ψ_from_ŷ(lanes, x, work_m, grad_ψ);
+    };
+    // x̂ = Π_C(x - γ∇ψ(x)), p = x̂ - x
+    auto calc_x̂ = [&](crvec γ, crmat x, crmat grad_ψ, rmat x̂, rmat p,
+                      rvec grad_ψᵀp, rvec pᵀp) {
+        x̂ = x - γ.asDiagonal() * grad_ψ;
+        batch_util::project_rows(x̂, problem.C, x̂);
+        p        = x̂ - x;
+        grad_ψᵀp = rowwise_dot(grad_ψ, p);
+        pᵀp      = p.rowwise().squaredNorm();
+    };
+    // Decrease the step size of the selected instances until the quadratic
+    // upper bound is satisfied (see detail::descent_lemma)
+    auto descent_lemma = [&](const lane_mask &lanes, crmat xₖ, crvec ψₖ,
+                             crmat grad_ψₖ, rmat x̂ₖ, rmat pₖ, rmat ŷx̂ₖ,
+                             rvec ψx̂ₖ, rvec pₖᵀpₖ, rvec grad_ψₖᵀpₖ, rvec Lₖ,
+                             rvec γₖ) {
+        const real_t tol = params.quadratic_upperbound_tolerance_factor;
+        auto &violated   = work.violated;
+        while (true) {
+            auto ub_margin = (1 + ψₖ.array().abs()) * tol;
+            violated =
+                lanes &&
+                (ψx̂ₖ - ψₖ).array() >
+                    grad_ψₖᵀpₖ.array() + 0.5 * Lₖ.array() * pₖᵀpₖ.array() +
+                        ub_margin &&
+                Lₖ.array() * 2 <= params.L_max;
+            if (not violated.any())
+                break;
+            Lₖ = violated.select(2 * Lₖ.array(), Lₖ.array()).matrix();
+            γₖ = violated.select(0.5 * γₖ.array(), γₖ.array()).matrix();
+            // The other instances get the same x̂ and p again, and they are
+            // not evaluated
+            calc_x̂(γₖ, xₖ, grad_ψₖ, x̂ₖ, pₖ, grad_ψₖᵀpₖ, pₖᵀpₖ);
+            calc_ψ_ŷ(violated, x̂ₖ, ŷx̂ₖ, ψx̂ₖ);
+        }
+    };
+    // Error used as stopping criterion (see detail::calc_error_stop_crit)
+    auto calc_error_stop_crit = [&](crmat pₖ, crvec pₖᵀpₖ, crvec γₖ,
+                                    crmat grad_ψₖ, crmat grad_̂ψₖ, rvec εₖ) {
+        switch (params.stop_crit) {
+            case PANOCStopCrit::ApproxKKT: [[fallthrough]];
+            case PANOCStopCrit::ApproxKKT2:
+                work_n = γₖ.cwiseInverse().asDiagonal() * pₖ;
+                work_n += grad_ψₖ - grad_̂ψₖ;
+                if (params.stop_crit == PANOCStopCrit::ApproxKKT)
+                    εₖ = work_n.cwiseAbs().rowwise().maxCoeff();
+                else
+                    εₖ = work_n.rowwise().norm();
+                break;
+            case PANOCStopCrit::ProjGradNorm:
+                εₖ = pₖ.cwiseAbs().rowwise().maxCoeff();
+                break;
+            case PANOCStopCrit::ProjGradNorm2: εₖ = pₖᵀpₖ.cwiseSqrt(); break;
+            case PANOCStopCrit::FPRNorm:
+                εₖ = pₖ.cwiseAbs().rowwise().maxCoeff().cwiseQuotient(γₖ);
+                break;
+            case PANOCStopCrit::FPRNorm2:
+                εₖ = pₖᵀpₖ.cwiseSqrt().cwiseQuotient(γₖ);
+                break;
+            default: throw std::out_of_range("Invalid PANOCStopCrit");
+        }
+    };
+
+    // Estimate Lipschitz constant ---------------------------------------------
+
+    // Finite difference approximation of ∇²ψ in starting point
+    if (params.Lipschitz.L₀ <= 0) {
+        auto &h = x̂ₖ;
+        h = (xₖ * params.Lipschitz.ε).cwiseAbs().cwiseMax(params.Lipschitz.δ);
+        x̂ₖ₊₁    = xₖ + h;
+        // Calculate ∇ψ(x₀ + h)
+        calc_grad_ψ(active, x̂ₖ₊₁, /* in ⟹ out */ grad_ψₖ₊₁);
+        // Calculate ψ(xₖ), ∇ψ(x₀)
+        calc_ψ_grad_ψ(active, xₖ, /* in ⟹ out */ grad_ψₖ, ψₖ);
+        // Estimate Lipschitz constant using finite differences
+        Lₖ = (grad_ψₖ₊₁ - grad_ψₖ).rowwise().norm().cwiseQuotient(
+            h.rowwise().norm());
+    }
+    // Initial Lipschitz constant provided by the user
+    else {
+        Lₖ.fill(params.Lipschitz.L₀);
+        // Calculate ψ(xₖ), ∇ψ(x₀)
+        calc_ψ_grad_ψ(active, xₖ, /* in ⟹ out */ grad_ψₖ, ψₖ);
+    }
+    active = Lₖ.array().isFinite();
+    for (Eigen::Index b = 0; b < B; ++b)
+        if (not active(b))
+            s.status[b] = SolverStatus::NotFinite;
+    if (not active.any())
+        return s;
+    Lₖ = active.select(Lₖ.array().max(params.L_min).min(params.L_max), 1)
+             .matrix();
+    γₖ = params.Lipschitz.Lγ_factor * Lₖ.cwiseInverse();
+    τ.setConstant(NaN);
+
+    // First projected gradient step -------------------------------------------
+
+    // Calculate x̂₀, p₀ (projected gradient step)
+    calc_x̂(γₖ, xₖ, grad_ψₖ, /* in ⟹ out */ x̂ₖ, pₖ, grad_ψₖᵀpₖ, pₖᵀpₖ);
+    // Calculate ψ(x̂ₖ) and ŷ(x̂ₖ)
+    calc_ψ_ŷ(active, x̂ₖ, /* in ⟹ out */ ŷx̂ₖ, ψx̂ₖ);
+
+    // Main PANOC loop
+    // =========================================================================
+    for (unsigned k = 0; k <= params.max_iter; ++k) {
+
+        // Quadratic upper bound -----------------------------------------------
+        if (k == 0) {
+            // Decrease step size until quadratic upper bound is satisfied
+            descent_lemma(active, xₖ, ψₖ, grad_ψₖ,
+                          /* in ⟹ out */ x̂ₖ, pₖ, ŷx̂ₖ,
+                          /* inout */ ψx̂ₖ, pₖᵀpₖ, grad_ψₖᵀpₖ, Lₖ, γₖ);
+            // Initialize L-BFGS
+            lbfgs.reset();
+        }
+        // Compute forward-backward envelope
+        φₖ = ψₖ + (0.5 * pₖᵀpₖ).cwiseQuotient(γₖ) + grad_ψₖᵀpₖ;
+        // Calculate ∇ψ(x̂ₖ)
+        if (need_grad_̂ψₖ)
+            calc_grad_ψ_from_ŷ(active, x̂ₖ, ŷx̂ₖ, /* in ⟹ out */ grad_̂ψₖ);
+
+        // Check stop condition ------------------------------------------------
+        calc_error_stop_crit(pₖ, pₖᵀpₖ, γₖ, grad_ψₖ, grad_̂ψₖ, εₖ);
+
+        if (progress_cb)
+            progress_cb({k, active, xₖ, pₖ, pₖᵀpₖ, x̂ₖ, φₖ, ψₖ, grad_ψₖ, ψx̂ₖ,
+                         grad_̂ψₖ, Lₖ, γₖ, τ, εₖ, Σ, y, problem, params});
+
+        auto time_elapsed = std::chrono::steady_clock::now() - start_time;
+        done.setConstant(false);
+        write.setConstant(false);
+        for (Eigen::Index b = 0; b < B; ++b) {
+            if (not active(b))
+                continue;
+            auto stop_status = detail::check_all_stop_conditions(
+                params, time_elapsed, k, stop_signal, ε, εₖ(b), no_progress(b));
+            if (stop_status == SolverStatus::Unknown)
+                continue;
+            done(b)         = true;
+            write(b)        = stop_status == SolverStatus::Converged ||
+                       stop_status == SolverStatus::Interrupted ||
+                       always_overwrite_results;
+            s.status[b]     = stop_status;
+            s.iterations[b] = k;
+            s.ε(b)          = εₖ(b);
+        }
+        if (write.any()) {
+            // err_z = g(x̂) - Π(g(x̂) + Σ⁻¹y, D)
+            if (m > 0) {
+                problem.g(write, x̂ₖ, work_m);
+                for (Eigen::Index j = 0; j < work_m.cols(); ++j)
+                    work_m.col(j) -= clamp(
+                        work_m.col(j) + y.col(j).cwiseQuotient(Σ.col(j)),
+                        vec::Constant(B, problem.D.lowerbound(j)),
+                        vec::Constant(B, problem.D.upperbound(j)));
+                select_rows(write, work_m, err_z);
+            }
+            select_rows(write, x̂ₖ, x);
+            select_rows(write, ŷx̂ₖ, y);
+        }
+        active = active && not done;
+        if (not active.any()) {
+            auto time_elapsed = std::chrono::steady_clock::now() - start_time;
+            s.batch_iterations = k;
+            s.elapsed_time     = duration_cast<microseconds>(time_elapsed);
+            return s;
+        }
+
+        // Calculate quasi-Newton step -----------------------------------------
+        real_t step_size =
+            params.lbfgs_stepsize == LBFGSStepSize::BasedOnGradientStepSize
+                ? 1
+                : -1;
+        qₖ = pₖ;
+        if (k > 0)
+            lbfgs.apply(qₖ, step_size);
+
+        // Line search initialization ------------------------------------------
+        σₖγₖ⁻¹pₖᵀpₖ = ((1 - γₖ.cwiseProduct(Lₖ).array()) * pₖᵀpₖ.array() /
+                       (2 * γₖ.array()))
+                          .matrix();
+        margin = ((1 + φₖ.array().abs()) *
+                  params.quadratic_upperbound_tolerance_factor)
+                     .matrix();
+
+        // Make sure quasi-Newton step is valid
+        if (k == 0) {
+            τ.setZero(); // Always use prox step on first iteration
+        } else {
+            τ.setOnes();
+            auto &q_not_finite = work_mask;
+            q_not_finite = active && not qₖ.array().isFinite().rowwise().all();
+            if (q_not_finite.any()) {
+                τ = q_not_finite.select(0, τ.array()).matrix();
+                s.lbfgs_failures += static_cast<unsigned>(q_not_finite.count());
+                lbfgs.reset(q_not_finite);
+            }
+        }
+
+        // Line search loop ----------------------------------------------------
+        // Only the instances that are still backtracking are evaluated, the
+        // others keep the step they accepted.
+        pending = active;
+        Lₖ₊₁    = Lₖ;
+        γₖ₊₁    = γₖ;
+        do {
+            Lₖ₊₁ = pending.select(Lₖ.array(), Lₖ₊₁.array()).matrix();
+            γₖ₊₁ = pending.select(γₖ.array(), γₖ₊₁.array()).matrix();
+
+            // Calculate xₖ₊₁
+            auto &prox = work_mask;
+            prox       = pending && τ.array() / 2 < params.τ_min;
+            step       = pending && not prox;
+            work_n = xₖ + (1 - τ.array()).matrix().asDiagonal() * pₖ +
+                     τ.asDiagonal() * qₖ;
+            select_rows(step, work_n, xₖ₊₁);
+            // Calculate ψ(xₖ₊₁), ∇ψ(xₖ₊₁)
+            calc_ψ_grad_ψ(step, xₖ₊₁, /* in ⟹ out */ grad_ψₖ₊₁, ψₖ₊₁);
+            if (prox.any()) { // line search failed → safe prox step
+                select_rows(prox, x̂ₖ, xₖ₊₁);
+                ψₖ₊₁ = prox.select(ψx̂ₖ.array(), ψₖ₊₁.array()).matrix();
+                if (need_grad_̂ψₖ)
+                    select_rows(prox, grad_̂ψₖ, grad_ψₖ₊₁);
+                else
+                    calc_grad_ψ_from_ŷ(prox, xₖ₊₁, ŷx̂ₖ,
+                                       /* in ⟹ out */ grad_ψₖ₊₁);
+            }
+
+            // Calculate x̂ₖ₊₁, pₖ₊₁ (projected gradient step in xₖ₊₁)
+            calc_x̂(γₖ₊₁, xₖ₊₁, grad_ψₖ₊₁, /* in ⟹ out */ x̂ₖ₊₁, pₖ₊₁,
+                   grad_ψₖ₊₁ᵀpₖ₊₁, pₖ₊₁ᵀpₖ₊₁);
+            // Calculate ψ(x̂ₖ₊₁) and ŷ(x̂ₖ₊₁)
+            calc_ψ_ŷ(pending, x̂ₖ₊₁, /* in ⟹ out */ ŷx̂ₖ₊₁, ψx̂ₖ₊₁);
+
+            // Quadratic upper bound -------------------------------------------
+            pₖ₊₁ᵀpₖ₊₁_ₖ = pₖ₊₁ᵀpₖ₊₁; // prox step with step size γₖ
+            // Decrease step size until quadratic upper bound is satisfied
+            descent_lemma(pending, xₖ₊₁, ψₖ₊₁, grad_ψₖ₊₁,
+                          /* in ⟹ out */ x̂ₖ₊₁, pₖ₊₁, ŷx̂ₖ₊₁,
+                          /* inout */ ψx̂ₖ₊₁, pₖ₊₁ᵀpₖ₊₁, grad_ψₖ₊₁ᵀpₖ₊₁,
+                          Lₖ₊₁, γₖ₊₁);
+
+            // Compute forward-backward envelope
+            φₖ₊₁ = ψₖ₊₁ + (0.5 * pₖ₊₁ᵀpₖ₊₁).cwiseQuotient(γₖ₊₁) +
+                   grad_ψₖ₊₁ᵀpₖ₊₁;
+            // Compute line search condition
+            ls_cond = φₖ₊₁ - (φₖ - σₖγₖ⁻¹pₖᵀpₖ);
+            if (params.alternative_linesearch_cond)
+                ls_cond -= ((0.5 / γₖ₊₁.array() - 0.5 / γₖ.array()) *
+                            pₖ₊₁ᵀpₖ₊₁_ₖ.array())
+                               .matrix();
+
+            τ       = pending.select(τ.array() / 2, τ.array()).matrix();
+            pending = pending && ls_cond.array() > margin.array() &&
+                      τ.array() >= params.τ_min;
+        } while (pending.any());
+
+        // If τ < τ_min the line search failed and we accepted the prox step
+        if (k != 0) {
+            auto &ls_failed = work_mask;
+            ls_failed       = active && τ.array() < params.τ_min;
+            s.linesearch_failures += static_cast<unsigned>(ls_failed.count());
+            τ = ls_failed.select(0, τ.array()).matrix();
+        }
+
+        // Update L-BFGS -------------------------------------------------------
+        auto &changed_γ = work_mask;
+        changed_γ       = active && γₖ.array() != γₖ₊₁.array();
+        if (changed_γ.any()) { // Flush L-BFGS if γ changed
+            if (lbfgs.get_params().rescale_when_γ_changes) {
+                work_B = changed_γ.select(γₖ₊₁.cwiseQuotient(γₖ).array(), 1)
+                             .matrix();
+                lbfgs.scale_y(work_B);
+            } else {
+                lbfgs.reset(changed_γ);
+            }
+        }
+
+        s.lbfgs_rejected += lbfgs.update(xₖ, xₖ₊₁, pₖ, pₖ₊₁, active);
+
+        // Check if we made any progress
+        if (k % params.max_no_progress == 0 || (no_progress.array() > 0).any()) {
+            auto &same = work_mask;
+            same       = (xₖ.array() == xₖ₊₁.array()).rowwise().all();
+            for (Eigen::Index b = 0; b < B; ++b)
+                if (active(b) && (no_progress(b) > 0 ||
+                                  k % params.max_no_progress == 0))
+                    no_progress(b) = same(b) ? no_progress(b) + 1 : 0;
+        }
+
+        // Advance step --------------------------------------------------------
+        Lₖ.swap(Lₖ₊₁);
+        γₖ.swap(γₖ₊₁);
+        ψₖ.swap(ψₖ₊₁);
+        ψx̂ₖ.swap(ψx̂ₖ₊₁);
+        φₖ.swap(φₖ₊₁);
+
+        xₖ.swap(xₖ₊₁);
+        x̂ₖ.swap(x̂ₖ₊₁);
+        ŷx̂ₖ.swap(ŷx̂ₖ₊₁);
+        pₖ.swap(pₖ₊₁);
+        grad_ψₖ.swap(grad_ψₖ₊₁);
+        grad_ψₖᵀpₖ.swap(grad_ψₖ₊₁ᵀpₖ₊₁);
+        pₖᵀpₖ.swap(pₖ₊₁ᵀpₖ₊₁);
+    }
+    throw std::logic_error("[Batched PANOC] loop error");
+}
+
+} // namespace alpaqa
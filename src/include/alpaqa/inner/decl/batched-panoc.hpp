@@ -0,0 +1,173 @@
+#pragma once
+
+#include <alpaqa/inner/decl/panoc.hpp>
+#include <alpaqa/inner/directions/decl/batched-lbfgs.hpp>
+#include <alpaqa/util/atomic_stop_signal.hpp>
+#include <alpaqa/util/batched-problem.hpp>
+#include <alpaqa/util/solverstatus.hpp>
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace alpaqa {
+
+struct BatchedPANOCStats {
+    /// Status of each instance.
+    std::vector<SolverStatus> status;
+    /// Final tolerance of each instance.
+    vec ε;
+    /// Number of iterations of each instance.
+    std::vector<unsigned> iterations;
+    /// Number of iterations of the batch (i.e. of the slowest instance).
+    unsigned batch_iterations = 0;
+    std::chrono::microseconds elapsed_time;
+    unsigned linesearch_failures = 0; ///< Total for all instances
+    unsigned lbfgs_failures      = 0; ///< Total for all instances
+    unsigned lbfgs_rejected      = 0; ///< Total for all instances
+};
+
+/// Progress information of @ref BatchedPANOCSolver, with one row or element
+/// per instance. Only the instances selected by @ref active are valid.
+struct BatchedPANOCProgressInfo {
+    unsigned k;
+    const lane_mask &active;
+    crmat x;
+    crmat p;
+    crvec norm_sq_p;
+    crmat x_hat;
+    crvec φγ;
+    crvec ψ;
+    crmat grad_ψ;
+    crvec ψ_hat;
+    crmat grad_ψ_hat;
+    crvec L;
+    crvec γ;
+    crvec τ;
+    crvec ε;
+    crmat Σ;
+    crmat y;
+    const BatchedProblem &problem;
+    const PANOCParams &params;
+};
+
+/// PANOC solver for a batch of small problems with the same structure, where
+/// the vector operations are vectorized across the instances instead of
+/// within a single instance (see @ref BatchedProblem).
+///
+/// All instances are advanced in lockstep. Each instance has its own step
+/// size, Lipschitz estimate and line search parameter τ, and the decisions
+/// that depend on them (quadratic upper bound, line search acceptance and
+/// stopping criterion) are made per instance using lane masks. The problem
+/// functions only have to evaluate the instances that need it: while some
+/// instances are still backtracking, the instances that already accepted their
+/// step are masked out, and so are the instances that have finished. The
+/// iterates of each instance are the same as those of @ref PANOCSolver with
+/// @ref LBFGS.
+///
+/// Supports the same parameters as @ref PANOCSolver, except for the stopping
+/// criteria that need the unit-step projected gradient (@ref
+/// PANOCStopCrit::ProjGradUnitNorm, @ref PANOCStopCrit::ProjGradUnitNorm2 and
+/// @ref PANOCStopCrit::Ipopt), the warm-start options, and
+/// @ref PANOCParams::update_lipschitz_in_linesearch, which is always enabled.
+/// @ingroup    grp_InnerSolvers
+class BatchedPANOCSolver {
+  public:
+    using Params       = PANOCParams;
+    using Stats        = BatchedPANOCStats;
+    using ProgressInfo = BatchedPANOCProgressInfo;
+
+    BatchedPANOCSolver(Params params, LBFGSParams lbfgsparams)
+        : params(params), lbfgs(lbfgsparams) {}
+
+    /// @param  [in] problem
+    ///         Problem description.
+    /// @param  [in] Σ
+    ///         Constraint weights @f$ \Sigma @f$ of each instance (B × m).
+    /// @param  [in] ε
+    ///         Tolerance @f$ \varepsilon @f$.
+    /// @param  [in] always_overwrite_results
+    ///         Overwrite @p x, @p y and @p err_z even if not converged.
+    /// @param  [inout] x
+    ///         Decision variables @f$ x @f$ of each instance (B × n).
+    /// @param  [inout] y
+    ///         Lagrange multipliers @f$ y @f$ of each instance (B × m).
+    /// @param  [out] err_z
+    ///         Slack variable errors @f$ g(x) - z @f$ of each instance
+    ///         (B × m).
+    Stats operator()(const BatchedProblem &problem, crmat Σ, real_t ε,
+                     bool always_overwrite_results, rmat x, rmat y,
+                     rmat err_z);
+
+    BatchedPANOCSolver &
+    set_progress_callback(std::function<void(const ProgressInfo &)> cb) {
+        this->progress_cb = cb;
+        return *this;
+    }
+
+    std::string get_name() const;
+
+    void stop() { stop_signal.stop(); }
+
+    const Params &get_params() const { return params; }
+
+  private:
+    Params params;
+    AtomicStopSignal stop_signal;
+    std::function<void(const ProgressInfo &)> progress_cb;
+
+    /// Storage for the iterates and work matrices (one row or element per
+    /// instance), kept between calls so that solving batches of the same size
+    /// doesn't allocate.
+    struct Workspace {
+        mat xₖ,        ///< Value of x at the beginning of the iteration
+            x̂ₖ,        ///< Value of x after a projected gradient step
+            xₖ₊₁,      ///< xₖ for next iteration
+            x̂ₖ₊₁,      ///< x̂ₖ for next iteration
+            ŷx̂ₖ,       ///< ŷ(x̂ₖ) = Σ (g(x̂ₖ) - ẑₖ)
+            ŷx̂ₖ₊₁,     ///< ŷ(x̂ₖ) for next iteration
+            pₖ,        ///< Projected gradient step pₖ = x̂ₖ - xₖ
+            pₖ₊₁,      ///< Projected gradient step pₖ₊₁ = x̂ₖ₊₁ - xₖ₊₁
+            qₖ,        ///< Newton step Hₖ pₖ
+            grad_ψₖ,   ///< ∇ψ(xₖ)
+            grad_̂ψₖ,   ///< ∇ψ(x̂ₖ)
+            grad_ψₖ₊₁; ///< ∇ψ(xₖ₊₁)
+        mat work_n, work_n2, work_m;
+        vec ψₖ, ψₖ₊₁, ψx̂ₖ, ψx̂ₖ₊₁, φₖ, φₖ₊₁, Lₖ, Lₖ₊₁, γₖ, γₖ₊₁, τ, grad_ψₖᵀpₖ,
+            grad_ψₖ₊₁ᵀpₖ₊₁, pₖᵀpₖ, pₖ₊₁ᵀpₖ₊₁, pₖ₊₁ᵀpₖ₊₁_ₖ, σₖγₖ⁻¹pₖᵀpₖ, margin,
+            ls_cond, εₖ, work_B;
+        /// Number of successive iterations that didn't update the iterate.
+        Eigen::Matrix<unsigned, Eigen::Dynamic, 1> no_progress;
+        lane_mask active,  ///< Instances that haven't finished yet
+            done,          ///< Instances that finished in this iteration
+            write,         ///< Instances whose results are written
+            pending,       ///< Instances that are still backtracking
+            step,          ///< Instances that take a step in this backtrack
+            violated,      ///< Instances that violate the upper bound
+            work_mask;
+
+        /// Resize all matrices (no-op if the sizes didn't change).
+        void resize(Eigen::Index B, Eigen::Index n, Eigen::Index m) {
+            for (mat *v : {&xₖ, &x̂ₖ, &xₖ₊₁, &x̂ₖ₊₁, &pₖ, &pₖ₊₁, &qₖ, &grad_ψₖ,
+                           &grad_̂ψₖ, &grad_ψₖ₊₁, &work_n, &work_n2})
+                v->resize(B, n);
+            for (mat *v : {&ŷx̂ₖ, &ŷx̂ₖ₊₁, &work_m})
+                v->resize(B, m);
+            for (vec *v : {&ψₖ, &ψₖ₊₁, &ψx̂ₖ, &ψx̂ₖ₊₁, &φₖ, &φₖ₊₁, &Lₖ, &Lₖ₊₁,
+                           &γₖ, &γₖ₊₁, &τ, &grad_ψₖᵀpₖ, &grad_ψₖ₊₁ᵀpₖ₊₁, &pₖᵀpₖ,
+                           &pₖ₊₁ᵀpₖ₊₁, &pₖ₊₁ᵀpₖ₊₁_ₖ, &σₖγₖ⁻¹pₖᵀpₖ, &margin,
+                           &ls_cond, &εₖ, &work_B})
+                v->resize(B);
+            no_progress.resize(B);
+            for (lane_mask *v :
+                 {&active, &done, &write, &pending, &step, &violated, &work_mask})
+                v->resize(B);
+        }
+    } work;
+
+  public:
+    BatchedLBFGS lbfgs;
+};
+
+} // namespace alpaqa
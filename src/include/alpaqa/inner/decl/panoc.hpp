@@ -8,11 +8,14 @@
 #include <alpaqa/util/lipschitz.hpp>
 #include <alpaqa/util/problem.hpp>
 #include <alpaqa/util/solverstatus.hpp>
+#include <alpaqa/util/thread-pool.hpp>
 
 #include <atomic>
 #include <chrono>
 #include <limits>
+#include <optional>
 #include <string>
+#include <type_traits>
 
 namespace alpaqa {
 
@@ -46,6 +49,50 @@ struct PANOCParams {
     bool alternative_linesearch_cond    = false;
 
     LBFGSStepSize lbfgs_stepsize = LBFGSStepSize::BasedOnCurvature;
+
+    /// Keep the history of the direction provider (e.g. the L-BFGS memory)
+    /// between successive calls of the solver, instead of initializing it
+    /// again in every call. In consecutive ALM iterations, the inner problems
+    /// only differ in y and Σ, so most of the curvature information is still
+    /// valid. If the step size γ differs from the final step size of the
+    /// previous call, the direction provider's own policy applies (see
+    /// @ref LBFGSParams::rescale_when_γ_changes).
+    /// @see PANOCSolver::reset_warm_start
+    bool keep_direction_history = false;
+    /// The history kept by @ref keep_direction_history is discarded if any of
+    /// the penalty factors Σᵢ increased by more than this factor since the
+    /// previous call, because the curvature of ψ in the directions of the
+    /// corresponding constraints changed too much.
+    real_t keep_direction_history_max_Σ_increase = 10;
+    /// Start from the final Lipschitz estimate of the previous call, scaled by
+    /// the change of the largest penalty factor, instead of estimating it
+    /// using finite differences (or using @ref LipschitzEstimateParams::L₀).
+    /// Across ALM iterations, the Lipschitz constant of ∇ψ grows roughly in
+    /// proportion to Σ, so this avoids the gradient evaluations of the
+    /// finite-difference estimate and most of the initial backtracking of
+    /// the step size.
+    /// @see PANOCSolver::reset_warm_start
+    bool reuse_lipschitz_estimate = false;
+    /// Number of line search step sizes τ, τ/2, τ/4, … that are evaluated in
+    /// parallel. The largest step size that satisfies the line search
+    /// condition is accepted, so the iterates are the same as with the
+    /// sequential line search, but a line search that needs several
+    /// backtracking steps takes about as long as a single evaluation of ψ and
+    /// ∇ψ when the evaluations are expensive. The candidates are only
+    /// evaluated in parallel if @ref Problem::f, @ref Problem::grad_f,
+    /// @ref Problem::g and @ref Problem::grad_g_prod (and
+    /// @ref Problem::f_grad_f, if provided) are declared thread-safe in
+    /// @ref Problem::thread_safe, and if the problem doesn't provide
+    /// @ref Problem::ψ, @ref Problem::ψ_grad_ψ or @ref Problem::grad_L.
+    /// Otherwise, or if set to 0 or 1, the sequential line search is used.
+    unsigned linesearch_parallel_candidates = 1;
+    /// Evaluate independent functions of the problem at the same time, using
+    /// one extra thread: f(x) and g(x) in ψ(x), ∇f(x) and ∇g(x)ŷ in ∇ψ(x),
+    /// and ∇ψ(x̂ₖ) and the quasi-Newton step. Only the functions that are
+    /// declared thread-safe in @ref Problem::thread_safe are evaluated in
+    /// parallel. The iterates are the same as without concurrent evaluations.
+    /// This only pays off if the evaluations are expensive.
+    bool concurrent_evaluations = false;
 };
 
 struct PANOCStats {
@@ -107,6 +154,20 @@ class PANOCSolver {
                      rvec y,                        // inout
                      rvec err_z);                   // out
 
+    /// Solve a problem with a static interface (see @ref is_static_problem),
+    /// without the overhead of the type-erased @ref Problem.
+    template <class ProblemT,
+              class = std::enable_if_t<is_static_problem_v<ProblemT>>>
+    Stats operator()(const ProblemT &problem,       // in
+                     crvec Σ,                       // in
+                     real_t ε,                      // in
+                     bool always_overwrite_results, // in
+                     rvec x,                        // inout
+                     rvec y,                        // inout
+                     rvec err_z) {                  // out
+        return solve(problem, Σ, ε, always_overwrite_results, x, y, err_z);
+    }
+
     PANOCSolver &
     set_progress_callback(std::function<void(const ProgressInfo &)> cb) {
         this->progress_cb = cb;
@@ -117,17 +178,106 @@ class PANOCSolver {
 
     void stop() { stop_signal.stop(); }
 
+    /// Discard the history of the direction provider and the Lipschitz
+    /// estimate that were kept from the previous call, see
+    /// @ref PANOCParams::keep_direction_history and
+    /// @ref PANOCParams::reuse_lipschitz_estimate. Should be called before
+    /// solving a different problem of the same size.
+    void reset_warm_start() { prev_call.valid = false; }
+
+    /// State that is kept between calls, see @ref get_warm_start.
+    struct WarmStart;
+    /// Copy the state that is kept between calls (Lipschitz estimate, step
+    /// size and direction provider) to @p ws, so it can be restored later
+    /// using @ref set_warm_start, e.g. when alternating between different
+    /// problems. The storage of @p ws is reused if the sizes match.
+    void get_warm_start(WarmStart &ws) const;
+    /// Restore the state that is kept between calls.
+    void set_warm_start(const WarmStart &ws);
+
     const Params &get_params() const { return params; }
 
   private:
+    template <class ProblemT>
+    Stats solve(const ProblemT &problem, crvec Σ, real_t ε,
+                bool always_overwrite_results, rvec x, rvec y, rvec err_z);
+
     Params params;
     AtomicStopSignal stop_signal;
     std::function<void(const ProgressInfo &)> progress_cb;
 
+    /// Storage for the iterates and work vectors, kept between calls so that
+    /// solving problems of the same size doesn't allocate.
+    struct Workspace {
+        vec xₖ,        ///< Value of x at the beginning of the iteration
+            x̂ₖ,        ///< Value of x after a projected gradient step
+            xₖ₊₁,      ///< xₖ for next iteration
+            x̂ₖ₊₁,      ///< x̂ₖ for next iteration
+            ŷx̂ₖ,       ///< ŷ(x̂ₖ) = Σ (g(x̂ₖ) - ẑₖ)
+            ŷx̂ₖ₊₁,     ///< ŷ(x̂ₖ) for next iteration
+            pₖ,        ///< Projected gradient step pₖ = x̂ₖ - xₖ
+            pₖ₊₁,      ///< Projected gradient step pₖ₊₁ = x̂ₖ₊₁ - xₖ₊₁
+            qₖ,        ///< Newton step Hₖ pₖ
+            grad_ψₖ,   ///< ∇ψ(xₖ)
+            grad_̂ψₖ,   ///< ∇ψ(x̂ₖ)
+            grad_ψₖ₊₁; ///< ∇ψ(xₖ₊₁)
+        vec work_n, work_m;
+
+        /// Iterate and scalars of one step size of the parallel line search
+        /// (see @ref PANOCParams::linesearch_parallel_candidates).
+        struct LineSearchCandidate {
+            vec xₖ₊₁, x̂ₖ₊₁, ŷx̂ₖ₊₁, pₖ₊₁, grad_ψₖ₊₁, work_n, work_m;
+            real_t τ, Lₖ₊₁, γₖ₊₁, ψₖ₊₁, ψx̂ₖ₊₁, φₖ₊₁, grad_ψₖ₊₁ᵀpₖ₊₁,
+                pₖ₊₁ᵀpₖ₊₁, ls_cond;
+        };
+        std::vector<LineSearchCandidate> candidates;
+
+        /// Resize all vectors (no-op if the sizes didn't change).
+        void resize(Eigen::Index n, Eigen::Index m, bool need_grad_̂ψₖ,
+                    unsigned num_candidates) {
+            for (vec *v : {&xₖ, &x̂ₖ, &xₖ₊₁, &x̂ₖ₊₁, &pₖ, &pₖ₊₁, &qₖ, &grad_ψₖ,
+                           &grad_ψₖ₊₁, &work_n})
+                v->resize(n);
+            for (vec *v : {&ŷx̂ₖ, &ŷx̂ₖ₊₁, &work_m})
+                v->resize(m);
+            grad_̂ψₖ.resize(need_grad_̂ψₖ ? n : 0);
+            candidates.resize(num_candidates > 1 ? num_candidates : 0);
+            for (auto &c : candidates) {
+                for (vec *v : {&c.xₖ₊₁, &c.x̂ₖ₊₁, &c.pₖ₊₁, &c.grad_ψₖ₊₁,
+                               &c.work_n})
+                    v->resize(n);
+                for (vec *v : {&c.ŷx̂ₖ₊₁, &c.work_m})
+                    v->resize(m);
+            }
+        }
+    } work;
+    /// Threads for the parallel line search.
+    ThreadPool thread_pool;
+    /// Thread for the concurrent evaluations, see
+    /// @ref PANOCParams::concurrent_evaluations.
+    ThreadPool eval_pool;
+
+    /// State at the end of the previous call, used to warm-start the next
+    /// one, see @ref PANOCParams::keep_direction_history and
+    /// @ref PANOCParams::reuse_lipschitz_estimate.
+    struct PreviousCall {
+        bool valid     = false; ///< Whether the state below can be used
+        Eigen::Index n = 0;     ///< Number of variables of the previous call
+        real_t L       = NaN;   ///< Final Lipschitz estimate
+        real_t γ       = NaN;   ///< Final step size
+        vec Σ;                  ///< Penalty factors of the previous call
+    } prev_call;
+
   public:
     PANOCDirection<DirectionProvider> direction_provider;
 };
 
+template <class DirectionProviderT>
+struct PANOCSolver<DirectionProviderT>::WarmStart {
+    PreviousCall prev_call;
+    std::optional<PANOCDirection<DirectionProvider>> direction_provider;
+};
+
 template <class InnerSolverStats>
 struct InnerStatsAccumulator;
 
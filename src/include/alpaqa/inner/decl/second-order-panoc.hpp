@@ -2,15 +2,22 @@
 
 #include <alpaqa/inner/decl/panoc-fwd.hpp>
 #include <alpaqa/inner/decl/panoc-stop-crit.hpp>
+#include <alpaqa/inner/newton.hpp>
 #include <alpaqa/util/atomic_stop_signal.hpp>
 #include <alpaqa/util/lipschitz.hpp>
 #include <alpaqa/util/problem.hpp>
 #include <alpaqa/util/solverstatus.hpp>
+#include <alpaqa/util/sparse-hessian.hpp>
+#include <alpaqa/util/sparse-jacobian.hpp>
 
 #include <atomic>
 #include <chrono>
 #include <limits>
 #include <string>
+#include <vector>
+
+#include <Eigen/Cholesky>
+#include <Eigen/SparseCholesky>
 
 namespace alpaqa {
 
@@ -42,9 +49,38 @@ struct SecondOrderPANOCParams {
 
     bool update_lipschitz_in_linesearch = true;
     bool alternative_linesearch_cond    = false;
+
+    /// Number of iterations between evaluations of the (dense) Hessian.
+    /// In the iterations in between, the last Hessian and its factorization
+    /// are reused, and changes of the set of inactive indices are applied to
+    /// the factorization as low-rank updates. The Hessian is re-evaluated
+    /// early if a Newton step or the line search failed.
+    /// The default of 1 evaluates and factorizes the Hessian in every
+    /// iteration. Not used when the problem provides a sparse Hessian.
+    unsigned hessian_update_interval = 1;
+    /// Maximum number of indices that can enter or leave the set of inactive
+    /// indices before the reused Hessian is refactorized from scratch rather
+    /// than updated (each index requires two rank-one updates).
+    unsigned max_factorization_updates = 8;
+
+    /// Compute the Newton step using the truncated conjugate gradient method
+    /// (@ref steihaug_cg), using only Hessian-vector products
+    /// (@ref Problem::hess_ψ_prod if available, otherwise
+    /// @ref Problem::hess_L_prod and the constraint Jacobian). The Hessian is
+    /// never formed or factorized, so this is suitable for large problems.
+    bool matrix_free = false;
+    /// Parameters for the conjugate gradient method (if @ref matrix_free).
+    NewtonCGParams newton_cg;
 };
 
 /// Second order PANOC solver for ALM.
+///
+/// If the problem provides a sparse Hessian (@ref Problem::hess_L_sparse) and,
+/// if it has general constraints, a sparse Jacobian (@ref Problem::jac_g), the
+/// Newton systems are solved using a sparse LDLᵀ factorization. Its symbolic
+/// analysis is performed only once, since the sparsity pattern of the Hessian
+/// doesn't change between iterations. Otherwise, the dense Hessian
+/// (@ref Problem::hess_L) is used.
 /// @ingroup    grp_InnerSolvers
 class SecondOrderPANOCSolver {
   public:
@@ -54,12 +90,20 @@ class SecondOrderPANOCSolver {
         SolverStatus status = SolverStatus::Unknown;
         real_t ε            = inf;
         std::chrono::microseconds elapsed_time;
-        unsigned iterations          = 0;
-        unsigned newton_failures     = 0;
-        unsigned linesearch_failures = 0;
-        unsigned τ_1_accepted        = 0;
-        unsigned count_τ             = 0;
-        real_t sum_τ                 = 0;
+        unsigned iterations            = 0;
+        unsigned newton_failures       = 0;
+        unsigned linesearch_failures   = 0;
+        unsigned τ_1_accepted          = 0;
+        unsigned count_τ               = 0;
+        real_t sum_τ                   = 0;
+        unsigned cg_iterations         = 0;
+        /// Number of factorizations of the Newton system computed from
+        /// scratch.
+        unsigned factorizations        = 0;
+        /// Number of indices that entered or left the set of inactive indices
+        /// and that were handled by updating the factorization of the reused
+        /// Hessian (see @ref SecondOrderPANOCParams::hessian_update_interval).
+        unsigned factorization_updates = 0;
     };
 
     struct ProgressInfo {
@@ -107,6 +151,73 @@ class SecondOrderPANOCSolver {
     Params params;
     AtomicStopSignal stop_signal;
     std::function<void(const ProgressInfo &)> progress_cb;
+
+    /// Storage for the iterates, the Hessian and work vectors, kept between
+    /// calls so that solving problems of the same size doesn't allocate.
+    struct Workspace {
+        vec xₖ,        ///< Value of x at the beginning of the iteration
+            x̂ₖ,        ///< Value of x after a projected gradient step
+            xₖ₊₁,      ///< xₖ for next iteration
+            x̂ₖ₊₁,      ///< x̂ₖ for next iteration
+            ŷx̂ₖ,       ///< ŷ(x̂ₖ) = Σ (g(x̂ₖ) - ẑₖ)
+            ŷx̂ₖ₊₁,     ///< ŷ(x̂ₖ) for next iteration
+            pₖ,        ///< Projected gradient step pₖ = x̂ₖ - xₖ
+            pₖ₊₁,      ///< Projected gradient step pₖ₊₁ = x̂ₖ₊₁ - xₖ₊₁
+            qₖ,        ///< Newton step Hₖ pₖ
+            grad_ψₖ,   ///< ∇ψ(xₖ)
+            grad_̂ψₖ,   ///< ∇ψ(x̂ₖ)
+            grad_ψₖ₊₁; ///< ∇ψ(xₖ₊₁)
+        vec work_n, work_m;
+        mat H;       ///< Hessian of the (augmented) Lagrangian function and ψ
+        vec g,       ///< Value of the constraint function
+            grad_gi, ///< Gradient of one of the constraints
+            qJ,      ///< Solution of Newton Hessian system
+            rhs;     ///< Right-hand side of Newton Hessian system
+        /// Inactive (J) and active (K) indices
+        std::vector<vec::Index> J, K;
+        /// Factorization of @ref H_red (only used for the dense Hessian)
+        Eigen::LDLT<mat> ldl;
+        /// Hessian with the rows and columns of the active indices replaced
+        /// by the identity (only used for the dense Hessian)
+        mat H_red;
+        /// Inactive indices of the current factorization in @ref ldl (only
+        /// used when the Hessian is reused)
+        std::vector<bool> ldl_inactive;
+        /// Work vectors for the conjugate gradient method (only used if
+        /// @ref SecondOrderPANOCParams::matrix_free)
+        vec cg_x, cg_r, cg_z, cg_p, cg_Hp,
+            cg_M, ///< Diagonal preconditioner
+            ŷxₖ;  ///< ŷ(xₖ)
+        /// Sparse constraint Jacobian (if provided by the problem)
+        SparseJacobian jac_g;
+        /// Sparse Hessian of the augmented Lagrangian (if provided by the
+        /// problem)
+        SparseHessian hess;
+        /// Sparse factorization of the Hessian in the inactive indices, the
+        /// symbolic analysis is reused as long as the pattern doesn't change
+        Eigen::SimplicialLDLT<SparseHessian::matrix_t, Eigen::Upper> sparse_ldl;
+
+        Workspace() = default;
+        /// Copies start with an empty workspace, because the sparse
+        /// factorization can't be copied (everything is reallocated and
+        /// analyzed again on the first call).
+        Workspace(const Workspace &) : Workspace() {}
+        Workspace &operator=(const Workspace &) = delete;
+
+        /// Resize all vectors (no-op if the sizes didn't change).
+        void resize(Eigen::Index n, Eigen::Index m, bool matrix_free) {
+            for (vec *v : {&xₖ, &x̂ₖ, &xₖ₊₁, &x̂ₖ₊₁, &pₖ, &pₖ₊₁, &qₖ, &grad_ψₖ,
+                           &grad_̂ψₖ, &grad_ψₖ₊₁, &work_n, &grad_gi, &qJ, &rhs})
+                v->resize(n);
+            for (vec *v : {&ŷx̂ₖ, &ŷx̂ₖ₊₁, &work_m, &g})
+                v->resize(m);
+            for (vec *v : {&cg_x, &cg_r, &cg_z, &cg_p, &cg_Hp, &cg_M})
+                v->resize(matrix_free ? n : 0);
+            ŷxₖ.resize(matrix_free ? m : 0);
+            J.reserve(n);
+            K.reserve(n);
+        }
+    } work;
 };
 
 template <class InnerSolverStats>
@@ -115,12 +226,15 @@ struct InnerStatsAccumulator;
 template <>
 struct InnerStatsAccumulator<SecondOrderPANOCSolver::Stats> {
     std::chrono::microseconds elapsed_time;
-    unsigned iterations          = 0;
-    unsigned newton_failures     = 0;
-    unsigned linesearch_failures = 0;
-    unsigned τ_1_accepted        = 0;
-    unsigned count_τ             = 0;
-    real_t sum_τ                 = 0;
+    unsigned iterations            = 0;
+    unsigned newton_failures       = 0;
+    unsigned linesearch_failures   = 0;
+    unsigned τ_1_accepted          = 0;
+    unsigned count_τ               = 0;
+    real_t sum_τ                   = 0;
+    unsigned cg_iterations         = 0;
+    unsigned factorizations        = 0;
+    unsigned factorization_updates = 0;
 };
 
 inline InnerStatsAccumulator<SecondOrderPANOCSolver::Stats> &
@@ -133,6 +247,9 @@ operator+=(InnerStatsAccumulator<SecondOrderPANOCSolver::Stats> &acc,
     acc.τ_1_accepted += s.τ_1_accepted;
     acc.count_τ += s.count_τ;
     acc.sum_τ += s.sum_τ;
+    acc.cg_iterations += s.cg_iterations;
+    acc.factorizations += s.factorizations;
+    acc.factorization_updates += s.factorization_updates;
     return acc;
 }
 
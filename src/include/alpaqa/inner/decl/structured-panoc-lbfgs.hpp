@@ -48,9 +48,17 @@ struct StructuredPANOCLBFGSParams {
     bool update_lipschitz_in_linesearch = true;
     bool alternative_linesearch_cond    = false;
 
-    bool hessian_vec                    = true;
+    /// Use Hessian-vector products with the active part of the step to
+    /// compute the right-hand side of the Newton system.
+    bool hessian_vec = true;
+    /// Approximate the Hessian-vector products using finite differences of
+    /// the gradient of ψ. Not used if the problem provides the exact
+    /// product @ref Problem::hess_ψ_prod (and @ref full_augmented_hessian
+    /// is set).
     bool hessian_vec_finite_differences = true;
-    bool full_augmented_hessian         = true;
+    /// Use the Hessian of the augmented Lagrangian ψ, rather than only the
+    /// Hessian of the Lagrangian.
+    bool full_augmented_hessian = true;
 
     unsigned hessian_step_size_heuristic = 0;
 
@@ -127,6 +135,38 @@ class StructuredPANOCLBFGSSolver {
     AtomicStopSignal stop_signal;
     std::function<void(const ProgressInfo &)> progress_cb;
 
+    /// Storage for the iterates and work vectors, kept between calls so that
+    /// solving problems of the same size doesn't allocate.
+    struct Workspace {
+        vec xₖ,        ///< Value of x at the beginning of the iteration
+            x̂ₖ,        ///< Value of x after a projected gradient step
+            xₖ₊₁,      ///< xₖ for next iteration
+            x̂ₖ₊₁,      ///< x̂ₖ for next iteration
+            ŷx̂ₖ,       ///< ŷ(x̂ₖ) = Σ (g(x̂ₖ) - ẑₖ)
+            ŷx̂ₖ₊₁,     ///< ŷ(x̂ₖ) for next iteration
+            pₖ,        ///< Projected gradient step pₖ = x̂ₖ - xₖ
+            pₖ₊₁,      ///< Projected gradient step pₖ₊₁ = x̂ₖ₊₁ - xₖ₊₁
+            qₖ,        ///< Newton step Hₖ pₖ
+            grad_ψₖ,   ///< ∇ψ(xₖ)
+            grad_̂ψₖ,   ///< ∇ψ(x̂ₖ)
+            grad_ψₖ₊₁, ///< ∇ψ(xₖ₊₁)
+            HqK;       ///< Hessian-vector product with the active part of qₖ
+        vec work_n, work_n2, work_m;
+        /// Inactive indices
+        std::vector<vec::Index> J;
+
+        /// Resize all vectors (no-op if the sizes didn't change).
+        void resize(Eigen::Index n, Eigen::Index m, bool need_grad_̂ψₖ) {
+            for (vec *v : {&xₖ, &x̂ₖ, &xₖ₊₁, &x̂ₖ₊₁, &pₖ, &pₖ₊₁, &qₖ, &grad_ψₖ,
+                           &grad_ψₖ₊₁, &HqK, &work_n, &work_n2})
+                v->resize(n);
+            for (vec *v : {&ŷx̂ₖ, &ŷx̂ₖ₊₁, &work_m})
+                v->resize(m);
+            grad_̂ψₖ.resize(need_grad_̂ψₖ ? n : 0);
+            J.reserve(n);
+        }
+    } work;
+
   public:
     LBFGS lbfgs;
 };
@@ -4,80 +4,205 @@
 #include <alpaqa/util/atomic_stop_signal.hpp>
 #include <alpaqa/util/problem.hpp>
 #include <alpaqa/util/solverstatus.hpp>
+#include <alpaqa/util/sparse-hessian.hpp>
+#include <alpaqa/util/sparse-jacobian.hpp>
+#include <alpaqa/util/thread-pool.hpp>
 
 #include <stdexcept>
+#include <type_traits>
 
 namespace alpaqa::detail {
 
+/// Whether the problem type can provide the optional fused evaluations
+/// (@ref Problem::f_grad_f, @ref Problem::grad_L, @ref Problem::ψ,
+/// @ref Problem::ψ_grad_ψ).
+/// Problems with a static interface always use the separate functions.
+template <class ProblemT>
+constexpr bool has_fused_evaluations_v = std::is_base_of_v<Problem, ProblemT>;
+
+template <class ProblemT, class = void>
+struct has_thread_safety : std::false_type {};
+template <class ProblemT>
+struct has_thread_safety<
+    ProblemT,
+    std::void_t<decltype(std::declval<const ProblemT &>().thread_safe)>>
+    : std::true_type {};
+
+/// Which functions of the problem can be evaluated in parallel (see
+/// @ref Problem::thread_safe). Nothing is thread-safe unless declared.
+template <class ProblemT>
+inline ProblemThreadSafety thread_safety(const ProblemT &p) {
+    if constexpr (has_thread_safety<ProblemT>::value)
+        return p.thread_safe;
+    else
+        return {};
+}
+
+/// Whether all functions that are used to evaluate ψ(x) and ∇ψ(x) are
+/// thread-safe, so that several points can be evaluated in parallel (e.g. the
+/// step sizes in the parallel line search of PANOC). The fused evaluations
+/// @ref Problem::ψ, @ref Problem::ψ_grad_ψ and @ref Problem::grad_L can't be
+/// declared thread-safe, so problems that provide them are never evaluated in
+/// parallel.
+template <class ProblemT>
+inline bool ψ_grad_ψ_thread_safe(const ProblemT &p) {
+    auto ts = thread_safety(p);
+    if constexpr (has_fused_evaluations_v<ProblemT>) {
+        if (p.ψ || p.ψ_grad_ψ || p.grad_L)
+            return false;
+        if (p.f_grad_f && not ts.f_grad_f)
+            return false;
+    }
+    return ts.f && ts.grad_f && ts.g && ts.grad_g_prod;
+}
+
+/// Evaluate `a()` and `b()` in parallel on the given thread pool, or one after
+/// the other if @p pool is null. `a()` is always evaluated on the calling
+/// thread.
+template <class A, class B>
+inline void invoke_concurrently(ThreadPool *pool, A &&a, B &&b) {
+    if (pool == nullptr) {
+        a();
+        b();
+        return;
+    }
+    pool->run(2, [&](size_t i) { i == 0 ? a() : b(); });
+}
+
+/// Calculate the vector ŷ from the constraint values g(x), and return the
+/// term dᵀŷ of the augmented Lagrangian.
+/// @f[ \hat{y} = \Sigma\, d = \Sigma \left(\zeta - \Pi_D(\zeta)\right),
+/// \quad \zeta = g(x) + \Sigma^{-1}y @f]
+template <class ProblemT>
+inline real_t calc_ŷ_dᵀŷ(const ProblemT &p, ///< [in]  Problem description
+                          rvec g_ŷ, ///< [inout] @f$ g(x) @f$ ⟹ @f$ \hat{y} @f$
+                          crvec y,  ///< [in]  Lagrange multipliers @f$ y @f$
+                          crvec Σ   ///< [in]  Penalty weights @f$ \Sigma @f$
+) {
+    // ζ = g(x) + Σ⁻¹y
+    g_ŷ += Σ.asDiagonal().inverse() * y;
+    // d = ζ - Π(ζ, D)
+    g_ŷ = projecting_difference(g_ŷ, p.D);
+    // dᵀŷ, ŷ = Σ d
+    real_t dᵀŷ = Σ.dot(g_ŷ.cwiseAbs2());
+    g_ŷ.array() *= Σ.array();
+    return dᵀŷ;
+}
+
 /// Calculate both ψ(x) and the vector ŷ that can later be used to compute ∇ψ.
 /// @f[ \psi(x^k) = f(x^k) + \frac{1}{2}
 /// \text{dist}_\Sigma^2\left(g(x^k) + \Sigma^{-1}y,\;D\right) @f]
 /// @f[ \hat{y}  @f]
-inline real_t calc_ψ_ŷ(const Problem &p, ///< [in]  Problem description
-                       crvec x,          ///< [in]  Decision variable @f$ x @f$
+template <class ProblemT>
+inline real_t calc_ψ_ŷ(const ProblemT &p, ///< [in]  Problem description
+                       crvec x,           ///< [in]  Decision variable @f$ x @f$
                        crvec y, ///< [in]  Lagrange multipliers @f$ y @f$
                        crvec Σ, ///< [in]  Penalty weights @f$ \Sigma @f$
-                       rvec ŷ   ///< [out] @f$ \hat{y} @f$
-) {
+                       rvec ŷ,  ///< [out] @f$ \hat{y} @f$
+                       /// [in] Evaluate f(x) and g(x) in parallel (if
+                       ///      thread-safe)
+                       ThreadPool *pool = nullptr) {
+    // f(x) and g(x) in a single evaluation
+    if constexpr (has_fused_evaluations_v<ProblemT>)
+        if (p.ψ)
+            return p.ψ(x, y, Σ, p.D, ŷ);
     if (p.m == 0) /* [[unlikely]] */
         return p.f(x);
 
-    // g(x)
-    p.g(x, ŷ);
-    // ζ = g(x) + Σ⁻¹y
-    ŷ += Σ.asDiagonal().inverse() * y;
-    // d = ζ - Π(ζ, D)
-    ŷ = projecting_difference(ŷ, p.D);
-    // dᵀŷ, ŷ = Σ d
-    real_t dᵀŷ = 0;
-    for (unsigned i = 0; i < p.m; ++i) {
-        dᵀŷ += ŷ(i) * Σ(i) * ŷ(i); // TODO: vectorize
-        ŷ(i) = Σ(i) * ŷ(i);
-    }
+    auto ts = thread_safety(p);
+    real_t dᵀŷ, f;
+    invoke_concurrently(
+        ts.g && ts.f ? pool : nullptr,
+        [&] {
+            // g(x)
+            p.g(x, ŷ);
+            // ŷ = Σ (ζ - Π(ζ, D)) with ζ = g(x) + Σ⁻¹y
+            dᵀŷ = calc_ŷ_dᵀŷ(p, ŷ, y, Σ);
+        },
+        [&] { f = p.f(x); });
     // ψ(x) = f(x) + ½ dᵀŷ
-    real_t ψ = p.f(x) + 0.5 * dᵀŷ;
+    real_t ψ = f + 0.5 * dᵀŷ;
 
     return ψ;
 }
 
 /// Calculate ∇ψ(x) using ŷ.
-inline void calc_grad_ψ_from_ŷ(const Problem &p, ///< [in]  Problem description
+template <class ProblemT>
+inline void calc_grad_ψ_from_ŷ(const ProblemT &p, ///< [in]  Problem description
                                crvec x, ///< [in]  Decision variable @f$ x @f$
                                crvec ŷ, ///< [in]  @f$ \hat{y} @f$
                                rvec grad_ψ, ///< [out] @f$ \nabla \psi(x) @f$
-                               rvec work_n  ///<       Dimension n
-) {
+                               rvec work_n, ///<       Dimension n
+                               /// [in] Evaluate ∇f(x) and ∇g(x) ŷ in
+                               ///      parallel (if thread-safe)
+                               ThreadPool *pool = nullptr) {
     // ∇ψ = ∇f(x) + ∇g(x) ŷ
-    p.grad_f(x, grad_ψ);
-    if (p.m != 0) /* [[likely]] */ {
-        p.grad_g_prod(x, ŷ, work_n);
-        grad_ψ += work_n;
-    }
+    if (p.m == 0) /* [[unlikely]] */
+        return p.grad_f(x, grad_ψ);
+    if constexpr (has_fused_evaluations_v<ProblemT>)
+        if (p.grad_L)
+            return p.grad_L(x, ŷ, grad_ψ);
+    auto ts = thread_safety(p);
+    invoke_concurrently(
+        ts.grad_f && ts.grad_g_prod ? pool : nullptr,
+        [&] { p.grad_f(x, grad_ψ); }, [&] { p.grad_g_prod(x, ŷ, work_n); });
+    grad_ψ += work_n;
 }
 
 /// Calculate both ψ(x) and its gradient ∇ψ(x).
 /// @f[ \psi(x^k) = f(x^k) + \frac{1}{2}
 /// \text{dist}_\Sigma^2\left(g(x^k) + \Sigma^{-1}y,\;D\right) @f]
 /// @f[ \nabla \psi(x) = \nabla f(x) + \nabla g(x)\ \hat{y}(x) @f]
-inline real_t calc_ψ_grad_ψ(const Problem &p, ///< [in]  Problem description
+template <class ProblemT>
+inline real_t calc_ψ_grad_ψ(const ProblemT &p, ///< [in]  Problem description
                             crvec x, ///< [in]  Decision variable @f$ x @f$
                             crvec y, ///< [in]  Lagrange multipliers @f$ y @f$
                             crvec Σ, ///< [in]  Penalty weights @f$ \Sigma @f$
                             rvec grad_ψ, ///< [out] @f$ \nabla \psi(x) @f$
                             rvec work_n, ///<       Dimension n
-                            rvec work_m  ///<       Dimension m
-) {
+                            rvec work_m, ///<       Dimension m
+                            /// [in] Evaluate the cost and the constraints in
+                            ///      parallel (if thread-safe)
+                            ThreadPool *pool = nullptr) {
+    if constexpr (has_fused_evaluations_v<ProblemT>) {
+        // Everything in a single evaluation
+        if (p.ψ_grad_ψ)
+            return p.ψ_grad_ψ(x, y, Σ, p.D, grad_ψ, work_m);
+        // f(x) and ∇f(x) in a single evaluation
+        if (p.f_grad_f) {
+            if (p.m == 0) /* [[unlikely]] */
+                return p.f_grad_f(x, grad_ψ);
+            auto ts = thread_safety(p);
+            real_t f, dᵀŷ;
+            invoke_concurrently(
+                ts.f_grad_f && ts.g && ts.grad_g_prod ? pool : nullptr,
+                [&] { f = p.f_grad_f(x, grad_ψ); },
+                [&] {
+                    // g(x)
+                    p.g(x, work_m);
+                    // ŷ = Σ (ζ - Π(ζ, D)) with ζ = g(x) + Σ⁻¹y
+                    dᵀŷ = calc_ŷ_dᵀŷ(p, work_m, y, Σ);
+                    // ∇g(x) ŷ
+                    p.grad_g_prod(x, work_m, work_n);
+                });
+            // ∇ψ = ∇f(x) + ∇g(x) ŷ
+            grad_ψ += work_n;
+            // ψ(x) = f(x) + ½ dᵀŷ
+            return f + 0.5 * dᵀŷ;
+        }
+    }
     // ψ(x) = f(x) + ½ dᵀŷ
-    real_t ψ = calc_ψ_ŷ(p, x, y, Σ, work_m);
+    real_t ψ = calc_ψ_ŷ(p, x, y, Σ, work_m, pool);
     // ∇ψ = ∇f(x) + ∇g(x) ŷ
-    calc_grad_ψ_from_ŷ(p, x, work_m, grad_ψ, work_n);
+    calc_grad_ψ_from_ŷ(p, x, work_m, grad_ψ, work_n, pool);
     return ψ;
 }
 
 /// Calculate the gradient ∇ψ(x).
 /// @f[ \nabla \psi(x) = \nabla f(x) + \nabla g(x)\ \hat{y}(x) @f]
-inline void calc_grad_ψ(const Problem &p, ///< [in]  Problem description
-                        crvec x,          ///< [in]  Decision variable @f$ x @f$
+template <class ProblemT>
+inline void calc_grad_ψ(const ProblemT &p, ///< [in]  Problem description
+                        crvec x,           ///< [in]  Decision variable @f$ x @f$
                         crvec y,     ///< [in]  Lagrange multipliers @f$ y @f$
                         crvec Σ,     ///< [in]  Penalty weights @f$ \Sigma @f$
                         rvec grad_ψ, ///< [out] @f$ \nabla \psi(x) @f$
@@ -94,17 +219,16 @@ inline void calc_grad_ψ(const Problem &p, ///< [in]  Problem description
     // d = ζ - Π(ζ, D)
     work_m = projecting_difference(work_m, p.D);
     // ŷ = Σ d
-    work_m = Σ.asDiagonal() * work_m;
+    work_m.array() *= Σ.array();
 
     // ∇ψ = ∇f(x) + ∇g(x) ŷ
-    p.grad_f(x, grad_ψ);
-    p.grad_g_prod(x, work_m, work_n);
-    grad_ψ += work_n;
+    calc_grad_ψ_from_ŷ(p, x, work_m, grad_ψ, work_n);
 }
 
 /// Calculate the error between ẑ and g(x).
 /// @f[ \hat{z}^k = \Pi_D\left(g(x^k) + \Sigma^{-1}y\right) @f]
-inline void calc_err_z(const Problem &p, ///< [in]  Problem description
+template <class ProblemT>
+inline void calc_err_z(const ProblemT &p, ///< [in]  Problem description
                        crvec x̂,   ///< [in]  Decision variable @f$ \hat{x} @f$
                        crvec y,   ///< [in]  Lagrange multipliers @f$ y @f$
                        crvec Σ,   ///< [in]  Penalty weights @f$ \Sigma @f$
@@ -133,21 +257,39 @@ projected_gradient_step(const Box &C, ///< [in]  Set to project onto
                         crvec x,      ///< [in]  Decision variable @f$ x @f$
                         crvec grad_ψ  ///< [in]  @f$ \nabla \psi(x^k) @f$
 ) {
-    using binary_real_f = real_t (*)(real_t, real_t);
-    return (-γ * grad_ψ)
-        .binaryExpr(C.lowerbound - x, binary_real_f(std::fmax))
-        .binaryExpr(C.upperbound - x, binary_real_f(std::fmin));
+    return clamp(-γ * grad_ψ, C.lowerbound - x, C.upperbound - x);
 }
 
-inline void calc_x̂(const Problem &prob, ///< [in]  Problem description
-                   real_t γ,            ///< [in]  Step size
-                   crvec x,             ///< [in]  Decision variable @f$ x @f$
-                   crvec grad_ψ,        ///< [in]  @f$ \nabla \psi(x^k) @f$
+/// Compute the projected gradient step @f$ p^k @f$ and iterate
+/// @f$ \hat x^k @f$, together with @f$ \nabla\psi(x^k)^\top p^k @f$ and
+/// @f$ \|p^k\|^2 @f$, in a single pass over the vectors.
+/// The vectors are processed in blocks that fit in the L1 cache, and each
+/// block is used for all four results while it is still in cache, rather than
+/// streaming all vectors from memory again for each result. Within a block,
+/// the expressions are vectorized by Eigen.
+inline void calc_x̂(const Box &C,  ///< [in]  Box constraints @f$ C @f$
+                   real_t γ,      ///< [in]  Step size
+                   crvec x,       ///< [in]  Decision variable @f$ x @f$
+                   crvec grad_ψ,  ///< [in]  @f$ \nabla \psi(x^k) @f$
                    rvec x̂, ///< [out] @f$ \hat{x}^k = T_{\gamma^k}(x^k) @f$
-                   rvec p  ///< [out] @f$ \hat{x}^k - x^k @f$
+                   rvec p, ///< [out] @f$ \hat{x}^k - x^k @f$
+                   real_t &grad_ψᵀp, ///< [out] @f$ \nabla\psi(x^k)^\top p^k @f$
+                   real_t &pᵀp ///< [out] @f$ \left\| p^k \right\|^2 @f$
 ) {
-    p = projected_gradient_step(prob.C, γ, x, grad_ψ);
-    x̂ = x + p;
+    constexpr vec::Index block_size = 256;
+    const auto n                     = x.size();
+    grad_ψᵀp = pᵀp = 0;
+    for (vec::Index i = 0; i < n; i += block_size) {
+        auto b  = std::min(block_size, n - i);
+        auto xb = x.segment(i, b);
+        auto gb = grad_ψ.segment(i, b);
+        auto pb = p.segment(i, b);
+        pb      = clamp(-γ * gb, C.lowerbound.segment(i, b) - xb,
+                        C.upperbound.segment(i, b) - xb);
+        x̂.segment(i, b) = xb + pb;
+        grad_ψᵀp += gb.dot(pb);
+        pᵀp += pb.squaredNorm();
+    }
 }
 
 inline bool stop_crit_requires_grad_̂ψₖ(PANOCStopCrit crit) {
@@ -170,6 +312,7 @@ inline real_t calc_error_stop_crit(
     const Box &C,       ///< [in]  Box constraints on x
     PANOCStopCrit crit, ///< [in]  What stoppint criterion to use
     crvec pₖ,      ///< [in]  Projected gradient step @f$ \hat x^k - x^k @f$
+    real_t pₖᵀpₖ,  ///< [in]  @f$ \left\| p^k \right\|^2 @f$ (see @ref calc_x̂)
     real_t γ,      ///< [in]  Step size
     crvec xₖ,      ///< [in]  Current iterate
     crvec x̂ₖ,      ///< [in]  Current iterate after projected gradient step
@@ -194,7 +337,7 @@ inline real_t calc_error_stop_crit(
             return vec_util::norm_inf(pₖ);
         }
         case PANOCStopCrit::ProjGradNorm2: {
-            return pₖ.norm();
+            return std::sqrt(pₖᵀpₖ);
         }
         case PANOCStopCrit::ProjGradUnitNorm: {
             return vec_util::norm_inf(
@@ -207,7 +350,7 @@ inline real_t calc_error_stop_crit(
             return vec_util::norm_inf(pₖ) / γ;
         }
         case PANOCStopCrit::FPRNorm2: {
-            return pₖ.norm() / γ;
+            return std::sqrt(pₖᵀpₖ) / γ;
         }
         case PANOCStopCrit::Ipopt: {
             auto err =
@@ -239,9 +382,10 @@ inline real_t calc_error_stop_crit(
 /// multipliers.
 ///
 /// @return The original step size, before it was reduced by this function.
+template <class ProblemT>
 inline real_t descent_lemma(
     /// [in]  Problem description
-    const Problem &problem,
+    const ProblemT &problem,
     /// [in]    Tolerance used to ignore rounding errors when the function
     ///         @f$ \psi(x) @f$ is relatively flat or the step size is very
     ///         small, which could cause @f$ \psi(x^k) < \psi(\hat x^k) @f$,
@@ -277,7 +421,10 @@ inline real_t descent_lemma(
     /// [inout] Lipschitz constant estimate @f$ L_{\nabla\psi}^k @f$
     real_t &Lₖ,
     /// [inout] Step size @f$ \gamma^k @f$
-    real_t &γₖ) {
+    real_t &γₖ,
+    /// [in]    Evaluate f and g in parallel (if thread-safe), see
+    ///         @ref calc_ψ_ŷ
+    ThreadPool *pool = nullptr) {
 
     real_t old_γₖ = γₖ;
     real_t margin = (1 + std::abs(ψₖ)) * rounding_tolerance;
@@ -288,14 +435,12 @@ inline real_t descent_lemma(
         Lₖ *= 2;
         γₖ /= 2;
 
-        // Calculate x̂ₖ and pₖ (with new step size)
-        calc_x̂(problem, γₖ, xₖ, grad_ψₖ, /* in ⟹ out */ x̂ₖ, pₖ);
-        // Calculate ∇ψ(xₖ)ᵀpₖ and ‖pₖ‖²
-        grad_ψₖᵀpₖ = grad_ψₖ.dot(pₖ);
-        norm_sq_pₖ = pₖ.squaredNorm();
+        // Calculate x̂ₖ and pₖ (with new step size), ∇ψ(xₖ)ᵀpₖ and ‖pₖ‖²
+        calc_x̂(problem.C, γₖ, xₖ, grad_ψₖ, /* in ⟹ out */ x̂ₖ, pₖ, grad_ψₖᵀpₖ,
+               norm_sq_pₖ);
 
         // Calculate ψ(x̂ₖ) and ŷ(x̂ₖ)
-        ψx̂ₖ = calc_ψ_ŷ(problem, x̂ₖ, y, Σ, /* in ⟹ out */ ŷx̂ₖ);
+        ψx̂ₖ = calc_ψ_ŷ(problem, x̂ₖ, y, Σ, /* in ⟹ out */ ŷx̂ₖ, pool);
     }
     return old_γₖ;
 }
@@ -339,9 +484,10 @@ inline SolverStatus check_all_stop_conditions(
 /// @f[ \nabla^2_{xx} L_\Sigma(x, y) =
 ///     \Big. \nabla_{xx}^2 L(x, y) \Big|_{\big(x,\, \hat y(x, y)\big)}
 ///   + \sum_{i\in\mathcal{I}} \Sigma_i\,\nabla g_i(x) \nabla g_i(x)^\top @f]
+template <class ProblemT>
 inline void calc_augmented_lagrangian_hessian(
     /// [in]  Problem description
-    const Problem &problem,
+    const ProblemT &problem,
     /// [in]    Current iterate @f$ x^k @f$
     crvec xₖ,
     /// [in]   Intermediate vector @f$ \hat y(x^k) @f$
@@ -367,7 +513,180 @@ inline void calc_augmented_lagrangian_hessian(
             problem.D.lowerbound(i) < ζ && ζ < problem.D.upperbound(i);
         if (not inactive) {
             problem.grad_gi(xₖ, i, work_n);
-            H += work_n * Σ(i) * work_n.transpose();
+            // Scaling the right factor avoids a temporary for the outer
+            // product
+            H.noalias() += work_n * (Σ(i) * work_n.transpose());
+        }
+    }
+}
+
+/// Compute the Hessian matrix of the augmented Lagrangian function, using the
+/// sparse constraint Jacobian @ref Problem::jac_g if the problem provides it.
+/// This requires a single Jacobian evaluation and a sparse rank-one update
+/// per active constraint, rather than an evaluation of @ref Problem::grad_gi
+/// and a dense rank-one update per active constraint.
+/// @f[ \nabla^2_{xx} L_\Sigma(x, y) =
+///     \Big. \nabla_{xx}^2 L(x, y) \Big|_{\big(x,\, \hat y(x, y)\big)}
+///   + J_{\mathcal{I}}^\top\, \Sigma_{\mathcal{I}}\, J_{\mathcal{I}} @f]
+template <class ProblemT>
+inline void calc_augmented_lagrangian_hessian(
+    /// [in]  Problem description
+    const ProblemT &problem,
+    /// [in]    Current iterate @f$ x^k @f$
+    crvec xₖ,
+    /// [in]   Intermediate vector @f$ \hat y(x^k) @f$
+    crvec ŷxₖ,
+    /// [in]    Lagrange multipliers @f$ y @f$
+    crvec y,
+    /// [in]    Penalty weights @f$ \Sigma @f$
+    crvec Σ,
+    /// [out]   The constraint values @f$ g(x^k) @f$
+    rvec g,
+    /// [out]   Hessian matrix @f$ H(x, y) @f$
+    mat &H,
+    ///         Dimension n
+    rvec work_n,
+    ///         Storage for the sparse Jacobian @f$ J = \nabla g(x^k)^\top @f$
+    SparseJacobian &jac) {
+
+    if constexpr (std::is_base_of_v<Problem, ProblemT>) {
+        if (problem.jac_g) {
+            // Compute the Hessian of the Lagrangian
+            problem.hess_L(xₖ, ŷxₖ, H);
+            // Compute the Hessian of the augmented Lagrangian
+            problem.g(xₖ, g);
+            bool jac_evaluated = false;
+            for (vec::Index i = 0; i < problem.m; ++i) {
+                real_t ζ = g(i) + y(i) / Σ(i);
+                bool inactive =
+                    problem.D.lowerbound(i) < ζ && ζ < problem.D.upperbound(i);
+                if (inactive)
+                    continue;
+                if (not jac_evaluated) {
+                    jac.set_pattern(problem.jac_g_sparsity);
+                    problem.jac_g(xₖ, jac.nonzeros);
+                    jac.update();
+                    jac_evaluated = true;
+                }
+                // H += ∇gᵢ Σᵢ ∇gᵢᵀ, only the nonzeros of row i of J
+                using It = SparseJacobian::matrix_t::InnerIterator;
+                const auto &J = jac.matrix();
+                for (It c(J, i); c; ++c) {
+                    real_t Σ_Jic = Σ(i) * c.value();
+                    for (It r(J, i); r; ++r)
+                        H(r.col(), c.col()) += r.value() * Σ_Jic;
+                }
+            }
+            return;
+        }
+    }
+    calc_augmented_lagrangian_hessian(problem, xₖ, ŷxₖ, y, Σ, g, H, work_n);
+}
+
+/// Compute the upper triangle of the sparse Hessian matrix of the augmented
+/// Lagrangian function, using @ref Problem::hess_L_sparse and the sparse
+/// constraint Jacobian @ref Problem::jac_g (which is required if
+/// @f$ m > 0 @f$). The pattern of @p H must have been set already.
+/// @f[ \nabla^2_{xx} L_\Sigma(x, y) =
+///     \Big. \nabla_{xx}^2 L(x, y) \Big|_{\big(x,\, \hat y(x, y)\big)}
+///   + J_{\mathcal{I}}^\top\, \Sigma_{\mathcal{I}}\, J_{\mathcal{I}} @f]
+inline void calc_augmented_lagrangian_hessian(
+    /// [in]  Problem description
+    const Problem &problem,
+    /// [in]    Current iterate @f$ x^k @f$
+    crvec xₖ,
+    /// [in]   Intermediate vector @f$ \hat y(x^k) @f$
+    crvec ŷxₖ,
+    /// [in]    Lagrange multipliers @f$ y @f$
+    crvec y,
+    /// [in]    Penalty weights @f$ \Sigma @f$
+    crvec Σ,
+    /// [out]   The constraint values @f$ g(x^k) @f$
+    rvec g,
+    /// [out]   Sparse Hessian matrix @f$ H(x, y) @f$
+    SparseHessian &H,
+    ///         Storage for the sparse Jacobian @f$ J = \nabla g(x^k)^\top @f$
+    SparseJacobian &jac) {
+
+    // Compute the Hessian of the Lagrangian
+    problem.hess_L_sparse(xₖ, ŷxₖ, H.nonzeros);
+    H.update();
+    // Compute the Hessian of the augmented Lagrangian
+    problem.g(xₖ, g);
+    bool jac_evaluated = false;
+    for (vec::Index i = 0; i < problem.m; ++i) {
+        real_t ζ = g(i) + y(i) / Σ(i);
+        bool inactive =
+            problem.D.lowerbound(i) < ζ && ζ < problem.D.upperbound(i);
+        if (inactive)
+            continue;
+        if (not jac_evaluated) {
+            jac.set_pattern(problem.jac_g_sparsity);
+            problem.jac_g(xₖ, jac.nonzeros);
+            jac.update();
+            jac_evaluated = true;
+        }
+        H.add_rank_one(jac.matrix(), i, Σ(i));
+    }
+}
+
+/// Compute the Hessian matrix of the augmented Lagrangian function multiplied
+/// by the given vector, using @ref Problem::hess_ψ_prod if the problem
+/// provides it, or using @ref Problem::hess_L_prod and the constraint
+/// Jacobian otherwise. The sparse Jacobian is used if @p jac is not null,
+/// otherwise, @ref Problem::grad_gi is evaluated for each active constraint.
+/// @f[ \nabla^2_{xx} L_\Sigma(x, y)\, v =
+///     \Big. \nabla_{xx}^2 L(x, y) \Big|_{\big(x,\, \hat y(x, y)\big)} v
+///   + J_{\mathcal{I}}^\top\, \Sigma_{\mathcal{I}}\, J_{\mathcal{I}}\, v @f]
+template <class ProblemT>
+inline void calc_augmented_lagrangian_hessian_prod(
+    /// [in]    Problem description
+    const ProblemT &problem,
+    /// [in]    Current iterate @f$ x^k @f$
+    crvec xₖ,
+    /// [in]    Intermediate vector @f$ \hat y(x^k) @f$
+    crvec ŷxₖ,
+    /// [in]    Lagrange multipliers @f$ y @f$
+    crvec y,
+    /// [in]    Penalty weights @f$ \Sigma @f$
+    crvec Σ,
+    /// [in]    The constraint values @f$ g(x^k) @f$
+    crvec g,
+    /// [in]    Vector to multiply with the Hessian
+    crvec v,
+    /// [out]   Hessian-vector product
+    rvec Hv,
+    ///         Dimension n
+    rvec work_n,
+    /// [in]    Sparse Jacobian @f$ J = \nabla g(x^k)^\top @f$ (optional)
+    const SparseJacobian *jac) {
+
+    if constexpr (has_fused_evaluations_v<ProblemT>) {
+        if (problem.hess_ψ_prod) {
+            problem.hess_ψ_prod(xₖ, y, Σ, problem.D, v, Hv);
+            return;
+        }
+    }
+    problem.hess_L_prod(xₖ, ŷxₖ, v, Hv);
+    for (vec::Index i = 0; i < problem.m; ++i) {
+        real_t ζ = g(i) + y(i) / Σ(i);
+        bool inactive =
+            problem.D.lowerbound(i) < ζ && ζ < problem.D.upperbound(i);
+        if (inactive)
+            continue;
+        // Hv += ∇gᵢ Σᵢ ∇gᵢᵀ v
+        if (jac) {
+            using It      = SparseJacobian::matrix_t::InnerIterator;
+            const auto &J = jac->matrix();
+            real_t Σ_Jiv  = 0;
+            for (It c(J, i); c; ++c)
+                Σ_Jiv += c.value() * v(c.col());
+            Σ_Jiv *= Σ(i);
+            for (It c(J, i); c; ++c)
+                Hv(c.col()) += c.value() * Σ_Jiv;
+        } else {
+            problem.grad_gi(xₖ, i, work_n);
+            Hv += work_n * (Σ(i) * work_n.dot(v));
         }
     }
 }
@@ -376,9 +695,10 @@ inline void calc_augmented_lagrangian_hessian(
 /// by the given vector, using finite differences.
 /// @f[ \nabla^2_{xx} L_\Sigma(x, y)\, v \approx
 ///     \frac{\nabla_x L_\Sigma(x+hv, y) - \nabla_x L_\Sigma(x, y)}{h} @f]
+template <class ProblemT>
 inline void calc_augmented_lagrangian_hessian_prod_fd(
     /// [in]    Problem description
-    const Problem &problem,
+    const ProblemT &problem,
     /// [in]    Current iterate @f$ x^k @f$
     crvec xₖ,
     /// [in]    Lagrange multipliers @f$ y @f$
@@ -409,9 +729,10 @@ inline void calc_augmented_lagrangian_hessian_prod_fd(
 
 /// Estimate the Lipschitz constant of the gradient @f$ \nabla \psi @f$ using
 /// finite differences.
+template <class ProblemT>
 inline real_t initial_lipschitz_estimate(
     /// [in]    Problem description
-    const Problem &problem,
+    const ProblemT &problem,
     /// [in]    Current iterate @f$ x^k @f$
     crvec xₖ,
     /// [in]    Lagrange multipliers @f$ y @f$
@@ -456,9 +777,10 @@ inline real_t initial_lipschitz_estimate(
 
 /// Estimate the Lipschitz constant of the gradient @f$ \nabla \psi @f$ using
 /// finite differences.
+template <class ProblemT>
 inline real_t initial_lipschitz_estimate(
     /// [in]    Problem description
-    const Problem &problem,
+    const ProblemT &problem,
     /// [in]    Current iterate @f$ x^k @f$
     crvec xₖ,
     /// [in]    Lagrange multipliers @f$ y @f$
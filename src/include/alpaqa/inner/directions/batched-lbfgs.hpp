@@ -0,0 +1,157 @@
+#pragma once
+
+#include <alpaqa/inner/directions/decl/batched-lbfgs.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace alpaqa {
+
+inline unsigned BatchedLBFGS::update(crmat xₖ, crmat xₖ₊₁, crmat pₖ,
+                                     crmat pₖ₊₁, const lane_mask &mask) {
+    // Smallest number we want to divide by without overflow
+    const real_t min_divisor = std::sqrt(std::numeric_limits<real_t>::min());
+    const auto B = xₖ.rows();
+
+    s_new = xₖ₊₁ - xₖ;
+    y_new = pₖ - pₖ₊₁;
+
+    // Check which updates are accepted (see LBFGS::update_valid)
+    work_B1   = batch_util::rowwise_dot(y_new, s_new);
+    work_B2   = s_new.rowwise().squaredNorm();
+    auto yᵀs  = work_B1.array();
+    auto sᵀs  = work_B2.array();
+    auto &acc = work_mask;
+    acc = mask && yᵀs.isFinite() && yᵀs >= min_divisor && sᵀs >= min_divisor;
+    // CBFGS condition: yᵀs / sᵀs >= ϵ ‖p‖^α
+    if (params.cbfgs.ϵ > 0) {
+        auto pᵀp = pₖ₊₁.rowwise().squaredNorm().array();
+        acc = acc && yᵀs / sᵀs >= params.cbfgs.ϵ * pᵀp.pow(params.cbfgs.α / 2);
+    }
+    const auto num_acc      = acc.count();
+    const auto num_rejected = mask.count() - num_acc;
+    if (num_acc == 0)
+        return static_cast<unsigned>(num_rejected);
+
+    // Store the new s and y vectors of the accepted instances in the oldest
+    // slot
+    batch_util::select_rows(acc, s_new, s[idx]);
+    batch_util::select_rows(acc, y_new, y[idx]);
+    ρ.col(idx) = acc.select(yᵀs.inverse(), ρ.col(idx).array()).matrix();
+
+    // If most instances accepted the update, increment the index in the
+    // circular buffer, and rotate the pairs of the other instances so their
+    // oldest pair stays in the slot after the newest one. Otherwise, rotate
+    // the new pairs of the instances that accepted the update to the newest
+    // slot, and keep the index.
+    bool advance = 2 * num_acc >= B;
+    if (advance)
+        idx = succ(idx);
+    for (Eigen::Index b = 0; b < B; ++b)
+        if (acc(b) != advance)
+            rotate(b, advance);
+    return static_cast<unsigned>(num_rejected);
+}
+
+inline void BatchedLBFGS::rotate(Eigen::Index b, bool forward) {
+    const size_t last = history() - 1;
+    for (auto *v : {&s, &y}) {
+        auto &sy = *v;
+        if (forward) {
+            work_n = sy[last].row(b).transpose();
+            for (size_t i = last; i > 0; --i)
+                sy[i].row(b) = sy[i - 1].row(b);
+            sy[0].row(b) = work_n.transpose();
+        } else {
+            work_n = sy[0].row(b).transpose();
+            for (size_t i = 0; i < last; ++i)
+                sy[i].row(b) = sy[i + 1].row(b);
+            sy[last].row(b) = work_n.transpose();
+        }
+    }
+    auto ρ_b = ρ.row(b);
+    if (forward)
+        std::rotate(ρ_b.begin(), ρ_b.begin() + last, ρ_b.end());
+    else
+        std::rotate(ρ_b.begin(), ρ_b.begin() + 1, ρ_b.end());
+}
+
+inline void BatchedLBFGS::apply(rmat q, real_t γ) {
+    if (history() == 0)
+        return;
+    auto prev = [this](size_t i) { return i > 0 ? i - 1 : history() - 1; };
+
+    // From the newest to the oldest pair
+    for (size_t k = 0, i = idx; k < history(); ++k) {
+        i          = prev(i);
+        α.col(i)   = ρ.col(i).cwiseProduct(batch_util::rowwise_dot(s[i], q));
+        q         -= α.col(i).asDiagonal() * y[i];
+    }
+
+    // r ← H₀ q
+    if (γ > 0) {
+        q *= γ;
+    } else {
+        // Step size sᵀy/yᵀy based on the most recent accepted pair of each
+        // instance, or one if there is none
+        work_B1.setZero();
+        for (size_t k = 0, i = idx; k < history(); ++k) {
+            i                = prev(i);
+            auto yᵀy     = y[i].rowwise().squaredNorm().array();
+            auto &newest = work_mask;
+            newest       = work_B1.array() == 0 && ρ.col(i).array() > 0;
+            work_B1 = newest.select((ρ.col(i).array() * yᵀy).inverse(),
+                                    work_B1.array())
+                          .matrix();
+        }
+        work_B1 = (work_B1.array() == 0).select(1, work_B1.array()).matrix();
+        q       = work_B1.asDiagonal() * q;
+    }
+
+    // From the oldest to the newest pair
+    for (size_t k = 0, i = idx; k < history(); ++k, i = succ(i)) {
+        work_B2 = ρ.col(i).cwiseProduct(batch_util::rowwise_dot(y[i], q));
+        q      += (α.col(i) - work_B2).asDiagonal() * s[i];
+    }
+}
+
+inline void BatchedLBFGS::reset(const lane_mask &mask) {
+    const auto B = ρ.rows();
+    for (size_t i = 0; i < history(); ++i) {
+        batch_util::select_rows(mask, mat::Zero(B, s[i].cols()), s[i]);
+        batch_util::select_rows(mask, mat::Zero(B, y[i].cols()), y[i]);
+    }
+    batch_util::select_rows(mask, mat::Zero(B, ρ.cols()), ρ);
+}
+
+inline void BatchedLBFGS::reset() {
+    for (auto *v : {&s, &y})
+        for (auto &m : *v)
+            m.setZero();
+    ρ.setZero();
+    idx = 0;
+}
+
+inline void BatchedLBFGS::resize(Eigen::Index B, Eigen::Index n) {
+    s.assign(params.memory, mat::Zero(B, n));
+    y.assign(params.memory, mat::Zero(B, n));
+    ρ = mat::Zero(B, params.memory);
+    α = mat::Zero(B, params.memory);
+    s_new.resize(B, n);
+    y_new.resize(B, n);
+    work_B1.resize(B);
+    work_B2.resize(B);
+    work_n.resize(n);
+    work_mask.resize(B);
+    idx = 0;
+}
+
+inline void BatchedLBFGS::scale_y(crvec factors) {
+    for (size_t i = 0; i < history(); ++i) {
+        y[i]     = factors.asDiagonal() * y[i];
+        ρ.col(i) = ρ.col(i).cwiseQuotient(factors);
+    }
+}
+
+} // namespace alpaqa
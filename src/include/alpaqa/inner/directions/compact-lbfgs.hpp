@@ -0,0 +1,166 @@
+#pragma once
+
+#include <alpaqa/inner/directions/decl/compact-lbfgs.hpp>
+#include <alpaqa/inner/directions/lbfgs.hpp>
+
+#include <stdexcept>
+
+namespace alpaqa {
+
+inline bool CompactLBFGS::update(crvec xₖ, crvec xₖ₊₁, crvec pₖ, crvec pₖ₊₁,
+                                 Sign sign, bool forced) {
+    const auto s = xₖ₊₁ - xₖ;
+    const auto y = sign == Sign::Positive ? pₖ₊₁ - pₖ : pₖ - pₖ₊₁;
+    if (not forced) {
+        real_t yᵀs = y.dot(s);
+        real_t sᵀs = s.squaredNorm();
+        real_t pᵀp = params.cbfgs.ϵ > 0 ? pₖ₊₁.squaredNorm() : 0;
+        if (not LBFGS::update_valid(params, yᵀs, sᵀs, pᵀp))
+            return false;
+    }
+
+    // Store the new s and y vectors
+    this->s(idx) = s;
+    this->y(idx) = y;
+
+    // Update the inner products with the new vectors, only the first h columns
+    // of the buffer are in use
+    auto h  = static_cast<Eigen::Index>(full ? history() : idx + 1);
+    auto Sₕ = S().leftCols(h);
+    auto Yₕ = Y().leftCols(h);
+    auto i  = static_cast<Eigen::Index>(idx);
+    SᵀY.col(i).topRows(h).noalias() = Sₕ.transpose() * this->y(idx);
+    SᵀY.row(i).leftCols(h).noalias() = this->s(idx).transpose() * Yₕ;
+    YᵀY.col(i).topRows(h).noalias() = Yₕ.transpose() * this->y(idx);
+    YᵀY.row(i).leftCols(h) = YᵀY.col(i).topRows(h).transpose();
+
+    // Increment the index in the circular buffer
+    idx = succ(idx);
+    full |= idx == 0;
+
+    return true;
+}
+
+inline bool CompactLBFGS::apply(rvec q, real_t γ) {
+    // Only apply if we have previous vectors s and y
+    if (idx == 0 && not full)
+        return false;
+    auto h  = static_cast<Eigen::Index>(current_history());
+    auto Sₕ = S().leftCols(h);
+    auto Yₕ = Y().leftCols(h);
+
+    // If the step size is negative, compute it as sᵀy/yᵀy
+    if (γ < 0) {
+        auto i = static_cast<Eigen::Index>(pred(idx));
+        γ      = SᵀY(i, i) / YᵀY(i, i);
+    }
+
+    // Products with the tall matrices Sᵀ and Yᵀ
+    auto Sᵀqₕ = Sᵀq.topRows(h), Yᵀqₕ = Yᵀq.topRows(h);
+    Sᵀqₕ.noalias() = Sₕ.transpose() * q;
+    Yᵀqₕ.noalias() = Yₕ.transpose() * q;
+
+    // Small matrices R and D + γYᵀY, and the vectors Sᵀq and Yᵀq in
+    // chronological order
+    auto Rₕ = R.topLeftCorner(h, h), Mₕ = M.topLeftCorner(h, h);
+    auto uₕ = u.topRows(h), wₕ = w.topRows(h);
+    for (Eigen::Index c = 0; c < h; ++c) {
+        auto bc = static_cast<Eigen::Index>(chronological(c));
+        for (Eigen::Index r = 0; r <= c; ++r) {
+            auto br  = static_cast<Eigen::Index>(chronological(r));
+            Rₕ(r, c) = SᵀY(br, bc);
+            Mₕ(r, c) = γ * YᵀY(br, bc);
+        }
+        Mₕ(c, c) += SᵀY(bc, bc);
+        uₕ(c) = Sᵀqₕ(bc);
+        wₕ(c) = Yᵀqₕ(bc);
+    }
+
+    // u = R⁻¹ Sᵀq
+    Rₕ.triangularView<Eigen::Upper>().solveInPlace(uₕ);
+    // w = R⁻ᵀ ((D + γYᵀY) u - γ Yᵀq)
+    wₕ = Mₕ.selfadjointView<Eigen::Upper>() * uₕ - γ * wₕ;
+    Rₕ.triangularView<Eigen::Upper>().transpose().solveInPlace(wₕ);
+
+    // Hq = γq + S w - γ Y u, back in the order of the buffer
+    for (Eigen::Index c = 0; c < h; ++c) {
+        auto bc  = static_cast<Eigen::Index>(chronological(c));
+        Sᵀqₕ(bc) = wₕ(c);
+        Yᵀqₕ(bc) = -γ * uₕ(c);
+    }
+    q *= γ;
+    q.noalias() += Sₕ * Sᵀqₕ;
+    q.noalias() += Yₕ * Yᵀqₕ;
+
+    return true;
+}
+
+inline void CompactLBFGS::reset() {
+    idx  = 0;
+    full = false;
+}
+
+inline void CompactLBFGS::resize(size_t n) {
+    if (params.memory < 1)
+        throw std::invalid_argument("LBFGSParams::memory must be > 1");
+    auto m = static_cast<Eigen::Index>(params.memory);
+    sto.resize(n, 2 * m);
+    for (mat *A : {&SᵀY, &YᵀY, &R, &M})
+        A->resize(m, m);
+    for (vec *v : {&Sᵀq, &Yᵀq, &u, &w})
+        v->resize(m);
+    reset();
+}
+
+inline void CompactLBFGS::scale_y(real_t factor) {
+    auto h = static_cast<Eigen::Index>(current_history());
+    Y().leftCols(h) *= factor;
+    SᵀY.topLeftCorner(h, h) *= factor;
+    YᵀY.topLeftCorner(h, h) *= factor * factor;
+}
+
+inline void PANOCDirection<CompactLBFGS>::initialize(crvec x₀, crvec x̂₀,
+                                                     crvec p₀, crvec grad₀) {
+    lbfgs.resize(x₀.size());
+    (void)x̂₀;
+    (void)p₀;
+    (void)grad₀;
+}
+
+inline bool PANOCDirection<CompactLBFGS>::update(crvec xₖ, crvec xₖ₊₁,
+                                                 crvec pₖ, crvec pₖ₊₁,
+                                                 crvec grad_new, const Box &C,
+                                                 real_t γ_new) {
+    (void)grad_new;
+    (void)C;
+    (void)γ_new;
+    return lbfgs.update(xₖ, xₖ₊₁, pₖ, pₖ₊₁, CompactLBFGS::Sign::Negative);
+}
+
+inline bool PANOCDirection<CompactLBFGS>::apply(crvec xₖ, crvec x̂ₖ, crvec pₖ,
+                                                real_t γ, rvec qₖ) {
+    (void)xₖ;
+    (void)x̂ₖ;
+    qₖ = pₖ;
+    return lbfgs.apply(qₖ, γ);
+}
+
+inline void PANOCDirection<CompactLBFGS>::changed_γ(real_t γₖ,
+                                                    real_t old_γₖ) {
+    if (lbfgs.get_params().rescale_when_γ_changes)
+        lbfgs.scale_y(γₖ / old_γₖ);
+    else
+        lbfgs.reset();
+}
+
+inline void PANOCDirection<CompactLBFGS>::reset() { lbfgs.reset(); }
+
+inline std::string PANOCDirection<CompactLBFGS>::get_name() const {
+    return lbfgs.get_name();
+}
+
+inline LBFGSParams PANOCDirection<CompactLBFGS>::get_params() const {
+    return lbfgs.get_params();
+}
+
+} // namespace alpaqa
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <alpaqa/inner/directions/decl/lbfgs.hpp>
+#include <alpaqa/util/batched-problem.hpp>
+
+#include <string>
+#include <vector>
+
+namespace alpaqa {
+
+/// L-BFGS for a batch of independent problems, stored in structure-of-arrays
+/// form (one row per instance, see @ref BatchedProblem).
+///
+/// All instances share the same index into the circular buffer, so the
+/// two-loop recursion processes the same slot of all instances at once and
+/// is vectorized across the instances. When only some of the instances accept
+/// an update, the pairs of the others are rotated by one slot, so that each
+/// instance keeps its own pairs in the right order, exactly like @ref LBFGS.
+/// Slots that don't contain a pair (yet) have ρ = 0, they are skipped by the
+/// recursion.
+/// @ingroup  grp_PANOCDirectionProviders
+class BatchedLBFGS {
+  public:
+    using Params = LBFGSParams;
+
+    BatchedLBFGS(Params params) : params(params) {}
+    BatchedLBFGS(Params params, Eigen::Index B, Eigen::Index n)
+        : params(params) {
+        resize(B, n);
+    }
+
+    /// Update the inverse Hessian approximations of the instances selected by
+    /// @p mask using the new vectors xₖ₊₁ and pₖ₊₁, with
+    /// @f$ p \sim -\nabla \psi(x) @f$. The other instances are not changed.
+    /// @returns The number of instances for which the update was rejected.
+    unsigned update(crmat xₖ, crmat xₖ₊₁, crmat pₖ, crmat pₖ₊₁,
+                    const lane_mask &mask);
+
+    /// Apply the inverse Hessian approximations to the rows of @p q.
+    /// The initial approximation @f$ H_0 @f$ is @f$ \gamma I @f$ if @p γ is
+    /// positive, otherwise it is based on the curvature
+    /// @f$ s^\top y / y^\top y @f$ of the most recent pair of each instance.
+    /// For instances without any accepted pairs, this is @f$ H_0 @f$ only
+    /// (the identity if @p γ is not positive).
+    void apply(rmat q, real_t γ);
+
+    /// Throw away the approximations of the instances selected by @p mask.
+    void reset(const lane_mask &mask);
+    /// Throw away the approximations of all instances.
+    void reset();
+    /// Re-allocate storage for a batch of a different size. Causes a
+    /// @ref reset.
+    void resize(Eigen::Index B, Eigen::Index n);
+
+    /// Scale the stored y vectors of each instance by the given factors.
+    void scale_y(crvec factors);
+
+    std::string get_name() const { return "BatchedLBFGS"; }
+
+    const Params &get_params() const { return params; }
+
+    /// Get the number of instances in the batch.
+    Eigen::Index batch_size() const { return ρ.rows(); }
+    /// Get the size of the s and y vectors of each instance.
+    Eigen::Index n() const { return s.empty() ? 0 : s.front().cols(); }
+    /// Get the number of previous vectors s and y stored in the buffer.
+    size_t history() const { return s.size(); }
+    /// Get the next index in the circular buffer of previous s and y vectors.
+    size_t succ(size_t i) const { return i + 1 < history() ? i + 1 : 0; }
+
+  private:
+    /// Move the pairs of instance @p b one slot forward (from slot i to slot
+    /// i + 1) or backward in the circular buffer.
+    void rotate(Eigen::Index b, bool forward);
+
+  private:
+    /// Vectors s and y of all instances (B × n each).
+    std::vector<mat> s, y;
+    /// Scalars ρ and α of all instances (B × history). Zero ρ marks an empty
+    /// slot.
+    mat ρ, α;
+    /// New vectors s and y of all instances, before they are accepted.
+    mat s_new, y_new;
+    /// Work vectors of dimension B.
+    vec work_B1, work_B2;
+    /// Work vector of dimension n.
+    vec work_n;
+    /// Work mask of dimension B.
+    lane_mask work_mask;
+    size_t idx = 0;
+    Params params;
+};
+
+} // namespace alpaqa
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <alpaqa/util/box.hpp>
+#include <alpaqa/util/vec.hpp>
+
+#include <alpaqa/inner/directions/decl/lbfgs.hpp>
+#include <alpaqa/inner/directions/decl/panoc-direction-update.hpp>
+
+namespace alpaqa {
+
+/// Limited memory Broyden–Fletcher–Goldfarb–Shanno (L-BFGS) algorithm using
+/// the compact representation of Byrd, Nocedal and Schnabel:
+/// @f[ H = \gamma I + \begin{pmatrix} S & \gamma Y \end{pmatrix}
+/// \begin{pmatrix} R^{-\top} (D + \gamma Y^\top Y) R^{-1} & -R^{-\top}
+/// \\ -R^{-1} & 0 \end{pmatrix}
+/// \begin{pmatrix} S^\top \\ \gamma Y^\top \end{pmatrix}, @f]
+/// where @f$ R @f$ and @f$ D @f$ are the upper triangular and diagonal parts
+/// of @f$ S^\top Y @f$.
+/// The small matrices @f$ S^\top Y @f$ and @f$ Y^\top Y @f$ are updated
+/// incrementally, so applying the inverse Hessian approximation only requires
+/// two products with the tall matrices @f$ S^\top @f$ and @f$ Y^\top @f$, and
+/// two with @f$ S @f$ and @f$ Y @f$, rather than the @f$ 2m @f$ sequential
+/// dot products and vector updates of the two-loop recursion in @ref LBFGS.
+/// This is advantageous for large memory sizes.
+/// @see https://doi.org/10.1007/BF01582063
+/// @ingroup  grp_PANOCDirectionProviders
+class CompactLBFGS {
+  public:
+    using Params = LBFGSParams;
+    using Sign   = LBFGS::Sign;
+
+    CompactLBFGS(Params params) : params(params) {}
+    CompactLBFGS(Params params, size_t n) : params(params) { resize(n); }
+
+    /// Update the inverse Hessian approximation using the new vectors xₖ₊₁
+    /// and pₖ₊₁.
+    bool update(crvec xₖ, crvec xₖ₊₁, crvec pₖ, crvec pₖ₊₁,
+                Sign sign, bool forced = false);
+
+    /// Apply the inverse Hessian approximation to the given vector q.
+    bool apply(rvec q, real_t γ);
+
+    /// Throw away the approximation and all previous vectors s and y.
+    void reset();
+    /// Re-allocate storage for a problem with a different size. Causes
+    /// a @ref reset.
+    void resize(size_t n);
+
+    /// Scale the stored y vectors by the given factor.
+    void scale_y(real_t factor);
+
+    std::string get_name() const { return "CompactLBFGS"; }
+
+    const Params &get_params() const { return params; }
+
+    /// Get the size of the s and y vectors in the buffer.
+    size_t n() const { return sto.rows(); }
+    /// Get the number of previous vectors s and y stored in the buffer.
+    size_t history() const { return sto.cols() / 2; }
+    /// Get the number of previous vectors s and y that are currently in use.
+    size_t current_history() const { return full ? history() : idx; }
+    /// Get the next index in the circular buffer of previous s and y vectors.
+    size_t succ(size_t i) const { return i + 1 < history() ? i + 1 : 0; }
+    /// Get the previous index in the circular buffer of previous s and y
+    /// vectors.
+    size_t pred(size_t i) const { return i == 0 ? history() - 1 : i - 1; }
+
+    /// All vectors s, stored as the columns of a matrix (in the order of the
+    /// circular buffer).
+    auto S() { return sto.leftCols(history()); }
+    auto S() const { return sto.leftCols(history()); }
+    /// All vectors y, stored as the columns of a matrix (in the order of the
+    /// circular buffer).
+    auto Y() { return sto.rightCols(history()); }
+    auto Y() const { return sto.rightCols(history()); }
+    auto s(size_t i) { return S().col(i); }
+    auto s(size_t i) const { return S().col(i); }
+    auto y(size_t i) { return Y().col(i); }
+    auto y(size_t i) const { return Y().col(i); }
+
+  private:
+    /// Index of the i-th oldest pair (s, y) in the circular buffer.
+    size_t chronological(size_t i) const {
+        return full ? (idx + i) % history() : i;
+    }
+
+  private:
+    mat sto;            ///< Vectors s and y, as [S Y]
+    mat SᵀY;            ///< Inner products sᵢᵀyⱼ (in the order of the buffer)
+    mat YᵀY;            ///< Inner products yᵢᵀyⱼ (in the order of the buffer)
+    mat R, M;           ///< Work matrices for R and D + γYᵀY (chronological)
+    vec Sᵀq, Yᵀq, u, w; ///< Work vectors of dimension history()
+    size_t idx = 0;
+    bool full  = false;
+    Params params;
+};
+
+template <>
+struct PANOCDirection<CompactLBFGS> {
+    CompactLBFGS lbfgs;
+    PANOCDirection(const LBFGSParams &params) : lbfgs(params) {}
+    PANOCDirection(const CompactLBFGS &lbfgs) : lbfgs(lbfgs) {}
+    PANOCDirection(CompactLBFGS &&lbfgs) : lbfgs(std::move(lbfgs)) {}
+
+    void initialize(crvec x₀, crvec x̂₀, crvec p₀, crvec grad₀);
+    bool update(crvec xₖ, crvec xₖ₊₁, crvec pₖ, crvec pₖ₊₁, crvec grad_new,
+                const Box &C, real_t γ_new);
+    bool apply(crvec xₖ, crvec x̂ₖ, crvec pₖ, real_t γ, rvec qₖ);
+    void changed_γ(real_t γₖ, real_t old_γₖ);
+    void reset();
+    std::string get_name() const;
+    LBFGSParams get_params() const;
+};
+
+} // namespace alpaqa
@@ -6,8 +6,23 @@
 #include <alpaqa/inner/directions/decl/lbfgs-fwd.hpp>
 #include <alpaqa/inner/directions/decl/panoc-direction-update.hpp>
 
+#include <vector>
+
 namespace alpaqa {
 
+#if defined(ALPAQA_LBFGS_HISTORY_FLOAT)
+/// Scalar type used to store the vectors s and y (and x and g) in the history
+/// of the L-BFGS approximations. The inner products and the accumulation of
+/// the L-BFGS directions are always carried out in @ref real_t.
+using lbfgs_history_t = float;
+#elif defined(ALPAQA_LBFGS_HISTORY_HALF)
+using lbfgs_history_t = Eigen::half;
+#elif defined(ALPAQA_LBFGS_HISTORY_BFLOAT16)
+using lbfgs_history_t = Eigen::bfloat16;
+#else
+using lbfgs_history_t = real_t;
+#endif
+
 /// Parameters for the @ref LBFGS and @ref SpecializedLBFGS classes.
 struct LBFGSParams {
     /// Length of the history to keep.
@@ -22,6 +37,15 @@ struct LBFGSParams {
     cbfgs;
 
     bool rescale_when_γ_changes = false;
+
+    /// When applying the approximation to a subset J of the indices, gather
+    /// the vectors s(J) and y(J) into contiguous storage and apply the
+    /// ordinary (vectorized) two-loop recursion to them, instead of indexing
+    /// the full vectors s and y element by element.
+    /// The packed vectors are kept between calls: if the index set J does not
+    /// change, only the pairs (s, y) that were added since the previous call
+    /// are gathered.
+    bool packed_subspace = false;
 };
 
 /// Limited memory Broyden–Fletcher–Goldfarb–Shanno (L-BFGS) algorithm
@@ -45,6 +69,11 @@ class LBFGS {
     static bool update_valid(LBFGSParams params, real_t yᵀs, real_t sᵀs,
                              real_t pᵀp);
 
+    /// Inner product of the vectors y and s after rounding them to
+    /// @ref lbfgs_history_t, i.e. as they will be stored.
+    template <class VecY, class VecS>
+    static real_t rounded_yᵀs(const VecY &y, const VecS &s);
+
     /// Update the inverse Hessian approximation using the new vectors xₖ₊₁
     /// and pₖ₊₁.
     bool update(crvec xₖ, crvec xₖ₊₁, crvec pₖ, crvec pₖ₊₁,
@@ -73,28 +102,60 @@ class LBFGS {
     const Params &get_params() const { return params; }
 
     /// Get the size of the s and y vectors in the buffer.
-    size_t n() const { return sto.rows() - 1; }
+    size_t n() const { return sto.rows(); }
     /// Get the number of previous vectors s and y stored in the buffer.
     size_t history() const { return sto.cols() / 2; }
     /// Get the next index in the circular buffer of previous s and y vectors.
     size_t succ(size_t i) const { return i + 1 < history() ? i + 1 : 0; }
 
-    auto s(size_t i) { return sto.col(2 * i).topRows(n()); }
-    auto s(size_t i) const { return sto.col(2 * i).topRows(n()); }
-    auto y(size_t i) { return sto.col(2 * i + 1).topRows(n()); }
-    auto y(size_t i) const { return sto.col(2 * i + 1).topRows(n()); }
-    real_t &ρ(size_t i) { return sto.coeffRef(n(), 2 * i); }
-    const real_t &ρ(size_t i) const { return sto.coeff(n(), 2 * i); }
-    real_t &α(size_t i) { return sto.coeffRef(n(), 2 * i + 1); }
-    const real_t &α(size_t i) const { return sto.coeff(n(), 2 * i + 1); }
+    /// Stored vector s (with scalar type @ref lbfgs_history_t).
+    auto s(size_t i) { return sto.col(2 * i); }
+    auto s(size_t i) const { return sto.col(2 * i); }
+    /// Stored vector y (with scalar type @ref lbfgs_history_t).
+    auto y(size_t i) { return sto.col(2 * i + 1); }
+    auto y(size_t i) const { return sto.col(2 * i + 1); }
+    real_t &ρ(size_t i) { return coef.coeffRef(0, i); }
+    const real_t &ρ(size_t i) const { return coef.coeff(0, i); }
+    real_t &α(size_t i) { return coef.coeffRef(1, i); }
+    const real_t &α(size_t i) const { return coef.coeff(1, i); }
 
   private:
-    using storage_t = Eigen::Matrix<real_t, Eigen::Dynamic, Eigen::Dynamic>;
+    /// Vector s converted to @ref real_t (expression).
+    auto s_real(size_t i) const { return s(i).template cast<real_t>(); }
+    /// Vector y converted to @ref real_t (expression).
+    auto y_real(size_t i) const { return y(i).template cast<real_t>(); }
 
+    /// Implementation of @ref apply(Vec &&, real_t, const IndexVec &) for
+    /// @ref LBFGSParams::packed_subspace.
+    template <class Vec, class IndexVec>
+    bool apply_packed(Vec &&q, real_t γ, const IndexVec &J);
+
+  private:
+    using storage_t =
+        Eigen::Matrix<lbfgs_history_t, Eigen::Dynamic, Eigen::Dynamic>;
+    using coef_t = Eigen::Matrix<real_t, 2, Eigen::Dynamic>;
+
+    /// Vectors s and y.
     storage_t sto;
+    /// Scalars ρ (first row) and α (second row), always kept in full
+    /// precision.
+    coef_t coef;
     size_t idx = 0;
     bool full  = false;
     Params params;
+
+    /// Vectors s(J) and y(J) for the index set J of the last call to
+    /// @ref apply_packed, in the same layout as @ref sto. Only the first |J|
+    /// rows are used, so changing J doesn't reallocate.
+    storage_t sto_J;
+    /// Scalars ρ(J) and α(J), in the same layout as @ref coef.
+    coef_t coef_J;
+    /// Index set J of the vectors in @ref sto_J.
+    std::vector<vec::Index> J_packed;
+    /// Whether column i of @ref sto_J is up to date with s(i) and y(i).
+    std::vector<bool> packed_valid;
+    /// Work vector for q(J).
+    vec q_J;
 };
 
 template <>
@@ -43,9 +43,9 @@ class SpecializedLBFGS {
     std::string get_name() const { return "SpecializedLBFGS"; }
 
     /// Get the size of the s, y, x and g vectors in the buffer.
-    size_t n() const { return sto.rows() - 1; }
+    size_t n() const { return sto.rows(); }
     /// Get the number of previous vectors s, y, x and g stored in the buffer.
-    size_t history() const { return (sto.cols() - 2) / 4; }
+    size_t history() const { return sto.cols() / 4; }
     /// Get the next index in the circular buffer of previous s, y, x and g
     /// vectors.
     size_t succ(size_t i) const { return i + 1 < history() ? i + 1 : 0; }
@@ -53,31 +53,44 @@ class SpecializedLBFGS {
     /// vectors.
     size_t pred(size_t i) const { return i == 0 ? history() - 1 : i - 1; }
 
-    auto s(size_t i) { return sto.col(2 * i).topRows(n()); }
-    auto s(size_t i) const { return sto.col(2 * i).topRows(n()); }
-    auto y(size_t i) { return sto.col(2 * i + 1).topRows(n()); }
-    auto y(size_t i) const { return sto.col(2 * i + 1).topRows(n()); }
-    auto x(size_t i) { return sto.col(2 * history() + 2 * i).topRows(n()); }
-    auto x(size_t i) const {
-        return sto.col(2 * history() + 2 * i).topRows(n());
-    }
-    auto g(size_t i) { return sto.col(2 * history() + 2 * i + 1).topRows(n()); }
-    auto g(size_t i) const {
-        return sto.col(2 * history() + 2 * i + 1).topRows(n());
-    }
-    auto p() { return sto.col(4 * history()).topRows(n()); }
-    auto p() const { return sto.col(4 * history()).topRows(n()); }
-    auto w() { return sto.col(4 * history() + 1).topRows(n()); }
-    auto w() const { return sto.col(4 * history() + 1).topRows(n()); }
-    real_t &ρ(size_t i) { return sto.coeffRef(n(), 2 * i); }
-    const real_t &ρ(size_t i) const { return sto.coeff(n(), 2 * i); }
-    real_t &α(size_t i) { return sto.coeffRef(n(), 2 * i + 1); }
-    const real_t &α(size_t i) const { return sto.coeff(n(), 2 * i + 1); }
+    /// Stored vectors s, y, x and g (with scalar type @ref lbfgs_history_t).
+    auto s(size_t i) { return sto.col(2 * i); }
+    auto s(size_t i) const { return sto.col(2 * i); }
+    auto y(size_t i) { return sto.col(2 * i + 1); }
+    auto y(size_t i) const { return sto.col(2 * i + 1); }
+    auto x(size_t i) { return sto.col(2 * history() + 2 * i); }
+    auto x(size_t i) const { return sto.col(2 * history() + 2 * i); }
+    auto g(size_t i) { return sto.col(2 * history() + 2 * i + 1); }
+    auto g(size_t i) const { return sto.col(2 * history() + 2 * i + 1); }
+    auto p() { return work.col(0); }
+    auto p() const { return work.col(0); }
+    auto w() { return work.col(1); }
+    auto w() const { return work.col(1); }
+    real_t &ρ(size_t i) { return coef.coeffRef(0, i); }
+    const real_t &ρ(size_t i) const { return coef.coeff(0, i); }
+    real_t &α(size_t i) { return coef.coeffRef(1, i); }
+    const real_t &α(size_t i) const { return coef.coeff(1, i); }
+
+  private:
+    /// Vector s converted to @ref real_t (expression).
+    auto s_real(size_t i) const { return s(i).template cast<real_t>(); }
+    /// Vector y converted to @ref real_t (expression).
+    auto y_real(size_t i) const { return y(i).template cast<real_t>(); }
+    /// Projected gradient step in the stored point x(i) with gradient g(i)
+    /// (expression).
+    /// @see detail::projected_gradient_step
+    auto projected_gradient_step(const Box &C, real_t γ, size_t i) const;
 
   private:
-    using storage_t = Eigen::Matrix<real_t, Eigen::Dynamic, Eigen::Dynamic>;
+    using storage_t =
+        Eigen::Matrix<lbfgs_history_t, Eigen::Dynamic, Eigen::Dynamic>;
 
+    /// Vectors s, y, x and g.
     storage_t sto;
+    /// Work vectors p and w.
+    mat work;
+    /// Scalars ρ (first row) and α (second row).
+    Eigen::Matrix<real_t, 2, Eigen::Dynamic> coef;
     size_t idx   = 0;
     bool full    = false;
     real_t old_γ = 0;
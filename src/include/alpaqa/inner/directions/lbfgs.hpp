@@ -1,6 +1,7 @@
 #pragma once
 
 #include <alpaqa/inner/directions/decl/lbfgs.hpp>
+#include <algorithm>
 #include <stdexcept>
 #include <type_traits>
 
@@ -30,12 +31,28 @@ inline bool LBFGS::update_valid(LBFGSParams params, real_t yᵀs, real_t sᵀs,
     return true;
 }
 
+template <class VecY, class VecS>
+real_t LBFGS::rounded_yᵀs(const VecY &y, const VecS &s) {
+    if constexpr (std::is_same_v<lbfgs_history_t, real_t>) {
+        return y.dot(s);
+    } else {
+        // ρ has to match the vectors that are actually stored, i.e. after
+        // rounding them to lbfgs_history_t, otherwise the inverse Hessian
+        // estimate is no longer guaranteed to be positive definite. Pairs for
+        // which the rounded yᵀs is too small are rejected by update_valid.
+        auto round = [](const auto &v) {
+            return v.template cast<lbfgs_history_t>().template cast<real_t>();
+        };
+        return round(y).dot(round(s));
+    }
+}
+
 inline bool LBFGS::update(crvec xₖ, crvec xₖ₊₁, crvec pₖ, crvec pₖ₊₁, Sign sign,
                           bool forced) {
     const auto s = xₖ₊₁ - xₖ;
     const auto y = sign == Sign::Positive ? pₖ₊₁ - pₖ : pₖ - pₖ₊₁;
-    real_t yᵀs   = y.dot(s);
-    real_t ρ     = 1 / yᵀs;
+    real_t yᵀs = rounded_yᵀs(y, s);
+    real_t ρ   = 1 / yᵀs;
     if (not forced) {
         real_t sᵀs = s.squaredNorm();
         real_t pᵀp = params.cbfgs.ϵ > 0 ? pₖ₊₁.squaredNorm() : 0;
@@ -44,9 +61,11 @@ inline bool LBFGS::update(crvec xₖ, crvec xₖ₊₁, crvec pₖ, crvec pₖ
     }
 
     // Store the new s and y vectors
-    this->s(idx) = s;
-    this->y(idx) = y;
+    this->s(idx) = s.template cast<lbfgs_history_t>();
+    this->y(idx) = y.template cast<lbfgs_history_t>();
     this->ρ(idx) = ρ;
+    if (not packed_valid.empty())
+        packed_valid[idx] = false;
 
     // Increment the index in the circular buffer
     idx = succ(idx);
@@ -64,13 +83,13 @@ bool LBFGS::apply(Vec &&q, real_t γ) {
     // If the step size is negative, compute it as sᵀy/yᵀy
     if (γ < 0) {
         auto new_idx = idx > 0 ? idx - 1 : history() - 1;
-        real_t yᵀy   = y(new_idx).squaredNorm();
+        real_t yᵀy   = y_real(new_idx).squaredNorm();
         γ            = 1. / (ρ(new_idx) * yᵀy);
     }
 
     auto update1 = [&](size_t i) {
-        α(i) = ρ(i) * (s(i).dot(q));
-        q -= α(i) * y(i);
+        α(i) = ρ(i) * (s_real(i).dot(q));
+        q -= α(i) * y_real(i);
     };
     if (idx)
         for (size_t i = idx; i-- > 0;)
@@ -83,8 +102,8 @@ bool LBFGS::apply(Vec &&q, real_t γ) {
     q *= γ;
 
     auto update2 = [&](size_t i) {
-        real_t β = ρ(i) * (y(i).dot(q));
-        q += (α(i) - β) * s(i);
+        real_t β = ρ(i) * (y_real(i).dot(q));
+        q += (α(i) - β) * s_real(i);
     };
     if (full)
         for (size_t i = idx; i < history(); ++i)
@@ -102,6 +121,8 @@ bool LBFGS::apply(Vec &&q, real_t γ, const IndexVec &J) {
         return false;
     using Index = typename std::remove_reference_t<Vec>::Index;
     bool fullJ  = q.size() == Index(J.size());
+    if (params.packed_subspace && not fullJ)
+        return apply_packed(std::forward<Vec>(q), γ, J);
 
     // Eigen 3.3.9 doesn't yet support indexing using a vector of indices
     // so we'll have to do it manually
@@ -125,21 +146,21 @@ bool LBFGS::apply(Vec &&q, real_t γ, const IndexVec &J) {
         // positive for the full vectors s and y, that's not necessarily the
         // case for the smaller vectors s(J) and y(J).
         if (not fullJ)
-            ρ(i) = 1. / dotJ(s(i), y(i));
+            ρ(i) = 1. / dotJ(s_real(i), y_real(i));
 
         if (ρ(i) <= 0) // Reject negative ρ to ensure positive definiteness
             return;
 
-        α(i) = ρ(i) * dotJ(s(i), q);
+        α(i) = ρ(i) * dotJ(s_real(i), q);
         if (fullJ)
-            q -= α(i) * y(i);
+            q -= α(i) * y_real(i);
         else
             for (auto j : J)
-                q(j) -= α(i) * y(i)(j);
+                q(j) -= α(i) * y_real(i)(j);
 
         if (γ < 0) {
             // Compute step size based on most recent yᵀs/yᵀy > 0
-            real_t yᵀy = dotJ(y(i), y(i));
+            real_t yᵀy = dotJ(y_real(i), y_real(i));
             γ          = 1. / (ρ(i) * yᵀy);
         }
     };
@@ -164,12 +185,12 @@ bool LBFGS::apply(Vec &&q, real_t γ, const IndexVec &J) {
     auto update2 = [&](size_t i) {
         if (ρ(i) <= 0)
             return;
-        real_t β = ρ(i) * dotJ(y(i), q);
+        real_t β = ρ(i) * dotJ(y_real(i), q);
         if (fullJ)
-            q += (α(i) - β) * s(i);
+            q += (α(i) - β) * s_real(i);
         else
             for (auto j : J)
-                q(j) += (α(i) - β) * s(i)(j);
+                q(j) += (α(i) - β) * s_real(i)(j);
     };
     if (full)
         for (size_t i = idx; i < history(); ++i)
@@ -180,27 +201,116 @@ bool LBFGS::apply(Vec &&q, real_t γ, const IndexVec &J) {
     return true;
 }
 
+template <class Vec, class IndexVec>
+bool LBFGS::apply_packed(Vec &&q, real_t γ, const IndexVec &J) {
+    auto nJ = static_cast<Eigen::Index>(J.size());
+
+    // When the index set changes, all packed vectors have to be gathered again
+    if (not std::equal(J.begin(), J.end(), J_packed.begin(), J_packed.end())) {
+        J_packed.assign(J.begin(), J.end());
+        std::fill(packed_valid.begin(), packed_valid.end(), false);
+    }
+    // The storage has room for all n rows, only the first |J| are used
+    auto sJ = [&](size_t i) { return sto_J.col(2 * i).topRows(nJ); };
+    auto yJ = [&](size_t i) { return sto_J.col(2 * i + 1).topRows(nJ); };
+    auto sJ_real = [&](size_t i) { return sJ(i).template cast<real_t>(); };
+    auto yJ_real = [&](size_t i) { return yJ(i).template cast<real_t>(); };
+    auto ρJ = [&](size_t i) -> real_t & { return coef_J.coeffRef(0, i); };
+    auto αJ = [&](size_t i) -> real_t & { return coef_J.coeffRef(1, i); };
+
+    // Gather s(J) and y(J) for the pairs that are not up to date yet.
+    // Note that even if ρ was positive for the full vectors s and y, that's
+    // not necessarily the case for the smaller vectors s(J) and y(J).
+    for (size_t i = 0; i < (full ? history() : idx); ++i) {
+        if (packed_valid[i])
+            continue;
+        auto sJi = sJ(i);
+        auto yJi = yJ(i);
+        for (Eigen::Index k = 0; k < nJ; ++k) {
+            sJi(k) = s(i)(J[k]);
+            yJi(k) = y(i)(J[k]);
+        }
+        ρJ(i)           = 1. / sJ_real(i).dot(yJ_real(i));
+        packed_valid[i] = true;
+    }
+    auto qJ = q_J.topRows(nJ);
+    for (Eigen::Index k = 0; k < nJ; ++k)
+        qJ(k) = q(J[k]);
+
+    auto update1 = [&](size_t i) {
+        if (ρJ(i) <= 0) // Reject negative ρ to ensure positive definiteness
+            return;
+        αJ(i) = ρJ(i) * sJ_real(i).dot(qJ);
+        qJ -= αJ(i) * yJ_real(i);
+        if (γ < 0) {
+            // Compute step size based on most recent yᵀs/yᵀy > 0
+            γ = 1. / (ρJ(i) * yJ_real(i).squaredNorm());
+        }
+    };
+    if (idx)
+        for (size_t i = idx; i-- > 0;)
+            update1(i);
+    if (full)
+        for (size_t i = history(); i-- > idx;)
+            update1(i);
+
+    // If all ρ <= 0, fail
+    if (γ < 0)
+        return false;
+
+    // r ← H₀ q
+    qJ *= γ;
+
+    auto update2 = [&](size_t i) {
+        if (ρJ(i) <= 0)
+            return;
+        real_t β = ρJ(i) * yJ_real(i).dot(qJ);
+        qJ += (αJ(i) - β) * sJ_real(i);
+    };
+    if (full)
+        for (size_t i = idx; i < history(); ++i)
+            update2(i);
+    for (size_t i = 0; i < idx; ++i)
+        update2(i);
+
+    // Scatter the result back to the full vector
+    for (Eigen::Index k = 0; k < nJ; ++k)
+        q(J[k]) = qJ(k);
+
+    return true;
+}
+
 inline void LBFGS::reset() {
     idx  = 0;
     full = false;
+    std::fill(packed_valid.begin(), packed_valid.end(), false);
 }
 
 inline void LBFGS::resize(size_t n) {
     if (params.memory < 1)
         throw std::invalid_argument("LBFGSParams::memory must be > 1");
-    sto.resize(n + 1, params.memory * 2);
+    sto.resize(n, params.memory * 2);
+    coef.resize(2, params.memory);
+    packed_valid.resize(params.memory);
+    if (params.packed_subspace) {
+        sto_J.resize(n, params.memory * 2);
+        coef_J.resize(2, params.memory);
+        J_packed.reserve(n);
+        q_J.resize(n);
+    }
     reset();
 }
 
 inline void LBFGS::scale_y(real_t factor) {
+    std::fill(packed_valid.begin(), packed_valid.end(), false);
     if (full) {
         for (size_t i = 0; i < history(); ++i) {
-            y(i) *= factor;
+            y(i) *= lbfgs_history_t(factor);
             ρ(i) *= 1. / factor;
         }
     } else {
         for (size_t i = 0; i < idx; ++i) {
-            y(i) *= factor;
+            y(i) *= lbfgs_history_t(factor);
             ρ(i) *= 1. / factor;
         }
     }
@@ -5,14 +5,22 @@
 #include <alpaqa/inner/directions/lbfgs.hpp>
 
 #include <cmath>
+#include <limits>
 
 namespace alpaqa {
 
 inline void SpecializedLBFGS::initialize(crvec x₀, crvec grad₀) {
     idx  = 0;
     full = false;
-    x(0) = x₀;
-    g(0) = grad₀;
+    x(0) = x₀.template cast<lbfgs_history_t>();
+    g(0) = grad₀.template cast<lbfgs_history_t>();
+}
+
+inline auto SpecializedLBFGS::projected_gradient_step(const Box &C, real_t γ,
+                                                     size_t i) const {
+    auto x_real = x(i).template cast<real_t>();
+    auto g_real = g(i).template cast<real_t>();
+    return clamp(-γ * g_real, C.lowerbound - x_real, C.upperbound - x_real);
 }
 
 /// Standard L-BFGS update without changing the step size γ.
@@ -22,7 +30,7 @@ inline bool SpecializedLBFGS::standard_update(crvec xₖ, crvec xₖ₊₁,
     const auto s = xₖ₊₁ - xₖ;
     const auto y = pₖ - pₖ₊₁;
 
-    real_t yᵀs = y.dot(s);
+    real_t yᵀs = LBFGS::rounded_yᵀs(y, s);
     real_t sᵀs = s.squaredNorm();
     real_t pᵀp = pₖ₊₁.squaredNorm();
     real_t ρ   = 1 / yᵀs;
@@ -31,13 +39,13 @@ inline bool SpecializedLBFGS::standard_update(crvec xₖ, crvec xₖ₊₁,
         return false;
 
     // Store the new s and y vectors
-    this->s(idx) = s;
-    this->y(idx) = y;
+    this->s(idx) = s.template cast<lbfgs_history_t>();
+    this->y(idx) = y.template cast<lbfgs_history_t>();
     this->ρ(idx) = ρ;
 
     // Store x and the gradient
-    this->x(succ(idx)) = xₖ₊₁;
-    this->g(succ(idx)) = gradₖ₊₁;
+    this->x(succ(idx)) = xₖ₊₁.template cast<lbfgs_history_t>();
+    this->g(succ(idx)) = gradₖ₊₁.template cast<lbfgs_history_t>();
 
     // Increment the index in the circular buffer
     idx = succ(idx);
@@ -56,12 +64,12 @@ inline bool SpecializedLBFGS::full_update(crvec xₖ, crvec xₖ₊₁,
     // Old pₖ is no longer valid, recompute with new γ
     (void)pₖ_old_γ;
     auto &&pₖ = this->p();
-    pₖ        = detail::projected_gradient_step(C, γ, x(idx), g(idx));
+    pₖ        = projected_gradient_step(C, γ, idx);
     yₖ        = pₖ - pₖ₊₁;
 
-    assert(x(idx) == xₖ);
+    assert(x(idx) == xₖ.template cast<lbfgs_history_t>());
 
-    real_t yᵀs = yₖ.dot(sₖ);
+    real_t yᵀs = LBFGS::rounded_yᵀs(yₖ, sₖ);
     real_t sᵀs = sₖ.squaredNorm();
     real_t pᵀp = pₖ₊₁.squaredNorm();
     real_t ρₖ  = 1 / yᵀs;
@@ -69,23 +77,34 @@ inline bool SpecializedLBFGS::full_update(crvec xₖ, crvec xₖ₊₁,
     if (not LBFGS::update_valid(params, yᵀs, sᵀs, pᵀp))
         return false;
 
+    // Store the new s and y vectors
+    this->s(idx) = sₖ.template cast<lbfgs_history_t>();
+    this->y(idx) = yₖ.template cast<lbfgs_history_t>();
+    this->ρ(idx) = ρₖ;
+
     // Recompute all residuals with new γ
     // yₖ = pₖ - pₖ₊₁
     // pₖ = Π(-γ∇ψ(xₖ), C - xₖ)
+    // (The workspace w is reused for the difference, which is computed in
+    // full precision before it is stored.)
+    // ρ is recomputed from the stored (rounded) vectors as well, pairs for
+    // which yᵀs is no longer sufficiently positive are disabled by setting
+    // ρ to zero, which turns them into a no-op in apply.
+    const real_t min_divisor = std::sqrt(std::numeric_limits<real_t>::min());
     size_t endidx = full ? idx : pred(0);
     for (size_t i = pred(idx); i != endidx; i = pred(i)) {
-        this->y(i) = -pₖ /* i+1 */;
-        pₖ = detail::projected_gradient_step(C, γ, this->x(i), this->g(i));
-        this->y(i) += pₖ /* i */;
+        yₖ = -pₖ /* i+1 */;
+        pₖ = projected_gradient_step(C, γ, i);
+        yₖ += pₖ /* i */;
+        this->y(i)  = yₖ.template cast<lbfgs_history_t>();
+        real_t yᵀsᵢ = y_real(i).dot(s_real(i));
+        bool valid  = std::isfinite(yᵀsᵢ) && yᵀsᵢ >= min_divisor;
+        this->ρ(i)  = valid ? 1 / yᵀsᵢ : 0;
     }
-    // Store the new s and y vectors
-    this->s(idx) = sₖ;
-    this->y(idx) = yₖ;
-    this->ρ(idx) = ρₖ;
 
     // Store x and the gradient
-    this->x(succ(idx)) = xₖ₊₁;
-    this->g(succ(idx)) = gradₖ₊₁;
+    this->x(succ(idx)) = xₖ₊₁.template cast<lbfgs_history_t>();
+    this->g(succ(idx)) = gradₖ₊₁.template cast<lbfgs_history_t>();
 
     // Increment the index in the circular buffer
     idx = succ(idx);
@@ -109,8 +128,8 @@ template <class Vec>
 void SpecializedLBFGS::apply(Vec &&q) {
     // TODO: dry, reuse standard LBFGS::apply
     auto update1 = [&](size_t i) {
-        α(i) = ρ(i) * (s(i).dot(q));
-        q -= α(i) * y(i);
+        α(i) = ρ(i) * (s_real(i).dot(q));
+        q -= α(i) * y_real(i);
     };
     if (idx)
         for (size_t i = idx; i-- > 0;)
@@ -122,8 +141,8 @@ void SpecializedLBFGS::apply(Vec &&q) {
     // q = H₀ * q; // TODO: diagonal matrix H₀?
 
     auto update2 = [&](size_t i) {
-        real_t β = ρ(i) * (y(i).dot(q));
-        q += (α(i) - β) * s(i);
+        real_t β = ρ(i) * (y_real(i).dot(q));
+        q += (α(i) - β) * s_real(i);
     };
     if (full)
         for (size_t i = idx; i < history(); ++i)
@@ -133,8 +152,10 @@ void SpecializedLBFGS::apply(Vec &&q) {
 }
 
 inline void SpecializedLBFGS::resize(size_t n, size_t history) {
-    sto.resize(n + 1, history * 4 + 2);
-    sto.fill(std::numeric_limits<real_t>::quiet_NaN());
+    sto.resize(n, history * 4);
+    sto.fill(std::numeric_limits<lbfgs_history_t>::quiet_NaN());
+    work.resize(n, 2);
+    coef.resize(2, history);
     idx  = 0;
     full = false;
 }
@@ -109,6 +109,43 @@ class GAAPGASolver {
     Params params;
     AtomicStopSignal stop_signal;
     std::function<void(const ProgressInfo &)> progress_cb;
+
+    /// Storage for the iterates, the Anderson acceleration history and work
+    /// vectors, kept between calls so that solving problems of the same size
+    /// doesn't allocate.
+    struct Workspace {
+        vec xₖ,        ///< Value of x at the beginning of the iteration
+            x̂ₖ,        ///< Value of x after a projected gradient step
+            gₖ,        ///< <?>
+            rₖ₋₁,      ///< <?>
+            rₖ,        ///< <?>
+            pₖ,        ///< Projected gradient step
+            yₖ,        ///< Value of x after a gradient or AA step
+            ŷₖ,        ///< <?>
+            grad_ψₖ,   ///< ∇ψ(xₖ)
+            grad_ψx̂ₖ;  ///< ∇ψ(x̂ₖ)
+        vec work_n, work_n2, work_m;
+        LimitedMemoryQR qr;
+        mat G;
+        vec γ_LS;
+
+        /// Resize all vectors (no-op if the sizes didn't change). Always resets
+        /// the Anderson acceleration history.
+        void resize(Eigen::Index n, Eigen::Index m, Eigen::Index m_AA) {
+            for (vec *v : {&xₖ, &x̂ₖ, &gₖ, &rₖ₋₁, &rₖ, &pₖ, &yₖ, &grad_ψₖ,
+                           &grad_ψx̂ₖ, &work_n, &work_n2})
+                v->resize(n);
+            for (vec *v : {&ŷₖ, &work_m})
+                v->resize(m);
+            if (qr.n() != static_cast<size_t>(n) ||
+                qr.m() != static_cast<size_t>(m_AA))
+                qr.resize(n, m_AA);
+            else
+                qr.reset();
+            G.resize(n, m_AA);
+            γ_LS.resize(m_AA);
+        }
+    } work;
 };
 
 using std::chrono::duration_cast;
@@ -129,23 +166,20 @@ GAAPGASolver::operator()(const Problem &problem,        // in
     const auto n = problem.n;
     const auto m = problem.m;
 
-    vec xₖ = x,      // Value of x at the beginning of the iteration
-        x̂ₖ(n),       // Value of x after a projected gradient step
-        gₖ(n),       // <?>
-        rₖ₋₁(n),     // <?>
-        rₖ(n),       // <?>
-        pₖ(n),       // Projected gradient step
-        yₖ(n),       // Value of x after a gradient or AA step
-        ŷₖ(m),       // <?>
-        grad_ψₖ(n),  // ∇ψ(xₖ)
-        grad_ψx̂ₖ(n); // ∇ψ(x̂ₖ)
+    // The workspace is only reallocated when the problem dimensions change, so
+    // subsequent calls with the same problem (e.g. by ALM) don't allocate.
+    unsigned m_AA = std::min(params.limitedqr_mem, n);
+    work.resize(n, m, m_AA);
 
-    vec work_n(n), work_n2(n), work_m(m);
+    auto &xₖ = work.xₖ, &x̂ₖ = work.x̂ₖ, &gₖ = work.gₖ, &rₖ₋₁ = work.rₖ₋₁,
+         &rₖ = work.rₖ, &pₖ = work.pₖ, &yₖ = work.yₖ, &ŷₖ = work.ŷₖ,
+         &grad_ψₖ = work.grad_ψₖ, &grad_ψx̂ₖ = work.grad_ψx̂ₖ;
+    auto &work_n = work.work_n, &work_n2 = work.work_n2, &work_m = work.work_m;
+    auto &qr = work.qr;
+    auto &G    = work.G;
+    auto &γ_LS = work.γ_LS;
 
-    unsigned m_AA = std::min(params.limitedqr_mem, n);
-    LimitedMemoryQR qr(n, m_AA);
-    mat G(n, m_AA);
-    vec γ_LS(m_AA);
+    xₖ = x;
 
     // Helper functions --------------------------------------------------------
 
@@ -162,8 +196,9 @@ GAAPGASolver::operator()(const Problem &problem,        // in
                                                   rvec grad_ψ) {
         detail::calc_grad_ψ_from_ŷ(problem, x, ŷ, grad_ψ, work_n);
     };
-    auto calc_x̂ = [&problem](real_t γ, crvec x, crvec grad_ψ, rvec x̂, rvec p) {
-        detail::calc_x̂(problem, γ, x, grad_ψ, x̂, p);
+    auto calc_x̂ = [&problem](real_t γ, crvec x, crvec grad_ψ, rvec x̂, rvec p,
+                             real_t &grad_ψᵀp, real_t &pᵀp) {
+        detail::calc_x̂(problem.C, γ, x, grad_ψ, x̂, p, grad_ψᵀp, pᵀp);
     };
     auto calc_err_z = [&problem, &y, &Σ](crvec x̂, rvec err_z) {
         detail::calc_err_z(problem, x̂, y, Σ, err_z);
@@ -236,12 +271,10 @@ GAAPGASolver::operator()(const Problem &problem,        // in
         // Quadratic upper bound -----------------------------------------------
 
         // Projected gradient step: x̂ₖ and pₖ
-        calc_x̂(γₖ, xₖ, grad_ψₖ, /* in ⟹ out */ x̂ₖ, pₖ);
+        real_t grad_ψₖᵀpₖ, pₖᵀpₖ;
+        calc_x̂(γₖ, xₖ, grad_ψₖ, /* in ⟹ out */ x̂ₖ, pₖ, grad_ψₖᵀpₖ, pₖᵀpₖ);
         // Calculate ψ(x̂ₖ) and ŷ(x̂ₖ)
         real_t ψx̂ₖ = calc_ψ_ŷ(x̂ₖ, /* in ⟹ out */ ŷₖ);
-        // Calculate ∇ψ(xₖ)ᵀpₖ and ‖pₖ‖²
-        real_t grad_ψₖᵀpₖ = grad_ψₖ.dot(pₖ);
-        real_t pₖᵀpₖ      = pₖ.squaredNorm();
 
         real_t old_γₖ = descent_lemma(xₖ, ψₖ, grad_ψₖ, x̂ₖ, pₖ, ŷₖ, ψx̂ₖ, pₖᵀpₖ,
                                       grad_ψₖᵀpₖ, Lₖ, γₖ);
@@ -271,7 +304,8 @@ GAAPGASolver::operator()(const Problem &problem,        // in
         // Check stop condition ------------------------------------------------
 
         real_t εₖ = detail::calc_error_stop_crit(
-            problem.C, params.stop_crit, pₖ, γₖ, xₖ, x̂ₖ, ŷₖ, grad_ψₖ, grad_ψx̂ₖ);
+            problem.C, params.stop_crit, pₖ, pₖᵀpₖ, γₖ, xₖ, x̂ₖ, ŷₖ, grad_ψₖ,
+            grad_ψx̂ₖ);
 
         // Print progress
         if (params.print_interval != 0 && k % params.print_interval == 0)
@@ -292,8 +326,8 @@ GAAPGASolver::operator()(const Problem &problem,        // in
                 stop_status == SolverStatus::Interrupted ||
                 always_overwrite_results) {
                 calc_err_z(x̂ₖ, /* in ⟹ out */ err_z);
-                x = std::move(x̂ₖ);
-                y = std::move(ŷₖ);
+                x = x̂ₖ;
+                y = ŷₖ;
             }
             s.iterations   = k;
             s.ε            = εₖ;
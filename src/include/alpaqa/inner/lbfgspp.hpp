@@ -61,7 +61,7 @@ class LBFGSSolver {
         params.epsilon = ε;
         vec x٭         = x;
         try {
-            LBFGSpp::LBFGSSolver<double> solver(params);
+            LBFGSpp::LBFGSSolver<real_t> solver(params);
             s.iterations = solver.minimize(calc_ψ_grad_ψ, x٭, ψ٭);
             s.status     = SolverStatus::Converged; // TODO: <?>
         } catch (std::runtime_error &) {
@@ -139,7 +139,7 @@ class LBFGSBSolver {
         params.epsilon = ε;
         vec x٭         = x;
         try {
-            LBFGSpp::LBFGSBSolver<double> solver(params);
+            LBFGSpp::LBFGSBSolver<real_t> solver(params);
             s.iterations =
                 solver.minimize(calc_ψ_grad_ψ, x٭, ψ٭, problem.C.lowerbound,
                                 problem.C.upperbound);
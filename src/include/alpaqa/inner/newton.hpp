@@ -1,2 +1,110 @@
 #pragma once
 
+#include <alpaqa/util/vec.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace alpaqa {
+
+/// Parameters for the truncated Newton-CG method, see @ref steihaug_cg.
+struct NewtonCGParams {
+    /// Maximum number of conjugate gradient iterations. If set to zero, the
+    /// dimension of the system is used.
+    unsigned max_iter = 0;
+    /// Upper bound on the forcing term @f$ \eta @f$: the iterations stop when
+    /// @f$ \|r\| \le \min\left(\eta_{\max}, \sqrt{\|b\|}\right) \|b\| @f$,
+    /// which results in superlinear convergence of the Newton method.
+    real_t η_max = 0.5;
+    /// Use a diagonal (Jacobi) preconditioner.
+    bool preconditioning = true;
+};
+
+/// Results of the truncated conjugate gradient method.
+struct NewtonCGStats {
+    /// Number of conjugate gradient iterations (Hessian-vector products).
+    unsigned iterations = 0;
+    /// Whether the iterations were stopped because a direction of
+    /// nonpositive curvature was encountered.
+    bool negative_curvature = false;
+};
+
+/// Approximately solve the Newton system @f$ H x = b @f$ using the
+/// (preconditioned) conjugate gradient method, where @f$ H @f$ is only
+/// available through Hessian-vector products. Following Steihaug, the
+/// iterations are truncated when a direction of nonpositive curvature is
+/// encountered, in which case the last iterate is returned (or the
+/// preconditioned right-hand side if this happens in the first iteration),
+/// so the result is always a descent direction for the model
+/// @f$ \tfrac12 x^\top H x - b^\top x @f$.
+template <class HessProd>
+NewtonCGStats steihaug_cg(
+    /// [in]    Parameters
+    const NewtonCGParams &params,
+    /// [in]    Function that evaluates the Hessian-vector product
+    ///         `hess_prod(crvec v, rvec Hv)`
+    HessProd &&hess_prod,
+    /// [in]    Right-hand side @f$ b @f$
+    crvec b,
+    /// [in]    Diagonal of the preconditioner @f$ M @f$ (positive), ignored if
+    ///         preconditioning is disabled
+    crvec M,
+    /// [out]   Solution @f$ x @f$
+    rvec x,
+    ///         Dimension n
+    rvec r,
+    ///         Dimension n
+    rvec z,
+    ///         Dimension n
+    rvec p,
+    ///         Dimension n
+    rvec Hp) {
+
+    NewtonCGStats s;
+    auto precondition = [&](crvec r, rvec z) {
+        if (params.preconditioning)
+            z = r.cwiseQuotient(M);
+        else
+            z = r;
+    };
+
+    const real_t norm_b = b.norm();
+    const real_t tol    = std::min(params.η_max, std::sqrt(norm_b)) * norm_b;
+    const auto max_iter = params.max_iter > 0
+                              ? params.max_iter
+                              : static_cast<unsigned>(b.size());
+
+    x.setZero();
+    r = b;
+    precondition(r, z);
+    p          = z;
+    real_t rᵀz = r.dot(z);
+    if (norm_b == 0)
+        return s;
+
+    while (s.iterations < max_iter) {
+        hess_prod(p, Hp);
+        ++s.iterations;
+        real_t pᵀHp = p.dot(Hp);
+        // Truncate when the curvature is not positive
+        if (not(pᵀHp > 0)) {
+            s.negative_curvature = true;
+            if (s.iterations == 1)
+                x = z;
+            break;
+        }
+        real_t α = rᵀz / pᵀHp;
+        x += α * p;
+        r -= α * Hp;
+        if (r.norm() <= tol)
+            break;
+        precondition(r, z);
+        real_t rᵀz_new = r.dot(z);
+        real_t β       = rᵀz_new / rᵀz;
+        rᵀz            = rᵀz_new;
+        p              = z + β * p;
+    }
+    return s;
+}
+
+} // namespace alpaqa
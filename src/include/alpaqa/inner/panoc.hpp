@@ -4,11 +4,13 @@
 #include <alpaqa/inner/detail/panoc-helpers.hpp>
 #include <alpaqa/inner/directions/decl/panoc-direction-update.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <iomanip>
 #include <iostream>
 #include <stdexcept>
+#include <type_traits>
 
 namespace alpaqa {
 
@@ -20,6 +22,26 @@ std::string PANOCSolver<DirectionProviderT>::get_name() const {
     return "PANOCSolver<" + direction_provider.get_name() + ">";
 }
 
+template <class DirectionProviderT>
+void PANOCSolver<DirectionProviderT>::get_warm_start(WarmStart &ws) const {
+    // Assign to the existing storage, so saving the state of a problem of the
+    // same size doesn't allocate
+    ws.prev_call = prev_call;
+    if (ws.direction_provider)
+        *ws.direction_provider = direction_provider;
+    else
+        ws.direction_provider.emplace(direction_provider);
+}
+
+template <class DirectionProviderT>
+void PANOCSolver<DirectionProviderT>::set_warm_start(const WarmStart &ws) {
+    prev_call = ws.prev_call;
+    if (ws.direction_provider)
+        direction_provider = *ws.direction_provider;
+    else
+        prev_call.valid = false;
+}
+
 template <class DirectionProviderT>
 typename PANOCSolver<DirectionProviderT>::Stats
 PANOCSolver<DirectionProviderT>::operator()(
@@ -37,6 +59,27 @@ PANOCSolver<DirectionProviderT>::operator()(
     rvec y,
     /// [out]   Slack variable error @f$ g(x) - z @f$
     rvec err_z) {
+    return solve(problem, Σ, ε, always_overwrite_results, x, y, err_z);
+}
+
+template <class DirectionProviderT>
+template <class ProblemT>
+typename PANOCSolver<DirectionProviderT>::Stats
+PANOCSolver<DirectionProviderT>::solve(
+    /// [in]    Problem description
+    const ProblemT &problem,
+    /// [in]    Constraint weights @f$ \Sigma @f$
+    crvec Σ,
+    /// [in]    Tolerance @f$ \varepsilon @f$
+    real_t ε,
+    /// [in]    Overwrite @p x, @p y and @p err_z even if not converged
+    bool always_overwrite_results,
+    /// [inout] Decision variable @f$ x @f$
+    rvec x,
+    /// [inout] Lagrange multipliers @f$ y @f$
+    rvec y,
+    /// [out]   Slack variable error @f$ g(x) - z @f$
+    rvec err_z) {
 
     auto start_time = std::chrono::steady_clock::now();
     Stats s;
@@ -46,57 +89,73 @@ PANOCSolver<DirectionProviderT>::operator()(
 
     // Allocate vectors, init L-BFGS -------------------------------------------
 
-    // TODO: the L-BFGS objects and vectors allocate on each iteration of ALM,
-    //       and there are more vectors than strictly necessary.
-
+    // The workspace is only reallocated when the problem dimensions change, so
+    // subsequent calls with the same problem (e.g. by ALM) don't allocate.
     bool need_grad_̂ψₖ = detail::stop_crit_requires_grad_̂ψₖ(params.stop_crit);
-
-    vec xₖ = x,   // Value of x at the beginning of the iteration
-        x̂ₖ(n),    // Value of x after a projected gradient step
-        xₖ₊₁(n),  // xₖ for next iteration
-        x̂ₖ₊₁(n),  // x̂ₖ for next iteration
-        ŷx̂ₖ(m),   // ŷ(x̂ₖ) = Σ (g(x̂ₖ) - ẑₖ)
-        ŷx̂ₖ₊₁(m), // ŷ(x̂ₖ) for next iteration
-        pₖ(n),    // Projected gradient step pₖ = x̂ₖ - xₖ
-        pₖ₊₁(n), // Projected gradient step pₖ₊₁ = x̂ₖ₊₁ - xₖ₊₁
-        qₖ(n),   // Newton step Hₖ pₖ
-        grad_ψₖ(n),                    // ∇ψ(xₖ)
-        grad_̂ψₖ(need_grad_̂ψₖ ? n : 0), // ∇ψ(x̂ₖ)
-        grad_ψₖ₊₁(n);                  // ∇ψ(xₖ₊₁)
-
-    vec work_n(n), work_m(m);
+    // Problems that aren't thread-safe use the sequential line search
+    unsigned parallel_candidates = detail::ψ_grad_ψ_thread_safe(problem)
+                                       ? params.linesearch_parallel_candidates
+                                       : 0;
+    work.resize(n, m, need_grad_̂ψₖ, parallel_candidates);
+    auto &candidates = work.candidates;
+    // The calling thread evaluates one of the candidates itself
+    thread_pool.resize(candidates.empty() ? 0 : candidates.size() - 1);
+    // A single extra thread for the evaluations that are independent of each
+    // other (the calling thread always does one of them)
+    eval_pool.resize(params.concurrent_evaluations ? 1 : 0);
+    ThreadPool *pool = params.concurrent_evaluations ? &eval_pool : nullptr;
+
+    auto &xₖ = work.xₖ, &x̂ₖ = work.x̂ₖ, &xₖ₊₁ = work.xₖ₊₁, &x̂ₖ₊₁ = work.x̂ₖ₊₁,
+         &ŷx̂ₖ = work.ŷx̂ₖ, &ŷx̂ₖ₊₁ = work.ŷx̂ₖ₊₁, &pₖ = work.pₖ, &pₖ₊₁ = work.pₖ₊₁,
+         &qₖ = work.qₖ, &grad_ψₖ = work.grad_ψₖ, &grad_̂ψₖ = work.grad_̂ψₖ,
+         &grad_ψₖ₊₁ = work.grad_ψₖ₊₁;
+    auto &work_n = work.work_n, &work_m = work.work_m;
+
+    xₖ = x;
 
     // Keep track of how many successive iterations didn't update the iterate
     unsigned no_progress = 0;
 
+    // The progress callback only has access to the type-erased problem
+    Problem problem_view;
+    const Problem *erased_problem = nullptr;
+    if constexpr (std::is_base_of_v<Problem, ProblemT>)
+        erased_problem = &problem;
+    else if (progress_cb)
+        erased_problem = &(problem_view = make_problem_view(problem));
+
     // Helper functions --------------------------------------------------------
 
     // Wrappers for helper functions that automatically pass along any arguments
     // that are constant within PANOC (for readability in the main algorithm)
-    auto calc_ψ_ŷ = [&problem, &y, &Σ](crvec x, rvec ŷ) {
-        return detail::calc_ψ_ŷ(problem, x, y, Σ, ŷ);
+    auto calc_ψ_ŷ = [&problem, &y, &Σ, pool](crvec x, rvec ŷ) {
+        return detail::calc_ψ_ŷ(problem, x, y, Σ, ŷ, pool);
     };
-    auto calc_ψ_grad_ψ = [&problem, &y, &Σ, &work_n, &work_m](crvec x,
-                                                              rvec grad_ψ) {
-        return detail::calc_ψ_grad_ψ(problem, x, y, Σ, grad_ψ, work_n, work_m);
+    auto calc_ψ_grad_ψ = [&problem, &y, &Σ, &work_n, &work_m,
+                          pool](crvec x, rvec grad_ψ) {
+        return detail::calc_ψ_grad_ψ(problem, x, y, Σ, grad_ψ, work_n, work_m,
+                                     pool);
     };
-    auto calc_grad_ψ_from_ŷ = [&problem, &work_n](crvec x, crvec ŷ,
-                                                  rvec grad_ψ) {
-        detail::calc_grad_ψ_from_ŷ(problem, x, ŷ, grad_ψ, work_n);
+    auto calc_grad_ψ_from_ŷ = [&problem, &work_n, pool](crvec x, crvec ŷ,
+                                                        rvec grad_ψ) {
+        detail::calc_grad_ψ_from_ŷ(problem, x, ŷ, grad_ψ, work_n, pool);
     };
-    auto calc_x̂ = [&problem](real_t γ, crvec x, crvec grad_ψ, rvec x̂, rvec p) {
-        detail::calc_x̂(problem, γ, x, grad_ψ, x̂, p);
+    auto calc_x̂ = [&problem](real_t γ, crvec x, crvec grad_ψ, rvec x̂, rvec p,
+                             real_t &grad_ψᵀp, real_t &pᵀp) {
+        detail::calc_x̂(problem.C, γ, x, grad_ψ, x̂, p, grad_ψᵀp, pᵀp);
     };
     auto calc_err_z = [&problem, &y, &Σ](crvec x̂, rvec err_z) {
         detail::calc_err_z(problem, x̂, y, Σ, err_z);
     };
-    auto descent_lemma = [this, &problem, &y,
-                          &Σ](crvec xₖ, real_t ψₖ, crvec grad_ψₖ, rvec x̂ₖ,
-                              rvec pₖ, rvec ŷx̂ₖ, real_t &ψx̂ₖ, real_t &pₖᵀpₖ,
-                              real_t &grad_ψₖᵀpₖ, real_t &Lₖ, real_t &γₖ) {
+    auto descent_lemma = [this, &problem, &y, &Σ](
+                             crvec xₖ, real_t ψₖ, crvec grad_ψₖ, rvec x̂ₖ,
+                             rvec pₖ, rvec ŷx̂ₖ, real_t &ψx̂ₖ, real_t &pₖᵀpₖ,
+                             real_t &grad_ψₖᵀpₖ, real_t &Lₖ, real_t &γₖ,
+                             ThreadPool *pool) {
         return detail::descent_lemma(
             problem, params.quadratic_upperbound_tolerance_factor, params.L_max,
-            xₖ, ψₖ, grad_ψₖ, y, Σ, x̂ₖ, pₖ, ŷx̂ₖ, ψx̂ₖ, pₖᵀpₖ, grad_ψₖᵀpₖ, Lₖ, γₖ);
+            xₖ, ψₖ, grad_ψₖ, y, Σ, x̂ₖ, pₖ, ŷx̂ₖ, ψx̂ₖ, pₖᵀpₖ, grad_ψₖᵀpₖ, Lₖ, γₖ,
+            pool);
     };
     auto print_progress = [&](unsigned k, real_t ψₖ, crvec grad_ψₖ,
                               real_t pₖᵀpₖ, real_t γₖ, real_t εₖ) {
@@ -110,9 +169,24 @@ PANOCSolver<DirectionProviderT>::operator()(
 
     // Estimate Lipschitz constant ---------------------------------------------
 
+    // State of the previous call that can be reused in this call
+    auto &prev       = prev_call;
+    bool prev_usable = prev.valid && prev.n == xₖ.size() &&
+                       prev.Σ.size() == Σ.size();
+    prev.valid       = false;
+
     real_t ψₖ, Lₖ;
+    // Lipschitz estimate of the previous call, scaled by the change in Σ
+    if (params.reuse_lipschitz_estimate && prev_usable) {
+        real_t Σ_ratio = Σ.size() > 0 ? vec_util::norm_inf(Σ) /
+                                            vec_util::norm_inf(prev.Σ)
+                                      : 1;
+        Lₖ = std::clamp(Σ_ratio * prev.L, params.L_min, params.L_max);
+        // Calculate ψ(xₖ), ∇ψ(x₀)
+        ψₖ = calc_ψ_grad_ψ(xₖ, /* in ⟹ out */ grad_ψₖ);
+    }
     // Finite difference approximation of ∇²ψ in starting point
-    if (params.Lipschitz.L₀ <= 0) {
+    else if (params.Lipschitz.L₀ <= 0) {
         Lₖ = detail::initial_lipschitz_estimate(
             problem, xₖ, y, Σ, params.Lipschitz.ε, params.Lipschitz.δ,
             params.L_min, params.L_max,
@@ -131,14 +205,21 @@ PANOCSolver<DirectionProviderT>::operator()(
     real_t γₖ = params.Lipschitz.Lγ_factor / Lₖ;
     real_t τ  = NaN;
 
+    // Check whether the direction provider can be used as is, or whether it
+    // has to be initialized again
+    bool keep_history = params.keep_direction_history && prev_usable;
+    if (keep_history) {
+        real_t max_ratio = params.keep_direction_history_max_Σ_increase;
+        keep_history     = (Σ.array() <= max_ratio * prev.Σ.array()).all();
+    }
+
     // First projected gradient step -------------------------------------------
 
     // Calculate x̂₀, p₀ (projected gradient step)
-    calc_x̂(γₖ, xₖ, grad_ψₖ, /* in ⟹ out */ x̂ₖ, pₖ);
+    real_t grad_ψₖᵀpₖ, pₖᵀpₖ;
+    calc_x̂(γₖ, xₖ, grad_ψₖ, /* in ⟹ out */ x̂ₖ, pₖ, grad_ψₖᵀpₖ, pₖᵀpₖ);
     // Calculate ψ(x̂ₖ) and ŷ(x̂ₖ)
     real_t ψx̂ₖ        = calc_ψ_ŷ(x̂ₖ, /* in ⟹ out */ ŷx̂ₖ);
-    real_t grad_ψₖᵀpₖ = grad_ψₖ.dot(pₖ);
-    real_t pₖᵀpₖ      = pₖ.squaredNorm();
     // Compute forward-backward envelope
     real_t φₖ = ψₖ + 1 / (2 * γₖ) * pₖᵀpₖ + grad_ψₖᵀpₖ;
 
@@ -152,28 +233,57 @@ PANOCSolver<DirectionProviderT>::operator()(
             real_t old_γₖ =
                 descent_lemma(xₖ, ψₖ, grad_ψₖ,
                               /* in ⟹ out */ x̂ₖ, pₖ, ŷx̂ₖ,
-                              /* inout */ ψx̂ₖ, pₖᵀpₖ, grad_ψₖᵀpₖ, Lₖ, γₖ);
+                              /* inout */ ψx̂ₖ, pₖᵀpₖ, grad_ψₖᵀpₖ, Lₖ, γₖ,
+                              pool);
             if (k > 0 && γₖ != old_γₖ) // Flush L-BFGS if γ changed
                 direction_provider.changed_γ(γₖ, old_γₖ);
-            else if (k == 0) // Initialize L-BFGS
+            else if (k == 0 && keep_history) { // Keep L-BFGS of previous call
+                if (γₖ != prev.γ)
+                    direction_provider.changed_γ(γₖ, prev.γ);
+            } else if (k == 0) // Initialize L-BFGS
                 direction_provider.initialize(xₖ, x̂ₖ, pₖ, grad_ψₖ);
             if (γₖ != old_γₖ)
                 φₖ = ψₖ + 1 / (2 * γₖ) * pₖᵀpₖ + grad_ψₖᵀpₖ;
         }
+        // Calculate quasi-Newton step -----------------------------------------
+        real_t step_size =
+            params.lbfgs_stepsize == LBFGSStepSize::BasedOnGradientStepSize
+                ? 1
+                : -1;
+        auto apply_direction = [&] {
+            direction_provider.apply(xₖ, x̂ₖ, pₖ, step_size,
+                                     /* in ⟹ out */ qₖ);
+        };
+        // The quasi-Newton step doesn't depend on ∇ψ(x̂ₖ), so both can be
+        // computed at the same time (at the cost of a wasted step if PANOC
+        // stops in this iteration)
+        bool applied_direction = false;
+
         // Calculate ∇ψ(x̂ₖ)
-        if (need_grad_̂ψₖ)
+        if (need_grad_̂ψₖ && pool && k > 0) {
+            detail::invoke_concurrently(
+                pool,
+                [&] {
+                    detail::calc_grad_ψ_from_ŷ(problem, x̂ₖ, ŷx̂ₖ,
+                                               /* in ⟹ out */ grad_̂ψₖ, work_n);
+                },
+                apply_direction);
+            applied_direction = true;
+        } else if (need_grad_̂ψₖ) {
             calc_grad_ψ_from_ŷ(x̂ₖ, ŷx̂ₖ, /* in ⟹ out */ grad_̂ψₖ);
+        }
 
         // Check stop condition ------------------------------------------------
         real_t εₖ = detail::calc_error_stop_crit(
-            problem.C, params.stop_crit, pₖ, γₖ, xₖ, x̂ₖ, ŷx̂ₖ, grad_ψₖ, grad_̂ψₖ);
+            problem.C, params.stop_crit, pₖ, pₖᵀpₖ, γₖ, xₖ, x̂ₖ, ŷx̂ₖ, grad_ψₖ,
+            grad_̂ψₖ);
 
         // Print progress
         if (params.print_interval != 0 && k % params.print_interval == 0)
             print_progress(k, ψₖ, grad_ψₖ, pₖᵀpₖ, γₖ, εₖ);
         if (progress_cb)
             progress_cb({k, xₖ, pₖ, pₖᵀpₖ, x̂ₖ, φₖ, ψₖ, grad_ψₖ, ψx̂ₖ, grad_̂ψₖ,
-                         Lₖ, γₖ, τ, εₖ, Σ, y, problem, params});
+                         Lₖ, γₖ, τ, εₖ, Σ, y, *erased_problem, params});
 
         auto time_elapsed = std::chrono::steady_clock::now() - start_time;
         auto stop_status  = detail::check_all_stop_conditions(
@@ -187,24 +297,26 @@ PANOCSolver<DirectionProviderT>::operator()(
                 stop_status == SolverStatus::Interrupted ||
                 always_overwrite_results) {
                 calc_err_z(x̂ₖ, /* in ⟹ out */ err_z);
-                x = std::move(x̂ₖ);
-                y = std::move(ŷx̂ₖ);
+                x = x̂ₖ;
+                y = ŷx̂ₖ;
             }
             s.iterations   = k;
             s.ε            = εₖ;
             s.elapsed_time = duration_cast<microseconds>(time_elapsed);
             s.status       = stop_status;
+            if (params.keep_direction_history ||
+                params.reuse_lipschitz_estimate) {
+                prev.valid = stop_status != SolverStatus::NotFinite;
+                prev.n     = xₖ.size();
+                prev.L     = Lₖ;
+                prev.γ     = γₖ;
+                prev.Σ     = Σ;
+            }
             return s;
         }
 
-        // Calculate quasi-Newton step -----------------------------------------
-        real_t step_size =
-            params.lbfgs_stepsize == LBFGSStepSize::BasedOnGradientStepSize
-                ? 1
-                : -1;
-        if (k > 0)
-            direction_provider.apply(xₖ, x̂ₖ, pₖ, step_size,
-                                     /* in ⟹ out */ qₖ);
+        if (k > 0 && not applied_direction)
+            apply_direction();
 
         // Line search initialization ------------------------------------------
         τ                  = 1;
@@ -226,54 +338,149 @@ PANOCSolver<DirectionProviderT>::operator()(
         }
 
         // Line search loop ----------------------------------------------------
-        do {
-            Lₖ₊₁ = Lₖ;
-            γₖ₊₁ = γₖ;
-
-            // Calculate xₖ₊₁
-            if (τ / 2 < params.τ_min) { // line search failed
-                xₖ₊₁.swap(x̂ₖ);          // → safe prox step
-                ψₖ₊₁ = ψx̂ₖ;
-                if (need_grad_̂ψₖ)
-                    grad_ψₖ₊₁.swap(grad_̂ψₖ);
-                else
-                    calc_grad_ψ_from_ŷ(xₖ₊₁, ŷx̂ₖ, /* in ⟹ out */ grad_ψₖ₊₁);
-            } else {        // line search didn't fail (yet)
-                if (τ == 1) // → faster quasi-Newton step
-                    xₖ₊₁ = xₖ + qₖ;
-                else
-                    xₖ₊₁ = xₖ + (1 - τ) * pₖ + τ * qₖ;
-                // Calculate ψ(xₖ₊₁), ∇ψ(xₖ₊₁)
-                ψₖ₊₁ = calc_ψ_grad_ψ(xₖ₊₁, /* in ⟹ out */ grad_ψₖ₊₁);
-            }
-
-            // Calculate x̂ₖ₊₁, pₖ₊₁ (projected gradient step in xₖ₊₁)
-            calc_x̂(γₖ₊₁, xₖ₊₁, grad_ψₖ₊₁, /* in ⟹ out */ x̂ₖ₊₁, pₖ₊₁);
-            // Calculate ψ(x̂ₖ₊₁) and ŷ(x̂ₖ₊₁)
-            ψx̂ₖ₊₁ = calc_ψ_ŷ(x̂ₖ₊₁, /* in ⟹ out */ ŷx̂ₖ₊₁);
-
-            // Quadratic upper bound -------------------------------------------
-            grad_ψₖ₊₁ᵀpₖ₊₁ = grad_ψₖ₊₁.dot(pₖ₊₁);
-            pₖ₊₁ᵀpₖ₊₁      = pₖ₊₁.squaredNorm();
-            real_t pₖ₊₁ᵀpₖ₊₁_ₖ = pₖ₊₁ᵀpₖ₊₁; // prox step with step size γₖ
-
-            if (params.update_lipschitz_in_linesearch == true) {
-                // Decrease step size until quadratic upper bound is satisfied
-                (void)descent_lemma(xₖ₊₁, ψₖ₊₁, grad_ψₖ₊₁,
-                                    /* in ⟹ out */ x̂ₖ₊₁, pₖ₊₁, ŷx̂ₖ₊₁,
-                                    /* inout */ ψx̂ₖ₊₁, pₖ₊₁ᵀpₖ₊₁,
-                                    grad_ψₖ₊₁ᵀpₖ₊₁, Lₖ₊₁, γₖ₊₁);
+        if (not candidates.empty() && τ > 0) {
+            // Evaluate the step sizes τ, τ/2, τ/4, … in rounds of at most
+            // candidates.size(), in parallel, and accept the largest one that
+            // satisfies the line search condition. This results in the same
+            // step as the sequential line search below.
+            auto eval_candidate = [&](size_t i) {
+                auto &c = candidates[i];
+                c.Lₖ₊₁ = Lₖ;
+                c.γₖ₊₁ = γₖ;
+
+                // Calculate xₖ₊₁
+                if (c.τ / 2 < params.τ_min) { // line search failed
+                    c.xₖ₊₁ = x̂ₖ;              // → safe prox step
+                    c.ψₖ₊₁ = ψx̂ₖ;
+                    if (need_grad_̂ψₖ)
+                        c.grad_ψₖ₊₁ = grad_̂ψₖ;
+                    else
+                        detail::calc_grad_ψ_from_ŷ(problem, c.xₖ₊₁, ŷx̂ₖ,
+                                                   /* in ⟹ out */ c.grad_ψₖ₊₁,
+                                                   c.work_n);
+                } else {
+                    if (c.τ == 1) // → faster quasi-Newton step
+                        c.xₖ₊₁ = xₖ + qₖ;
+                    else
+                        c.xₖ₊₁ = xₖ + (1 - c.τ) * pₖ + c.τ * qₖ;
+                    // Calculate ψ(xₖ₊₁), ∇ψ(xₖ₊₁)
+                    c.ψₖ₊₁ = detail::calc_ψ_grad_ψ(
+                        problem, c.xₖ₊₁, y, Σ, /* in ⟹ out */ c.grad_ψₖ₊₁,
+                        c.work_n, c.work_m);
+                }
+
+                // Calculate x̂ₖ₊₁, pₖ₊₁ (projected gradient step in xₖ₊₁)
+                calc_x̂(c.γₖ₊₁, c.xₖ₊₁, c.grad_ψₖ₊₁, /* in ⟹ out */ c.x̂ₖ₊₁,
+                       c.pₖ₊₁, c.grad_ψₖ₊₁ᵀpₖ₊₁, c.pₖ₊₁ᵀpₖ₊₁);
+                // Calculate ψ(x̂ₖ₊₁) and ŷ(x̂ₖ₊₁)
+                // (not using the evaluation pool, each candidate already has
+                // its own thread)
+                c.ψx̂ₖ₊₁ = detail::calc_ψ_ŷ(problem, c.x̂ₖ₊₁, y, Σ,
+                                            /* in ⟹ out */ c.ŷx̂ₖ₊₁);
+
+                // Quadratic upper bound
+                real_t pₖ₊₁ᵀpₖ₊₁_ₖ = c.pₖ₊₁ᵀpₖ₊₁; // prox step with step size γₖ
+                if (params.update_lipschitz_in_linesearch == true)
+                    (void)descent_lemma(c.xₖ₊₁, c.ψₖ₊₁, c.grad_ψₖ₊₁,
+                                        /* in ⟹ out */ c.x̂ₖ₊₁, c.pₖ₊₁,
+                                        c.ŷx̂ₖ₊₁, /* inout */ c.ψx̂ₖ₊₁,
+                                        c.pₖ₊₁ᵀpₖ₊₁, c.grad_ψₖ₊₁ᵀpₖ₊₁, c.Lₖ₊₁,
+                                        c.γₖ₊₁, nullptr);
+
+                // Compute forward-backward envelope
+                c.φₖ₊₁ = c.ψₖ₊₁ + 1 / (2 * c.γₖ₊₁) * c.pₖ₊₁ᵀpₖ₊₁ +
+                         c.grad_ψₖ₊₁ᵀpₖ₊₁;
+                // Compute line search condition
+                c.ls_cond = c.φₖ₊₁ - (φₖ - σₖγₖ⁻¹pₖᵀpₖ);
+                if (params.alternative_linesearch_cond)
+                    c.ls_cond -= (0.5 / c.γₖ₊₁ - 0.5 / γₖ) * pₖ₊₁ᵀpₖ₊₁_ₖ;
+            };
+
+            std::optional<size_t> accepted;
+            while (not accepted) {
+                // Select the step sizes for this round, the last possible
+                // candidate is the prox step (τ / 2 < τ_min)
+                size_t num_candidates = 0;
+                bool prox             = false;
+                while (num_candidates < candidates.size() && not prox) {
+                    candidates[num_candidates++].τ = τ;
+                    prox = τ / 2 < params.τ_min;
+                    τ /= 2;
+                }
+                thread_pool.run(num_candidates, eval_candidate);
+                // Accept the largest step size that satisfies the condition
+                for (size_t i = 0; i < num_candidates; ++i) {
+                    const auto &c = candidates[i];
+                    if (not(c.ls_cond > margin) || c.τ / 2 < params.τ_min) {
+                        accepted = i;
+                        break;
+                    }
+                }
             }
-
-            // Compute forward-backward envelope
-            φₖ₊₁ = ψₖ₊₁ + 1 / (2 * γₖ₊₁) * pₖ₊₁ᵀpₖ₊₁ + grad_ψₖ₊₁ᵀpₖ₊₁;
-            // Compute line search condition
-            ls_cond = φₖ₊₁ - (φₖ - σₖγₖ⁻¹pₖᵀpₖ);
-            if (params.alternative_linesearch_cond)
-                ls_cond -= (0.5 / γₖ₊₁ - 0.5 / γₖ) * pₖ₊₁ᵀpₖ₊₁_ₖ;
-
-            τ /= 2;
-        } while (ls_cond > margin && τ >= params.τ_min);
+            auto &c = candidates[*accepted];
+            xₖ₊₁.swap(c.xₖ₊₁);
+            x̂ₖ₊₁.swap(c.x̂ₖ₊₁);
+            ŷx̂ₖ₊₁.swap(c.ŷx̂ₖ₊₁);
+            pₖ₊₁.swap(c.pₖ₊₁);
+            grad_ψₖ₊₁.swap(c.grad_ψₖ₊₁);
+            τ              = c.τ / 2;
+            Lₖ₊₁           = c.Lₖ₊₁;
+            γₖ₊₁           = c.γₖ₊₁;
+            ψₖ₊₁           = c.ψₖ₊₁;
+            ψx̂ₖ₊₁          = c.ψx̂ₖ₊₁;
+            φₖ₊₁           = c.φₖ₊₁;
+            grad_ψₖ₊₁ᵀpₖ₊₁ = c.grad_ψₖ₊₁ᵀpₖ₊₁;
+            pₖ₊₁ᵀpₖ₊₁      = c.pₖ₊₁ᵀpₖ₊₁;
+            ls_cond        = c.ls_cond;
+        } else {
+            do {
+                Lₖ₊₁ = Lₖ;
+                γₖ₊₁ = γₖ;
+
+                // Calculate xₖ₊₁
+                if (τ / 2 < params.τ_min) { // line search failed
+                    xₖ₊₁.swap(x̂ₖ);          // → safe prox step
+                    ψₖ₊₁ = ψx̂ₖ;
+                    if (need_grad_̂ψₖ)
+                        grad_ψₖ₊₁.swap(grad_̂ψₖ);
+                    else
+                        calc_grad_ψ_from_ŷ(xₖ₊₁, ŷx̂ₖ, /* in ⟹ out */ grad_ψₖ₊₁);
+                } else {        // line search didn't fail (yet)
+                    if (τ == 1) // → faster quasi-Newton step
+                        xₖ₊₁ = xₖ + qₖ;
+                    else
+                        xₖ₊₁ = xₖ + (1 - τ) * pₖ + τ * qₖ;
+                    // Calculate ψ(xₖ₊₁), ∇ψ(xₖ₊₁)
+                    ψₖ₊₁ = calc_ψ_grad_ψ(xₖ₊₁, /* in ⟹ out */ grad_ψₖ₊₁);
+                }
+
+                // Calculate x̂ₖ₊₁, pₖ₊₁ (projected gradient step in xₖ₊₁)
+                calc_x̂(γₖ₊₁, xₖ₊₁, grad_ψₖ₊₁, /* in ⟹ out */ x̂ₖ₊₁, pₖ₊₁,
+                       grad_ψₖ₊₁ᵀpₖ₊₁, pₖ₊₁ᵀpₖ₊₁);
+                // Calculate ψ(x̂ₖ₊₁) and ŷ(x̂ₖ₊₁)
+                ψx̂ₖ₊₁ = calc_ψ_ŷ(x̂ₖ₊₁, /* in ⟹ out */ ŷx̂ₖ₊₁);
+
+                // Quadratic upper bound -------------------------------------------
+                real_t pₖ₊₁ᵀpₖ₊₁_ₖ = pₖ₊₁ᵀpₖ₊₁; // prox step with step size γₖ
+
+                if (params.update_lipschitz_in_linesearch == true) {
+                    // Decrease step size until quadratic upper bound is satisfied
+                    (void)descent_lemma(xₖ₊₁, ψₖ₊₁, grad_ψₖ₊₁,
+                                        /* in ⟹ out */ x̂ₖ₊₁, pₖ₊₁, ŷx̂ₖ₊₁,
+                                        /* inout */ ψx̂ₖ₊₁, pₖ₊₁ᵀpₖ₊₁,
+                                        grad_ψₖ₊₁ᵀpₖ₊₁, Lₖ₊₁, γₖ₊₁, pool);
+                }
+
+                // Compute forward-backward envelope
+                φₖ₊₁ = ψₖ₊₁ + 1 / (2 * γₖ₊₁) * pₖ₊₁ᵀpₖ₊₁ + grad_ψₖ₊₁ᵀpₖ₊₁;
+                // Compute line search condition
+                ls_cond = φₖ₊₁ - (φₖ - σₖγₖ⁻¹pₖᵀpₖ);
+                if (params.alternative_linesearch_cond)
+                    ls_cond -= (0.5 / γₖ₊₁ - 0.5 / γₖ) * pₖ₊₁ᵀpₖ₊₁_ₖ;
+
+                τ /= 2;
+            } while (ls_cond > margin && τ >= params.τ_min);
+        }
 
         // If τ < τ_min the line search failed and we accepted the prox step
         if (τ < params.τ_min && k != 0) {
@@ -142,8 +142,9 @@ PGASolver::operator()(const Problem &problem,        // in
                                                   rvec grad_ψ) {
         detail::calc_grad_ψ_from_ŷ(problem, x, ŷ, grad_ψ, work_n);
     };
-    auto calc_x̂ = [&problem](real_t γ, crvec x, crvec grad_ψ, rvec x̂, rvec p) {
-        detail::calc_x̂(problem, γ, x, grad_ψ, x̂, p);
+    auto calc_x̂ = [&problem](real_t γ, crvec x, crvec grad_ψ, rvec x̂, rvec p,
+                             real_t &grad_ψᵀp, real_t &pᵀp) {
+        detail::calc_x̂(problem.C, γ, x, grad_ψ, x̂, p, grad_ψᵀp, pᵀp);
     };
     auto calc_err_z = [&problem, &y, &Σ](crvec x̂, rvec err_z) {
         detail::calc_err_z(problem, x̂, y, Σ, err_z);
@@ -201,12 +202,10 @@ PGASolver::operator()(const Problem &problem,        // in
         // Quadratic upper bound -----------------------------------------------
 
         // Projected gradient step: x̂ₖ and pₖ
-        calc_x̂(γₖ, xₖ, grad_ψₖ, /* in ⟹ out */ x̂ₖ, pₖ);
+        real_t grad_ψₖᵀpₖ, pₖᵀpₖ;
+        calc_x̂(γₖ, xₖ, grad_ψₖ, /* in ⟹ out */ x̂ₖ, pₖ, grad_ψₖᵀpₖ, pₖᵀpₖ);
         // Calculate ψ(x̂ₖ) and ŷ(x̂ₖ)
         real_t ψx̂ₖ = calc_ψ_ŷ(x̂ₖ, /* in ⟹ out */ ŷₖ);
-        // Calculate ∇ψ(xₖ)ᵀpₖ and ‖pₖ‖²
-        real_t grad_ψₖᵀpₖ = grad_ψₖ.dot(pₖ);
-        real_t pₖᵀpₖ      = pₖ.squaredNorm();
 
         // Decrease step size until quadratic upper bound is satisfied
         descent_lemma(xₖ, ψₖ, grad_ψₖ, x̂ₖ, pₖ, ŷₖ, ψx̂ₖ, pₖᵀpₖ, grad_ψₖᵀpₖ, Lₖ,
@@ -218,7 +217,8 @@ PGASolver::operator()(const Problem &problem,        // in
         // Check stop condition ------------------------------------------------
 
         real_t εₖ = detail::calc_error_stop_crit(
-            problem.C, params.stop_crit, pₖ, γₖ, xₖ, x̂ₖ, ŷₖ, grad_ψₖ, grad_ψx̂ₖ);
+            problem.C, params.stop_crit, pₖ, pₖᵀpₖ, γₖ, xₖ, x̂ₖ, ŷₖ, grad_ψₖ,
+            grad_ψx̂ₖ);
 
         // Print progress
         if (params.print_interval != 0 && k % params.print_interval == 0)
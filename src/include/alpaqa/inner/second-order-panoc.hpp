@@ -9,8 +9,6 @@
 #include <iostream>
 #include <stdexcept>
 
-#include <Eigen/Cholesky>
-
 namespace alpaqa {
 
 using std::chrono::duration_cast;
@@ -38,39 +36,45 @@ inline SecondOrderPANOCSolver::Stats SecondOrderPANOCSolver::operator()(
     const auto n = problem.n;
     const auto m = problem.m;
 
-    // Allocate vectors, init L-BFGS -------------------------------------------
-
-    // TODO: the L-BFGS objects and vectors allocate on each iteration of ALM,
-    //       and there are more vectors than strictly necessary.
-
-    vec xₖ = x,   // Value of x at the beginning of the iteration
-        x̂ₖ(n),    // Value of x after a projected gradient step
-        xₖ₊₁(n),  // xₖ for next iteration
-        x̂ₖ₊₁(n),  // x̂ₖ for next iteration
-        ŷx̂ₖ(m),   // ŷ(x̂ₖ) = Σ (g(x̂ₖ) - ẑₖ)
-        ŷx̂ₖ₊₁(m), // ŷ(x̂ₖ) for next iteration
-        pₖ(n),    // Projected gradient step pₖ = x̂ₖ - xₖ
-        pₖ₊₁(n), // Projected gradient step pₖ₊₁ = x̂ₖ₊₁ - xₖ₊₁
-        qₖ(n),   // Newton step Hₖ pₖ
-        grad_ψₖ(n),   // ∇ψ(xₖ)
-        grad_̂ψₖ(n),   // ∇ψ(x̂ₖ)
-        grad_ψₖ₊₁(n); // ∇ψ(xₖ₊₁)
-
-    vec work_n(n), work_m(m);
-
-    mat H(n, n);    // Hessian of the (augmented) Lagrangian function and ψ
-    vec g(m),       // Value of the constraint function
-        grad_gi(n); // Gradient of one of the constraints
-
-    using indexvec  = std::vector<vec::Index>;
-    using bvec      = Eigen::Matrix<bool, Eigen::Dynamic, 1>;
-    bvec inactive_C = bvec::Zero(n);
+    // Allocate vectors --------------------------------------------------------
+
+    // The workspace is only reallocated when the problem dimensions change, so
+    // subsequent calls with the same problem (e.g. by ALM) don't allocate.
+    work.resize(n, m, params.matrix_free);
+
+    auto &xₖ = work.xₖ, &x̂ₖ = work.x̂ₖ, &xₖ₊₁ = work.xₖ₊₁, &x̂ₖ₊₁ = work.x̂ₖ₊₁,
+         &ŷx̂ₖ = work.ŷx̂ₖ, &ŷx̂ₖ₊₁ = work.ŷx̂ₖ₊₁, &pₖ = work.pₖ, &pₖ₊₁ = work.pₖ₊₁,
+         &qₖ = work.qₖ, &grad_ψₖ = work.grad_ψₖ, &grad_̂ψₖ = work.grad_̂ψₖ,
+         &grad_ψₖ₊₁ = work.grad_ψₖ₊₁;
+    auto &work_n = work.work_n, &work_m = work.work_m;
+    auto &H = work.H;
+    auto &g = work.g, &grad_gi = work.grad_gi;
+    auto &J = work.J, &K = work.K;
+    auto &qJ = work.qJ, &rhs = work.rhs;
+    auto &ldl = work.ldl;
+    auto &sparse_ldl = work.sparse_ldl;
+
+    // Use the sparse Hessian if the problem provides it, the sparsity pattern
+    // is analyzed only once
+    const bool use_sparse_hessian = not params.matrix_free &&
+                                    problem.hess_L_sparse &&
+                                    (problem.m == 0 || problem.jac_g);
+    if (use_sparse_hessian) {
+        if (work.hess.set_pattern(problem.hess_L_sparsity,
+                                  problem.jac_g_sparsity))
+            sparse_ldl.analyzePattern(work.hess.matrix());
+    } else if (not params.matrix_free) {
+        H.resize(n, n);
+    }
+    // Reuse the dense Hessian and update its factorization when the set of
+    // inactive indices changes
+    const bool reuse_hessian = not use_sparse_hessian &&
+                               not params.matrix_free &&
+                               params.hessian_update_interval > 1;
+    unsigned hessian_age = 0;
+    bool refresh_hessian = true;
 
-    indexvec J, K;
-    J.reserve(n);
-    K.reserve(n);
-    vec qJ(n); // Solution of Newton Hessian system
-    vec rhs(n);
+    xₖ = x;
 
     // Keep track of how many successive iterations didn't update the iterate
     unsigned no_progress = 0;
@@ -90,8 +94,9 @@ inline SecondOrderPANOCSolver::Stats SecondOrderPANOCSolver::operator()(
                                                   rvec grad_ψ) {
         detail::calc_grad_ψ_from_ŷ(problem, x, ŷ, grad_ψ, work_n);
     };
-    auto calc_x̂ = [&problem](real_t γ, crvec x, crvec grad_ψ, rvec x̂, rvec p) {
-        detail::calc_x̂(problem, γ, x, grad_ψ, x̂, p);
+    auto calc_x̂ = [&problem](real_t γ, crvec x, crvec grad_ψ, rvec x̂, rvec p,
+                             real_t &grad_ψᵀp, real_t &pᵀp) {
+        detail::calc_x̂(problem.C, γ, x, grad_ψ, x̂, p, grad_ψᵀp, pᵀp);
     };
     auto calc_err_z = [&problem, &y, &Σ](crvec x̂, rvec err_z) {
         detail::calc_err_z(problem, x̂, y, Σ, err_z);
@@ -139,11 +144,10 @@ inline SecondOrderPANOCSolver::Stats SecondOrderPANOCSolver::operator()(
     // First projected gradient step -------------------------------------------
 
     // Calculate x̂₀, p₀ (projected gradient step)
-    calc_x̂(γₖ, xₖ, grad_ψₖ, /* in ⟹ out */ x̂ₖ, pₖ);
+    real_t grad_ψₖᵀpₖ, pₖᵀpₖ;
+    calc_x̂(γₖ, xₖ, grad_ψₖ, /* in ⟹ out */ x̂ₖ, pₖ, grad_ψₖᵀpₖ, pₖᵀpₖ);
     // Calculate ψ(x̂ₖ) and ŷ(x̂ₖ)
     real_t ψx̂ₖ        = calc_ψ_ŷ(x̂ₖ, /* in ⟹ out */ ŷx̂ₖ);
-    real_t grad_ψₖᵀpₖ = grad_ψₖ.dot(pₖ);
-    real_t pₖᵀpₖ      = pₖ.squaredNorm();
     // Forward-backward envelope
     real_t φₖ;
 
@@ -164,7 +168,8 @@ inline SecondOrderPANOCSolver::Stats SecondOrderPANOCSolver::operator()(
 
         // Check stop condition ------------------------------------------------
         real_t εₖ = detail::calc_error_stop_crit(
-            problem.C, params.stop_crit, pₖ, γₖ, xₖ, x̂ₖ, ŷx̂ₖ, grad_ψₖ, grad_̂ψₖ);
+            problem.C, params.stop_crit, pₖ, pₖᵀpₖ, γₖ, xₖ, x̂ₖ, ŷx̂ₖ, grad_ψₖ,
+            grad_̂ψₖ);
 
         // Print progress
         if (params.print_interval != 0 && k % params.print_interval == 0)
@@ -185,8 +190,8 @@ inline SecondOrderPANOCSolver::Stats SecondOrderPANOCSolver::operator()(
                 stop_status == SolverStatus::Interrupted ||
                 always_overwrite_results) {
                 calc_err_z(x̂ₖ, /* in ⟹ out */ err_z);
-                x = std::move(x̂ₖ);
-                y = std::move(ŷx̂ₖ);
+                x = x̂ₖ;
+                y = ŷx̂ₖ;
             }
             s.iterations   = k;
             s.ε            = εₖ;
@@ -200,8 +205,20 @@ inline SecondOrderPANOCSolver::Stats SecondOrderPANOCSolver::operator()(
         // TODO: all of this is suboptimal and ugly :(
 
         // TODO: write helper lambda above
-        detail::calc_augmented_lagrangian_hessian(problem, xₖ, ŷx̂ₖ, y, Σ, g, H,
-                                                  grad_gi);
+        refresh_hessian |= hessian_age >= params.hessian_update_interval;
+        if (params.matrix_free) {
+            // The Hessian is only used through Hessian-vector products
+        } else if (use_sparse_hessian)
+            detail::calc_augmented_lagrangian_hessian(problem, xₖ, ŷx̂ₖ, y, Σ,
+                                                      g, work.hess, work.jac_g);
+        else if (not reuse_hessian)
+            detail::calc_augmented_lagrangian_hessian(
+                problem, xₖ, ŷx̂ₖ, y, Σ, g, H, grad_gi, work.jac_g);
+        else if (refresh_hessian) {
+            detail::calc_augmented_lagrangian_hessian(
+                problem, xₖ, ŷx̂ₖ, y, Σ, g, H, grad_gi, work.jac_g);
+            work.ldl_inactive.clear(); // factorization is out of date
+        }
 
         K.clear();
         J.clear();
@@ -217,30 +234,202 @@ inline SecondOrderPANOCSolver::Stats SecondOrderPANOCSolver::operator()(
         }
         qₖ                  = pₖ;
         bool newton_success = true;
-        if (not J.empty()) {
+        if (not J.empty() && params.matrix_free) {
+            auto &ŷxₖ = work.ŷxₖ, &M = work.cg_M;
+            // Evaluate the constraints and (if available) the Jacobian, which
+            // are used in all Hessian-vector products in this iteration
+            problem.g(xₖ, g);
+            ŷxₖ = g;
+            detail::calc_ŷ_dᵀŷ(problem, ŷxₖ, y, Σ);
+            auto is_active = [&](vec::Index i) {
+                real_t ζ = g(i) + y(i) / Σ(i);
+                return not(problem.D.lowerbound(i) < ζ &&
+                           ζ < problem.D.upperbound(i));
+            };
+            bool jac_evaluated = false;
+            if (problem.jac_g && m > 0 &&
+                (not problem.hess_ψ_prod || params.newton_cg.preconditioning)) {
+                work.jac_g.set_pattern(problem.jac_g_sparsity);
+                problem.jac_g(xₖ, work.jac_g.nonzeros);
+                work.jac_g.update();
+                jac_evaluated = true;
+            }
+            // Product of the Hessian of ψ with a vector, restricted to J
+            auto hess_ψ_prod = [&](crvec v, rvec Hv) {
+                detail::calc_augmented_lagrangian_hessian_prod(
+                    problem, xₖ, ŷxₖ, y, Σ, g, v, Hv, grad_gi,
+                    jac_evaluated ? &work.jac_g : nullptr);
+                for (auto k : K)
+                    Hv(k) = 0;
+            };
             // Compute right-hand side of 6.1c
-            vec::Index ri = 0;
-            for (auto j : J) {
-                real_t hess_q = 0;
+            work_n.setZero();
+            for (auto k : K)
+                work_n(k) = qₖ(k);
+            detail::calc_augmented_lagrangian_hessian_prod(
+                problem, xₖ, ŷxₖ, y, Σ, g, work_n, rhs, grad_gi,
+                jac_evaluated ? &work.jac_g : nullptr);
+            rhs = -grad_ψₖ - rhs;
+            for (auto k : K)
+                rhs(k) = 0;
+            // Jacobi preconditioner: the diagonal of the penalty term
+            // J_𝒜ᵀ Σ_𝒜 J_𝒜, plus the curvature of the Hessian of the Lagrangian
+            // along the right-hand side as an estimate of its diagonal
+            // elements (the penalty term is subtracted from the curvature of
+            // ψ, so it is only counted once)
+            NewtonCGParams cg_params = params.newton_cg;
+            cg_params.preconditioning &= jac_evaluated;
+            if (cg_params.preconditioning) {
+                hess_ψ_prod(rhs, work.cg_Hp);
+                real_t rHr = rhs.dot(work.cg_Hp);
+                M.setZero();
+                using It       = SparseJacobian::matrix_t::InnerIterator;
+                const auto &Jg = work.jac_g.matrix();
+                for (vec::Index i = 0; i < m; ++i) {
+                    if (not is_active(i))
+                        continue;
+                    real_t Jr = 0;
+                    for (It c(Jg, i); c; ++c) {
+                        M(c.col()) += Σ(i) * c.value() * c.value();
+                        Jr += c.value() * rhs(c.col());
+                    }
+                    rHr -= Σ(i) * Jr * Jr;
+                }
+                M.array() += rHr / rhs.squaredNorm();
                 for (auto k : K)
-                    hess_q += H(j, k) * qₖ(k);
-                rhs(ri++) = -grad_ψₖ(j) - hess_q;
+                    M(k) = 1;
+                cg_params.preconditioning =
+                    (M.array() > 0).all() && M.allFinite();
             }
-
-            // Permute H to get the xJxJ block in the top left
-            auto hess_Ljj = H.block(0, 0, J.size(), J.size());
-            vec::Index r  = 0;
-            for (auto rj : J) {
-                vec::Index c = 0;
-                for (auto cj : J) {
-                    hess_Ljj(r, c) = H(rj, cj);
-                    ++c;
+            auto cg_stats =
+                steihaug_cg(cg_params, hess_ψ_prod, rhs, M, work.cg_x,
+                            work.cg_r, work.cg_z, work.cg_p, work.cg_Hp);
+            s.cg_iterations += cg_stats.iterations;
+            for (auto j : J)
+                qₖ(j) = work.cg_x(j);
+        } else if (not J.empty() && use_sparse_hessian) {
+            // Compute right-hand side of 6.1c, the rows of the active indices
+            // are replaced by the identity, so their solution remains qₖ(K)
+            work_n.setZero();
+            for (auto k : K)
+                work_n(k) = qₖ(k);
+            rhs.noalias() =
+                work.hess.matrix().selfadjointView<Eigen::Upper>() * work_n;
+            rhs = -grad_ψₖ - rhs;
+            for (auto k : K)
+                rhs(k) = qₖ(k);
+            // Only the numerical factorization is needed, the symbolic
+            // analysis of the (fixed) sparsity pattern was done before
+            work.hess.eliminate(K);
+            sparse_ldl.factorize(work.hess.matrix());
+            ++s.factorizations;
+            if (sparse_ldl.info() == Eigen::Success &&
+                (sparse_ldl.vectorD().array() > 0).all())
+                qₖ = sparse_ldl.solve(rhs);
+            else
+                newton_success = false;
+        } else if (not J.empty() && reuse_hessian) {
+            // Compute right-hand side of 6.1c, as in the sparse case
+            work_n.setZero();
+            for (auto k : K)
+                work_n(k) = qₖ(k);
+            rhs.noalias() = H * work_n;
+            rhs = -grad_ψₖ - rhs;
+            for (auto k : K)
+                rhs(k) = qₖ(k);
+            // Factorize the full Hessian with the rows and columns of the
+            // active indices replaced by the identity
+            auto &H_red        = work.H_red;
+            auto &ldl_inactive = work.ldl_inactive;
+            auto refactorize = [&] {
+                H_red = H;
+                for (auto k : K) {
+                    H_red.row(k).setZero();
+                    H_red.col(k).setZero();
+                    H_red(k, k) = 1;
                 }
-                ++r;
+                ldl.compute(H_red);
+                ++s.factorizations;
+                ldl_inactive.assign(n, false);
+                for (auto j : J)
+                    ldl_inactive[j] = true;
+            };
+            // Count the number of indices that entered or left J since the
+            // last factorization
+            auto count_changes = [&] {
+                unsigned changes = 0;
+                for (auto j : J)
+                    changes += not ldl_inactive[j];
+                for (auto k : K)
+                    changes += ldl_inactive[k];
+                return changes;
+            };
+            // Changing row and column i from a to b is the symmetric rank-two
+            // update u eᵢᵀ + eᵢ uᵀ, with u = b - a (and uᵢ halved), which is
+            // applied as ½ (u + eᵢ)(u + eᵢ)ᵀ - ½ (u - eᵢ)(u - eᵢ)ᵀ
+            auto update_index = [&](vec::Index i, bool enter) {
+                real_t sign = enter ? 1 : -1;
+                for (vec::Index j = 0; j < n; ++j)
+                    work_n(j) = ldl_inactive[j] ? sign * H(j, i) : 0;
+                work_n(i) = sign * (H(i, i) - 1) / 2;
+                work_n(i) += 1;
+                ldl.rankUpdate(work_n, real_t(0.5));
+                work_n(i) -= 2;
+                ldl.rankUpdate(work_n, real_t(-0.5));
+                ldl_inactive[i] = enter;
+                ++s.factorization_updates;
+            };
+            auto is_positive = [&] {
+                return (ldl.vectorD().array() > 0).all();
+            };
+            // An empty set of inactive indices means that the Hessian changed
+            // since the last factorization
+            if (ldl_inactive.empty() ||
+                count_changes() > params.max_factorization_updates) {
+                refactorize();
+            } else {
+                for (auto j : J)
+                    if (not ldl_inactive[j])
+                        update_index(j, true);
+                for (auto k : K)
+                    if (ldl_inactive[k])
+                        update_index(k, false);
+                // Fall back to a new factorization if the updates broke down
+                if (not is_positive())
+                    refactorize();
             }
-            auto ldl = hess_Ljj.ldlt(); // TODO: does this allocate?
+            if (ldl.info() == Eigen::Success && is_positive())
+                qₖ = ldl.solve(rhs);
+            else
+                newton_success = false;
+        } else if (not J.empty()) {
+            // Compute right-hand side of 6.1c, as in the sparse case
+            work_n.setZero();
+            for (auto k : K)
+                work_n(k) = qₖ(k);
+            rhs.noalias() = H * work_n;
+            rhs = -grad_ψₖ - rhs;
+            for (auto k : K)
+                rhs(k) = qₖ(k);
+            // Factorize the full Hessian with the rows and columns of the
+            // active indices replaced by the identity rather than the block
+            // H(J, J) itself: its size doesn't change, so the factorization
+            // doesn't allocate, and the identity block doesn't change whether
+            // the matrix is positive (semi)definite
+            auto &H_red = work.H_red;
+            H_red       = H;
+            for (auto k : K) {
+                H_red.row(k).setZero();
+                H_red.col(k).setZero();
+                H_red(k, k) = 1;
+            }
+            ldl.compute(H_red);
+            ++s.factorizations;
             if (ldl.isPositive()) {
-                qJ.topRows(J.size()) = ldl.solve(rhs.topRows(J.size()));
+                work_n       = ldl.solve(rhs);
+                vec::Index r = 0;
+                for (auto j : J)
+                    qJ(r++) = work_n(j);
             } else {
                 std::cerr << "\x1b[0;31m"
                              "not PD"
@@ -249,7 +438,7 @@ inline SecondOrderPANOCSolver::Stats SecondOrderPANOCSolver::operator()(
                 // newton_success = false; // TODO
             }
 
-            r = 0;
+            vec::Index r = 0;
             for (auto j : J)
                 qₖ(j) = qJ(r++);
         }
@@ -266,6 +455,12 @@ inline SecondOrderPANOCSolver::Stats SecondOrderPANOCSolver::operator()(
             τ = 0;
             ++s.newton_failures;
         }
+        if (reuse_hessian) {
+            // The Hessian is evaluated again at the latest when it's too old,
+            // or earlier if it doesn't result in a useful Newton step
+            hessian_age     = refresh_hessian ? 1 : hessian_age + 1;
+            refresh_hessian = τ == 0;
+        }
 
         // Line search loop ----------------------------------------------------
         do {
@@ -287,13 +482,12 @@ inline SecondOrderPANOCSolver::Stats SecondOrderPANOCSolver::operator()(
             }
 
             // Calculate x̂ₖ₊₁, pₖ₊₁ (projected gradient step in xₖ₊₁)
-            calc_x̂(γₖ₊₁, xₖ₊₁, grad_ψₖ₊₁, /* in ⟹ out */ x̂ₖ₊₁, pₖ₊₁);
+            calc_x̂(γₖ₊₁, xₖ₊₁, grad_ψₖ₊₁, /* in ⟹ out */ x̂ₖ₊₁, pₖ₊₁,
+                   grad_ψₖ₊₁ᵀpₖ₊₁, pₖ₊₁ᵀpₖ₊₁);
             // Calculate ψ(x̂ₖ₊₁) and ŷ(x̂ₖ₊₁)
             ψx̂ₖ₊₁ = calc_ψ_ŷ(x̂ₖ₊₁, /* in ⟹ out */ ŷx̂ₖ₊₁);
 
             // Quadratic upper bound -------------------------------------------
-            grad_ψₖ₊₁ᵀpₖ₊₁ = grad_ψₖ₊₁.dot(pₖ₊₁);
-            pₖ₊₁ᵀpₖ₊₁      = pₖ₊₁.squaredNorm();
             real_t pₖ₊₁ᵀpₖ₊₁_ₖ = pₖ₊₁ᵀpₖ₊₁; // prox step with step size γₖ
 
             if (params.update_lipschitz_in_linesearch == true) {
@@ -318,6 +512,7 @@ inline SecondOrderPANOCSolver::Stats SecondOrderPANOCSolver::operator()(
         if (τ < params.τ_min && k != 0) {
             ++s.linesearch_failures;
             τ = 0;
+            refresh_hessian = reuse_hessian;
         }
         if (k != 0) {
             s.count_τ += 1;
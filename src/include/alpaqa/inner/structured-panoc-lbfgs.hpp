@@ -39,33 +39,25 @@ inline StructuredPANOCLBFGSSolver::Stats StructuredPANOCLBFGSSolver::operator()(
 
     // Allocate vectors, init L-BFGS -------------------------------------------
 
-    // TODO: the L-BFGS objects and vectors allocate on each iteration of ALM,
-    //       and there are more vectors than strictly necessary.
-
+    // The workspace and L-BFGS storage are only reallocated when the problem
+    // dimensions change, so subsequent calls with the same problem (e.g. by
+    // ALM) don't allocate.
     bool need_grad_̂ψₖ = detail::stop_crit_requires_grad_̂ψₖ(params.stop_crit);
-
-    vec xₖ = x,   // Value of x at the beginning of the iteration
-        x̂ₖ(n),    // Value of x after a projected gradient step
-        xₖ₊₁(n),  // xₖ for next iteration
-        x̂ₖ₊₁(n),  // x̂ₖ for next iteration
-        ŷx̂ₖ(m),   // ŷ(x̂ₖ) = Σ (g(x̂ₖ) - ẑₖ)
-        ŷx̂ₖ₊₁(m), // ŷ(x̂ₖ) for next iteration
-        pₖ(n),    // Projected gradient step pₖ = x̂ₖ - xₖ
-        pₖ₊₁(n), // Projected gradient step pₖ₊₁ = x̂ₖ₊₁ - xₖ₊₁
-        qₖ(n),   // Newton step Hₖ pₖ
-        grad_ψₖ(n),                    // ∇ψ(xₖ)
-        grad_̂ψₖ(need_grad_̂ψₖ ? n : 0), // ∇ψ(x̂ₖ)
-        grad_ψₖ₊₁(n);                  // ∇ψ(xₖ₊₁)
-
-    vec work_n(n), work_m(m);
-
-    vec work_n2(n);
-    vec HqK(n);
-
-    using indexvec = std::vector<vec::Index>;
-    indexvec J;
-    J.reserve(n);
-    lbfgs.resize(n);
+    work.resize(n, m, need_grad_̂ψₖ);
+
+    auto &xₖ = work.xₖ, &x̂ₖ = work.x̂ₖ, &xₖ₊₁ = work.xₖ₊₁, &x̂ₖ₊₁ = work.x̂ₖ₊₁,
+         &ŷx̂ₖ = work.ŷx̂ₖ, &ŷx̂ₖ₊₁ = work.ŷx̂ₖ₊₁, &pₖ = work.pₖ, &pₖ₊₁ = work.pₖ₊₁,
+         &qₖ = work.qₖ, &grad_ψₖ = work.grad_ψₖ, &grad_̂ψₖ = work.grad_̂ψₖ,
+         &grad_ψₖ₊₁ = work.grad_ψₖ₊₁;
+    auto &work_n = work.work_n, &work_n2 = work.work_n2, &work_m = work.work_m;
+    auto &HqK = work.HqK;
+    auto &J   = work.J;
+
+    xₖ = x;
+    if (lbfgs.n() != n)
+        lbfgs.resize(n);
+    else
+        lbfgs.reset();
 
     // Keep track of how many successive iterations didn't update the iterate
     unsigned no_progress   = 0;
@@ -86,8 +78,9 @@ inline StructuredPANOCLBFGSSolver::Stats StructuredPANOCLBFGSSolver::operator()(
                                                   rvec grad_ψ) {
         detail::calc_grad_ψ_from_ŷ(problem, x, ŷ, grad_ψ, work_n);
     };
-    auto calc_x̂ = [&problem](real_t γ, crvec x, crvec grad_ψ, rvec x̂, rvec p) {
-        detail::calc_x̂(problem, γ, x, grad_ψ, x̂, p);
+    auto calc_x̂ = [&problem](real_t γ, crvec x, crvec grad_ψ, rvec x̂, rvec p,
+                             real_t &grad_ψᵀp, real_t &pᵀp) {
+        detail::calc_x̂(problem.C, γ, x, grad_ψ, x̂, p, grad_ψᵀp, pᵀp);
     };
     auto calc_err_z = [&problem, &y, &Σ](crvec x̂, rvec err_z) {
         detail::calc_err_z(problem, x̂, y, Σ, err_z);
@@ -136,11 +129,10 @@ inline StructuredPANOCLBFGSSolver::Stats StructuredPANOCLBFGSSolver::operator()(
     // First projected gradient step -------------------------------------------
 
     // Calculate x̂₀, p₀ (projected gradient step)
-    calc_x̂(γₖ, xₖ, grad_ψₖ, /* in ⟹ out */ x̂ₖ, pₖ);
+    real_t grad_ψₖᵀpₖ, pₖᵀpₖ;
+    calc_x̂(γₖ, xₖ, grad_ψₖ, /* in ⟹ out */ x̂ₖ, pₖ, grad_ψₖᵀpₖ, pₖᵀpₖ);
     // Calculate ψ(x̂ₖ) and ŷ(x̂ₖ)
     real_t ψx̂ₖ        = calc_ψ_ŷ(x̂ₖ, /* in ⟹ out */ ŷx̂ₖ);
-    real_t grad_ψₖᵀpₖ = grad_ψₖ.dot(pₖ);
-    real_t pₖᵀpₖ      = pₖ.squaredNorm();
     // Compute forward-backward envelope
     real_t φₖ   = ψₖ + 1 / (2 * γₖ) * pₖᵀpₖ + grad_ψₖᵀpₖ;
     real_t nmΦₖ = φₖ;
@@ -165,10 +157,9 @@ inline StructuredPANOCLBFGSSolver::Stats StructuredPANOCLBFGSSolver::operator()(
                 Lₖ₊₁ = std::clamp(Lₖ₊₁, params.L_min, params.L_max);
                 real_t γₖ₊₁ = params.Lipschitz.Lγ_factor / Lₖ₊₁;
                 // Calculate x̂ₖ, pₖ (projected gradient step)
-                calc_x̂(γₖ₊₁, xₖ, grad_ψₖ, /* in ⟹ out */ x̂ₖ₊₁, pₖ₊₁);
-                // Calculate ∇ψ(xₖ)ᵀpₖ and ‖pₖ‖²
-                real_t grad_ψₖ₊₁ᵀpₖ₊₁ = grad_ψₖ.dot(pₖ₊₁);
-                real_t pₖ₊₁ᵀpₖ₊₁      = pₖ₊₁.squaredNorm();
+                real_t grad_ψₖ₊₁ᵀpₖ₊₁, pₖ₊₁ᵀpₖ₊₁;
+                calc_x̂(γₖ₊₁, xₖ, grad_ψₖ, /* in ⟹ out */ x̂ₖ₊₁, pₖ₊₁,
+                       grad_ψₖ₊₁ᵀpₖ₊₁, pₖ₊₁ᵀpₖ₊₁);
                 // Calculate ψ(x̂ₖ) and ŷ(x̂ₖ)
                 real_t ψx̂ₖ₊₁ = calc_ψ_ŷ(x̂ₖ₊₁, /* in ⟹ out */ ŷx̂ₖ₊₁);
                 // Check quadratic upper bound
@@ -219,7 +210,8 @@ inline StructuredPANOCLBFGSSolver::Stats StructuredPANOCLBFGSSolver::operator()(
 
         // Check stop condition ------------------------------------------------
         real_t εₖ = detail::calc_error_stop_crit(
-            problem.C, params.stop_crit, pₖ, γₖ, xₖ, x̂ₖ, ŷx̂ₖ, grad_ψₖ, grad_̂ψₖ);
+            problem.C, params.stop_crit, pₖ, pₖᵀpₖ, γₖ, xₖ, x̂ₖ, ŷx̂ₖ, grad_ψₖ,
+            grad_̂ψₖ);
 
         // Print progress
         if (params.print_interval != 0 && k % params.print_interval == 0)
@@ -240,8 +232,8 @@ inline StructuredPANOCLBFGSSolver::Stats StructuredPANOCLBFGSSolver::operator()(
                 stop_status == SolverStatus::Interrupted ||
                 always_overwrite_results) {
                 calc_err_z(x̂ₖ, /* in ⟹ out */ err_z);
-                x = std::move(x̂ₖ);
-                y = std::move(ŷx̂ₖ);
+                x = x̂ₖ;
+                y = ŷx̂ₖ;
             }
             s.iterations   = k;
             s.ε            = εₖ;
@@ -271,7 +263,9 @@ inline StructuredPANOCLBFGSSolver::Stats StructuredPANOCLBFGSSolver::operator()(
                 if (J.size() == n) { // There are no active indices K
                     qₖ = -grad_ψₖ;
                 } else if (params.hessian_vec) { // There are active indices K
-                    if (params.hessian_vec_finite_differences) {
+                    if (params.full_augmented_hessian && problem.hess_ψ_prod) {
+                        problem.hess_ψ_prod(xₖ, y, Σ, problem.D, qₖ, HqK);
+                    } else if (params.hessian_vec_finite_differences) {
                         detail::calc_augmented_lagrangian_hessian_prod_fd(
                             problem, xₖ, y, Σ, grad_ψₖ, qₖ, HqK, work_n,
                             work_n2, work_m);
@@ -370,13 +364,12 @@ inline StructuredPANOCLBFGSSolver::Stats StructuredPANOCLBFGSSolver::operator()(
             }
 
             // Calculate x̂ₖ₊₁, pₖ₊₁ (projected gradient step in xₖ₊₁)
-            calc_x̂(γₖ₊₁, xₖ₊₁, grad_ψₖ₊₁, /* in ⟹ out */ x̂ₖ₊₁, pₖ₊₁);
+            calc_x̂(γₖ₊₁, xₖ₊₁, grad_ψₖ₊₁, /* in ⟹ out */ x̂ₖ₊₁, pₖ₊₁,
+                   grad_ψₖ₊₁ᵀpₖ₊₁, pₖ₊₁ᵀpₖ₊₁);
             // Calculate ψ(x̂ₖ₊₁) and ŷ(x̂ₖ₊₁)
             ψx̂ₖ₊₁ = calc_ψ_ŷ(x̂ₖ₊₁, /* in ⟹ out */ ŷx̂ₖ₊₁);
 
             // Quadratic upper bound -------------------------------------------
-            grad_ψₖ₊₁ᵀpₖ₊₁ = grad_ψₖ₊₁.dot(pₖ₊₁);
-            pₖ₊₁ᵀpₖ₊₁      = pₖ₊₁.squaredNorm();
             real_t pₖ₊₁ᵀpₖ₊₁_ₖ = pₖ₊₁ᵀpₖ₊₁; // prox step with step size γₖ
 
             if (params.update_lipschitz_in_linesearch == true) {
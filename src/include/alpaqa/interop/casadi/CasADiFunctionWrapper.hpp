@@ -2,6 +2,7 @@
 
 #include <casadi/core/function.hpp>
 
+#include <alpaqa/util/sparsity.hpp>
 #include <alpaqa/util/vec.hpp>
 
 #include <stdexcept>
@@ -35,9 +36,10 @@ class CasADiFunctionEvaluator {
                              const casadi_dim (&dim_out)[N_out]) {
         using std::operator""s;
         constexpr static const char *count[]{"first", "second", "third",
-                                             "fourth"};
-        static_assert(N_in <= 4);
-        static_assert(N_out <= 4);
+                                             "fourth", "fifth", "sixth",
+                                             "seventh"};
+        static_assert(N_in <= 7);
+        static_assert(N_out <= 7);
         auto to_string = [](casadi_dim d) {
             return "(" + std::to_string(d.first) + ", " +
                    std::to_string(d.second) + ")";
@@ -230,4 +232,250 @@ class CasADiFun_4Vi1Vo {
     CasADiFunctionEvaluator<4, 1> fun;
 };
 
+/// Convert a CasADi sparsity pattern (compressed column storage) to the
+/// coordinate format, in the order of CasADi's nonzero elements.
+inline alpaqa::SparsityPattern
+to_sparsity_pattern(const casadi::Sparsity &sp) {
+    alpaqa::SparsityPattern result;
+    result.rows = sp.size1();
+    result.cols = sp.size2();
+    result.row.reserve(sp.nnz());
+    result.col.reserve(sp.nnz());
+    const casadi_int *colind = sp.colind(), *row = sp.row();
+    for (casadi_int c = 0; c < sp.size2(); ++c) {
+        for (casadi_int k = colind[c]; k < colind[c + 1]; ++k) {
+            result.row.push_back(row[k]);
+            result.col.push_back(c);
+        }
+    }
+    return result;
+}
+
+/// Wrapper for CasADiFunctionEvaluator with 1 vector input, 1 sparse matrix
+/// output (only the nonzero elements are written).
+class CasADiFun_1Vi1SMo {
+  public:
+    CasADiFun_1Vi1SMo(casadi::Function &&f, casadi_int dim_in = 0,
+                      CasADiFunctionEvaluator<1, 1>::casadi_dim dim_out = {0,
+                                                                           0})
+        : fun(std::move(f), {{dim_in, 1}}, {dim_out}) {}
+
+    void operator()(alpaqa::crvec in, alpaqa::rvec out_nonzeros) const {
+        fun({in.data()}, {out_nonzeros.data()});
+    }
+
+    alpaqa::SparsityPattern sparsity_out() const {
+        return to_sparsity_pattern(fun.fun.sparsity_out(0));
+    }
+
+  private:
+    CasADiFunctionEvaluator<1, 1> fun;
+};
+
+/// Wrapper for CasADiFunctionEvaluator with 2 vector inputs, 1 sparse matrix
+/// output (only the nonzero elements are written).
+class CasADiFun_2Vi1SMo {
+  public:
+    CasADiFun_2Vi1SMo(casadi::Function &&f,
+                      const std::array<casadi_int, 2> &dim_in           = {},
+                      CasADiFunctionEvaluator<2, 1>::casadi_dim dim_out = {0,
+                                                                           0})
+        : fun(std::move(f), {{dim_in[0], 1}, {dim_in[1], 1}}, {dim_out}) {}
+
+    void operator()(alpaqa::crvec in1, alpaqa::crvec in2,
+                    alpaqa::rvec out_nonzeros) const {
+        fun({in1.data(), in2.data()}, {out_nonzeros.data()});
+    }
+
+    alpaqa::SparsityPattern sparsity_out() const {
+        return to_sparsity_pattern(fun.fun.sparsity_out(0));
+    }
+
+  private:
+    CasADiFunctionEvaluator<2, 1> fun;
+};
+
+/// Wrapper for CasADiFunctionEvaluator with 6 vector inputs, 1 vector output.
+class CasADiFun_6Vi1Vo {
+  public:
+    CasADiFun_6Vi1Vo(casadi::Function &&f,
+                     const std::array<casadi_int, 6> &dim_in = {},
+                     casadi_int dim_out                      = 0)
+        : fun(std::move(f),
+              {
+                  {dim_in[0], 1},
+                  {dim_in[1], 1},
+                  {dim_in[2], 1},
+                  {dim_in[3], 1},
+                  {dim_in[4], 1},
+                  {dim_in[5], 1},
+              },
+              {{dim_out, 1}}) {}
+
+    void operator()(alpaqa::crvec in1, alpaqa::crvec in2, alpaqa::crvec in3,
+                    alpaqa::crvec in4, alpaqa::crvec in5, alpaqa::crvec in6,
+                    alpaqa::rvec out) const {
+        fun({in1.data(), in2.data(), in3.data(), in4.data(), in5.data(),
+             in6.data()},
+            {out.data()});
+    }
+
+  private:
+    CasADiFunctionEvaluator<6, 1> fun;
+};
+
+/// Wrapper for CasADiFunctionEvaluator with 7 vector inputs, 1 vector output.
+class CasADiFun_7Vi1Vo {
+  public:
+    CasADiFun_7Vi1Vo(casadi::Function &&f,
+                     const std::array<casadi_int, 7> &dim_in = {},
+                     casadi_int dim_out                      = 0)
+        : fun(std::move(f),
+              {
+                  {dim_in[0], 1},
+                  {dim_in[1], 1},
+                  {dim_in[2], 1},
+                  {dim_in[3], 1},
+                  {dim_in[4], 1},
+                  {dim_in[5], 1},
+                  {dim_in[6], 1},
+              },
+              {{dim_out, 1}}) {}
+
+    void operator()(alpaqa::crvec in1, alpaqa::crvec in2, alpaqa::crvec in3,
+                    alpaqa::crvec in4, alpaqa::crvec in5, alpaqa::crvec in6,
+                    alpaqa::crvec in7, alpaqa::rvec out) const {
+        fun({in1.data(), in2.data(), in3.data(), in4.data(), in5.data(),
+             in6.data(), in7.data()},
+            {out.data()});
+    }
+
+  private:
+    CasADiFunctionEvaluator<7, 1> fun;
+};
+
+/// Wrapper for CasADiFunctionEvaluator with 5 vector inputs, 1 scalar output
+/// and 1 vector output.
+class CasADiFun_5Vi1So1Vo {
+  public:
+    CasADiFun_5Vi1So1Vo(casadi::Function &&f,
+                        const std::array<casadi_int, 5> &dim_in = {},
+                        casadi_int dim_out                      = 0)
+        : fun(std::move(f),
+              {
+                  {dim_in[0], 1},
+                  {dim_in[1], 1},
+                  {dim_in[2], 1},
+                  {dim_in[3], 1},
+                  {dim_in[4], 1},
+              },
+              {{1, 1}, {dim_out, 1}}) {}
+
+    double operator()(alpaqa::crvec in1, alpaqa::crvec in2, alpaqa::crvec in3,
+                      alpaqa::crvec in4, alpaqa::crvec in5,
+                      alpaqa::rvec out2) const {
+        double out1;
+        fun({in1.data(), in2.data(), in3.data(), in4.data(), in5.data()},
+            {&out1, out2.data()});
+        return out1;
+    }
+
+  private:
+    CasADiFunctionEvaluator<5, 2> fun;
+};
+
+/// Wrapper for CasADiFunctionEvaluator with 6 vector inputs, 1 scalar output
+/// and 1 vector output.
+class CasADiFun_6Vi1So1Vo {
+  public:
+    CasADiFun_6Vi1So1Vo(casadi::Function &&f,
+                        const std::array<casadi_int, 6> &dim_in = {},
+                        casadi_int dim_out                      = 0)
+        : fun(std::move(f),
+              {
+                  {dim_in[0], 1},
+                  {dim_in[1], 1},
+                  {dim_in[2], 1},
+                  {dim_in[3], 1},
+                  {dim_in[4], 1},
+                  {dim_in[5], 1},
+              },
+              {{1, 1}, {dim_out, 1}}) {}
+
+    double operator()(alpaqa::crvec in1, alpaqa::crvec in2, alpaqa::crvec in3,
+                      alpaqa::crvec in4, alpaqa::crvec in5, alpaqa::crvec in6,
+                      alpaqa::rvec out2) const {
+        double out1;
+        fun({in1.data(), in2.data(), in3.data(), in4.data(), in5.data(),
+             in6.data()},
+            {&out1, out2.data()});
+        return out1;
+    }
+
+  private:
+    CasADiFunctionEvaluator<6, 2> fun;
+};
+
+/// Wrapper for CasADiFunctionEvaluator with 5 vector inputs, 1 scalar output
+/// and 2 vector outputs.
+class CasADiFun_5Vi1So2Vo {
+  public:
+    CasADiFun_5Vi1So2Vo(casadi::Function &&f,
+                        const std::array<casadi_int, 5> &dim_in  = {},
+                        const std::array<casadi_int, 2> &dim_out = {})
+        : fun(std::move(f),
+              {
+                  {dim_in[0], 1},
+                  {dim_in[1], 1},
+                  {dim_in[2], 1},
+                  {dim_in[3], 1},
+                  {dim_in[4], 1},
+              },
+              {{1, 1}, {dim_out[0], 1}, {dim_out[1], 1}}) {}
+
+    double operator()(alpaqa::crvec in1, alpaqa::crvec in2, alpaqa::crvec in3,
+                      alpaqa::crvec in4, alpaqa::crvec in5, alpaqa::rvec out2,
+                      alpaqa::rvec out3) const {
+        double out1;
+        fun({in1.data(), in2.data(), in3.data(), in4.data(), in5.data()},
+            {&out1, out2.data(), out3.data()});
+        return out1;
+    }
+
+  private:
+    CasADiFunctionEvaluator<5, 3> fun;
+};
+
+/// Wrapper for CasADiFunctionEvaluator with 6 vector inputs, 1 scalar output
+/// and 2 vector outputs.
+class CasADiFun_6Vi1So2Vo {
+  public:
+    CasADiFun_6Vi1So2Vo(casadi::Function &&f,
+                        const std::array<casadi_int, 6> &dim_in  = {},
+                        const std::array<casadi_int, 2> &dim_out = {})
+        : fun(std::move(f),
+              {
+                  {dim_in[0], 1},
+                  {dim_in[1], 1},
+                  {dim_in[2], 1},
+                  {dim_in[3], 1},
+                  {dim_in[4], 1},
+                  {dim_in[5], 1},
+              },
+              {{1, 1}, {dim_out[0], 1}, {dim_out[1], 1}}) {}
+
+    double operator()(alpaqa::crvec in1, alpaqa::crvec in2, alpaqa::crvec in3,
+                      alpaqa::crvec in4, alpaqa::crvec in5, alpaqa::crvec in6,
+                      alpaqa::rvec out2, alpaqa::rvec out3) const {
+        double out1;
+        fun({in1.data(), in2.data(), in3.data(), in4.data(), in5.data(),
+             in6.data()},
+            {&out1, out2.data(), out3.data()});
+        return out1;
+    }
+
+  private:
+    CasADiFunctionEvaluator<6, 3> fun;
+};
+
 /// @}
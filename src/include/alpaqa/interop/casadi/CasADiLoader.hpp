@@ -53,7 +53,18 @@ std::function<alpaqa::Problem::hess_L_prod_sig> load_CasADi_hessian_lagrangian_p
 /// the constraints, and the constraint gradient times a vector respecitvely.
 /// If @p second_order is true, additional functions `hess_L` and
 /// `hess_L_prod` should be provided to evaluate the Hessian of the Lagrangian
-/// and Hessian-vector products.
+/// and Hessian-vector products. If the file also contains the function
+/// `hess_psi_prod`, it is used for exact Hessian-vector products of the
+/// augmented Lagrangian (see @ref Problem::hess_ψ_prod).
+///
+/// If the file contains a function `jac_g`, it is used to evaluate the
+/// sparse Jacobian of the constraints (see @ref Problem::jac_g).
+/// If the file contains a function `psi_grad_psi`, it is used to evaluate the
+/// augmented Lagrangian @f$ \psi(x) @f$, its gradient and @f$ \hat y(x) @f$
+/// in a single call (see @ref Problem::ψ_grad_ψ). Similarly, a function `psi`
+/// evaluates only @f$ \psi(x) @f$ and @f$ \hat y(x) @f$ (see
+/// @ref Problem::ψ). The arguments of both functions are
+/// @f$ x @f$, @f$ y @f$, @f$ \Sigma @f$ and the bounds of @f$ D @f$.
 ///
 /// If any of the dimensions are zero, they are determined from the `g` function
 /// in the given file.
@@ -81,7 +92,19 @@ alpaqa::Problem load_CasADi_problem(const std::string &filename, unsigned n = 0,
 /// the constraints, and the constraint gradient times a vector respecitvely.
 /// If @p second_order is true, additional functions `hess_L` and
 /// `hess_L_prod` should be provided to evaluate the Hessian of the Lagrangian
-/// and Hessian-vector products.
+/// and Hessian-vector products. If the file also contains the function
+/// `hess_psi_prod`, it is used for exact Hessian-vector products of the
+/// augmented Lagrangian (see @ref Problem::hess_ψ_prod).
+///
+/// If the file contains a function `jac_g`, it is used to evaluate the
+/// sparse Jacobian of the constraints (see @ref Problem::jac_g).
+/// If the file contains a function `psi_grad_psi`, it is used to evaluate the
+/// augmented Lagrangian @f$ \psi(x) @f$, its gradient and @f$ \hat y(x) @f$
+/// in a single call (see @ref Problem::ψ_grad_ψ). Similarly, a function `psi`
+/// evaluates only @f$ \psi(x) @f$ and @f$ \hat y(x) @f$ (see
+/// @ref Problem::ψ). The arguments of both functions are
+/// @f$ x @f$, @f$ p @f$, @f$ y @f$, @f$ \Sigma @f$ and the bounds of
+/// @f$ D @f$.
 ///
 /// If any of the dimensions are zero, they are determined from the `g` function
 /// in the given file.
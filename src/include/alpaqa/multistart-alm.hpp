@@ -0,0 +1,177 @@
+#pragma once
+
+#include <alpaqa/alm.hpp>
+#include <alpaqa/decl/multistart-alm.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <exception>
+#include <random>
+#include <thread>
+
+namespace alpaqa {
+
+template <class InnerSolverT>
+template <class ProblemT>
+typename MultiStartALMSolver<InnerSolverT>::Stats
+MultiStartALMSolver<InnerSolverT>::operator()(const ProblemT &problem,
+                                              crmat x₀, rvec y, rvec x) {
+    const auto K = static_cast<size_t>(x₀.cols());
+    assert(x₀.rows() == problem.n && x.size() == problem.n);
+    assert(y.size() == problem.m);
+    Stats s;
+    s.runs.resize(K);
+    s.objective = vec::Constant(K, NaN);
+    s.dominated.resize(K);
+    if (K == 0)
+        return s;
+
+    size_t num_threads = params.num_threads;
+    if (num_threads == 0)
+        num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    num_threads = std::min(num_threads, K);
+
+    {
+        std::lock_guard<std::mutex> lck{runs_mtx};
+        runs.clear();
+        runs.reserve(K);
+        for (size_t i = 0; i < K; ++i)
+            runs.emplace_back(solver);
+    }
+    mat X = x₀, Y = y.replicate(1, K);
+    // Not a std::vector<bool>, because its elements are written concurrently
+    std::vector<unsigned char> dominated(K);
+
+    // Best objective of all converged runs so far
+    std::atomic<real_t> incumbent{inf};
+    std::atomic<bool> done{false}, failed{false};
+    std::atomic<size_t> next_run{0};
+    std::exception_ptr first_error;
+    std::mutex error_mtx;
+
+    auto is_dominated = [&](real_t f) {
+        real_t f_inc = incumbent.load(std::memory_order_relaxed);
+        return f > f_inc + params.dominance_tolerance * (1 + std::abs(f_inc));
+    };
+    auto update_incumbent = [&](real_t f) {
+        real_t f_inc = incumbent.load();
+        while (f < f_inc && not incumbent.compare_exchange_weak(f_inc, f))
+            ;
+    };
+    auto stop_all = [&] {
+        std::lock_guard<std::mutex> lck{runs_mtx};
+        for (auto &r : runs)
+            r.stop();
+    };
+
+    // Periodically compare the current inner iterate to the incumbent, and
+    // cancel the run if it's clearly worse. The objective is evaluated using
+    // the worker's copy of the original problem, because the problem of the
+    // inner solver may be scaled by the preconditioning, the incumbent isn't.
+    auto install_dominance_check = [&](size_t i, const ProblemT &p) {
+        if (not(params.dominance_tolerance < inf))
+            return;
+        unsigned interval = std::max(params.dominance_check_interval, 1u);
+        auto check = [&, i, interval](const auto &info) {
+            if (info.k % interval != 0 || dominated[i])
+                return;
+            if (is_dominated(p.f(info.x_hat))) {
+                dominated[i] = true;
+                runs[i].stop();
+            }
+        };
+        runs[i].inner_solver.set_progress_callback(check);
+    };
+
+    auto work = [&] {
+        try {
+            // Every worker needs its own copy of the problem, because any
+            // internal state (e.g. the parameters of ProblemWithParam) is not
+            // shared
+            ProblemT p(problem);
+            size_t i;
+            while ((i = next_run++) < K) {
+                if (stop_signal.stop_requested() || done || failed) {
+                    s.runs[i].status = SolverStatus::Interrupted;
+                    continue;
+                }
+                install_dominance_check(i, p);
+                // Without a warm-start state, the copied inner solver doesn't
+                // continue from the last solve of the original solver
+                s.runs[i]      = runs[i](p, Y.col(i), X.col(i));
+                s.objective(i) = p.f(X.col(i));
+                if (s.runs[i].status != SolverStatus::Converged)
+                    continue;
+                update_incumbent(s.objective(i));
+                if (params.policy == MultiStartPolicy::FirstGoodEnough &&
+                    s.objective(i) <= params.good_enough_objective) {
+                    done = true;
+                    stop_all();
+                }
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lck{error_mtx};
+            if (not first_error)
+                first_error = std::current_exception();
+            failed = true;
+            stop_all();
+        }
+    };
+
+    // The calling thread acts as the first worker
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads - 1);
+    for (size_t w = 1; w < num_threads; ++w)
+        threads.emplace_back(work);
+    work();
+    for (auto &t : threads)
+        t.join();
+
+    {
+        std::lock_guard<std::mutex> lck{runs_mtx};
+        runs.clear();
+    }
+    if (first_error)
+        std::rethrow_exception(first_error);
+    std::copy(dominated.begin(), dominated.end(), s.dominated.begin());
+
+    // Return the converged run with the lowest objective
+    for (size_t i = 0; i < K; ++i)
+        if (s.runs[i].status == SolverStatus::Converged &&
+            (not s.best || s.objective(i) < s.objective(*s.best)))
+            s.best = i;
+    if (s.best) {
+        x = X.col(*s.best);
+        y = Y.col(*s.best);
+    }
+    return s;
+}
+
+template <class InnerSolverT>
+mat MultiStartALMSolver<InnerSolverT>::perturbed_starts(crvec x₀,
+                                                        const Box &C,
+                                                        unsigned num_starts,
+                                                        real_t σ,
+                                                        unsigned seed) {
+    std::mt19937 rng{seed};
+    std::normal_distribution<real_t> noise{0, σ};
+    mat starts = x₀.replicate(1, num_starts);
+    vec perturbation(x₀.size());
+    for (unsigned i = 1; i < num_starts; ++i) {
+        for (Eigen::Index j = 0; j < perturbation.size(); ++j)
+            perturbation(j) = noise(rng);
+        starts.col(i) = project(x₀ + perturbation, C);
+    }
+    return starts;
+}
+
+template <class InnerSolverT>
+void MultiStartALMSolver<InnerSolverT>::stop() {
+    stop_signal.stop();
+    std::lock_guard<std::mutex> lck{runs_mtx};
+    for (auto &r : runs)
+        r.stop();
+}
+
+} // namespace alpaqa
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <alpaqa/alm.hpp>
+#include <alpaqa/decl/portfolio-alm.hpp>
+
+#include <cassert>
+#include <exception>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace alpaqa {
+
+template <class... InnerSolversT>
+template <class ProblemT, size_t... Is>
+typename PortfolioALMSolver<InnerSolversT...>::Stats
+PortfolioALMSolver<InnerSolversT...>::race(const ProblemT &problem, rvec y,
+                                           rvec x, std::index_sequence<Is...>) {
+    constexpr size_t N = sizeof...(InnerSolversT);
+    assert(x.size() == problem.n && y.size() == problem.m);
+    auto start_time = std::chrono::steady_clock::now();
+    Stats s;
+
+    {
+        std::lock_guard<std::mutex> lck{running_mtx};
+        running.emplace(solvers);
+    }
+    mat X = x.replicate(1, N), Y = y.replicate(1, N);
+
+    std::mutex result_mtx;
+    std::exception_ptr first_error;
+
+    auto run_solver = [&](auto index) {
+        constexpr size_t I = decltype(index)::value;
+        auto &stats        = std::get<I>(s.solvers);
+        try {
+            if (stop_signal.stop_requested()) {
+                stats.status = SolverStatus::Interrupted;
+                return;
+            }
+            // Every solver needs its own copy of the problem, because any
+            // internal state (e.g. the parameters of ProblemWithParam) is not
+            // shared
+            ProblemT p(problem);
+            stats = std::get<I>(*running)(p, Y.col(I), X.col(I));
+            if (stats.status != SolverStatus::Converged)
+                return;
+            std::lock_guard<std::mutex> lck{result_mtx};
+            if (not s.winner) {
+                s.winner       = I;
+                s.elapsed_time = std::chrono::duration_cast<
+                    std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start_time);
+                stop_running();
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lck{result_mtx};
+            if (not first_error)
+                first_error = std::current_exception();
+        }
+    };
+
+    // The calling thread runs the first solver
+    std::vector<std::thread> threads;
+    threads.reserve(N - 1);
+    (..., (Is > 0 ? (void)threads.emplace_back(
+                        run_solver, std::integral_constant<size_t, Is>{})
+                  : (void)0));
+    run_solver(std::integral_constant<size_t, 0>{});
+    for (auto &t : threads)
+        t.join();
+
+    {
+        std::lock_guard<std::mutex> lck{running_mtx};
+        running.reset();
+    }
+    if (s.winner) {
+        x = X.col(*s.winner);
+        y = Y.col(*s.winner);
+    } else if (first_error) {
+        std::rethrow_exception(first_error);
+    } else {
+        s.elapsed_time = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start_time);
+    }
+    return s;
+}
+
+template <class... InnerSolversT>
+std::string PortfolioALMSolver<InnerSolversT...>::get_name() const {
+    std::string name = "PortfolioALMSolver<";
+    std::apply(
+        [&](const auto &...solver) {
+            size_t i = 0;
+            (..., (name += (i++ > 0 ? ", " : "") + solver.get_name()));
+        },
+        solvers);
+    return name + ">";
+}
+
+template <class... InnerSolversT>
+void PortfolioALMSolver<InnerSolversT...>::stop() {
+    stop_signal.stop();
+    stop_running();
+}
+
+template <class... InnerSolversT>
+void PortfolioALMSolver<InnerSolversT...>::stop_running() {
+    std::lock_guard<std::mutex> lck{running_mtx};
+    if (running)
+        std::apply([](auto &...solver) { (..., solver.stop()); }, *running);
+}
+
+} // namespace alpaqa
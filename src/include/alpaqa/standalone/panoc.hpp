@@ -55,17 +55,6 @@ real_t initial_lipschitz_estimate(
     return std::clamp(L, L_min, L_max);
 }
 
-inline void calc_x̂(real_t γ,     ///< [in]  Step size
-                   crvec x,      ///< [in]  Decision variable @f$ x @f$
-                   const Box &C, ///< [in]  Box constraints @f$ C @f$
-                   crvec grad_ψ, ///< [in]  @f$ \nabla \psi(x^k) @f$
-                   rvec x̂, ///< [out] @f$ \hat{x}^k = T_{\gamma^k}(x^k) @f$
-                   rvec p  ///< [out] @f$ \hat{x}^k - x^k @f$
-) {
-    p = projected_gradient_step(C, γ, x, grad_ψ);
-    x̂ = x + p;
-}
-
 /// Increase the estimate of the Lipschitz constant of the objective gradient
 /// and decrease the step size until quadratic upper bound or descent lemma is
 /// satisfied:
@@ -124,11 +113,9 @@ real_t descent_lemma(
         Lₖ *= 2;
         γₖ /= 2;
 
-        // Calculate x̂ₖ and pₖ (with new step size)
-        calc_x̂(γₖ, xₖ, C, grad_ψₖ, /* in ⟹ out */ x̂ₖ, pₖ);
-        // Calculate ∇ψ(xₖ)ᵀpₖ and ‖pₖ‖²
-        grad_ψₖᵀpₖ = grad_ψₖ.dot(pₖ);
-        norm_sq_pₖ = pₖ.squaredNorm();
+        // Calculate x̂ₖ and pₖ (with new step size), ∇ψ(xₖ)ᵀpₖ and ‖pₖ‖²
+        calc_x̂(C, γₖ, xₖ, grad_ψₖ, /* in ⟹ out */ x̂ₖ, pₖ, grad_ψₖᵀpₖ,
+               norm_sq_pₖ);
 
         // Calculate ψ(x̂ₖ)
         ψx̂ₖ = ψ(x̂ₖ);
@@ -199,11 +186,11 @@ inline PANOCStats panoc_impl(ObjFunT &ψ, ObjGradFunT &grad_ψ, const Box &C,
     auto x̂ₖ₊₁ = alloc.alloc(), pₖ₊₁ = alloc.alloc();
 
     // Calculate x̂₀, p₀ (projected gradient step)
-    detail::calc_x̂(γₖ, xₖ, C, grad_ψₖ, /* in ⟹ out */ x̂ₖ, pₖ);
+    real_t grad_ψₖᵀpₖ, pₖᵀpₖ;
+    detail::calc_x̂(C, γₖ, xₖ, grad_ψₖ, /* in ⟹ out */ x̂ₖ, pₖ, grad_ψₖᵀpₖ,
+                   pₖᵀpₖ);
     // Calculate ψ(x̂ₖ)
     real_t ψx̂ₖ        = ψ(x̂ₖ);
-    real_t grad_ψₖᵀpₖ = grad_ψₖ.dot(pₖ);
-    real_t pₖᵀpₖ      = pₖ.squaredNorm();
     // Compute forward-backward envelope
     real_t φₖ = ψₖ + 1 / (2 * γₖ) * pₖᵀpₖ + grad_ψₖᵀpₖ;
 
@@ -230,7 +217,8 @@ inline PANOCStats panoc_impl(ObjFunT &ψ, ObjGradFunT &grad_ψ, const Box &C,
         grad_ψ(x̂ₖ, grad_̂ψₖ);
         // Check stop condition ------------------------------------------------
         real_t εₖ = detail::calc_error_stop_crit(
-            C, params.stop_crit, pₖ, γₖ, xₖ, x̂ₖ, vec(), grad_ψₖ, grad_̂ψₖ);
+            C, params.stop_crit, pₖ, pₖᵀpₖ, γₖ, xₖ, x̂ₖ, vec(), grad_ψₖ,
+            grad_̂ψₖ);
 
         // Print progress
         if (params.print_interval != 0 && k % params.print_interval == 0)
@@ -298,13 +286,12 @@ inline PANOCStats panoc_impl(ObjFunT &ψ, ObjGradFunT &grad_ψ, const Box &C,
             }
 
             // Calculate x̂ₖ₊₁, pₖ₊₁ (projected gradient step in xₖ₊₁)
-            detail::calc_x̂(γₖ₊₁, xₖ₊₁, C, grad_ψₖ₊₁, /* in ⟹ out */ x̂ₖ₊₁, pₖ₊₁);
+            detail::calc_x̂(C, γₖ₊₁, xₖ₊₁, grad_ψₖ₊₁, /* in ⟹ out */ x̂ₖ₊₁, pₖ₊₁,
+                           grad_ψₖ₊₁ᵀpₖ₊₁, pₖ₊₁ᵀpₖ₊₁);
             // Calculate ψ(x̂ₖ₊₁)
             ψx̂ₖ₊₁ = ψ(x̂ₖ₊₁);
 
             // Quadratic upper bound -------------------------------------------
-            grad_ψₖ₊₁ᵀpₖ₊₁ = grad_ψₖ₊₁.dot(pₖ₊₁);
-            pₖ₊₁ᵀpₖ₊₁      = pₖ₊₁.squaredNorm();
             real_t pₖ₊₁ᵀpₖ₊₁_ₖ = pₖ₊₁ᵀpₖ₊₁; // prox step with step size γₖ
 
             if (params.update_lipschitz_in_linesearch == true) {
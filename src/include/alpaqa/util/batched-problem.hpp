@@ -0,0 +1,114 @@
+#pragma once
+
+#include <alpaqa/util/box.hpp>
+#include <alpaqa/util/vec.hpp>
+
+#include <functional>
+
+namespace alpaqa {
+
+/// Mask that selects a subset of the lanes (problem instances) of a batch.
+using lane_mask = Eigen::Array<bool, Eigen::Dynamic, 1>;
+
+/// A batch of problems with the same structure (dimensions and box
+/// constraints), but different data (e.g. parameters), that are evaluated
+/// simultaneously.
+///
+/// The batch is stored in structure-of-arrays form: all arguments are
+/// @f$ B \times n @f$ (or @f$ B \times m @f$) matrices, where row @f$ b @f$
+/// contains the vector of instance @f$ b @f$. Since Eigen matrices are stored
+/// in column-major order, the @f$ j @f$-th components of all instances are
+/// contiguous in memory, so lane @f$ b @f$ of every SIMD register belongs to
+/// instance @f$ b @f$, and element-wise operations on the batch are vectorized
+/// across the instances, even for very small @f$ n @f$.
+///
+/// Each function also gets a mask with the instances that have to be
+/// evaluated. The rows of the other instances of the inputs may contain stale
+/// or invalid values (e.g. of instances that have already converged), and
+/// the corresponding rows of the outputs are ignored, so they can be skipped.
+///
+/// @see BatchedPANOCSolver
+struct BatchedProblem {
+    unsigned int n; ///< Number of decision variables, dimension of x
+    unsigned int m; ///< Number of constraints, dimension of g(x) and z
+    Box C;          ///< Constraints of the decision variables, @f$ x \in C @f$
+    Box D;          ///< Other constraints, @f$ g(x) \in D @f$
+
+    /// Signature of the function that evaluates the costs.
+    /// @param  [in] lanes
+    ///         Instances to evaluate
+    /// @param  [in] x
+    ///         Decision variables @f$ x \in \mathbb{R}^{B\times n} @f$
+    /// @param  [out] f
+    ///         Costs @f$ f(x) \in \mathbb{R}^{B} @f$
+    using f_sig = void(const lane_mask &lanes, crmat x, rvec f);
+    /// Signature of the function that evaluates the gradients of the costs.
+    /// @param  [in] lanes
+    ///         Instances to evaluate
+    /// @param  [in] x
+    ///         Decision variables @f$ x \in \mathbb{R}^{B\times n} @f$
+    /// @param  [out] grad_fx
+    ///         Gradients @f$ \nabla f(x) \in \mathbb{R}^{B\times n} @f$
+    using grad_f_sig = void(const lane_mask &lanes, crmat x, rmat grad_fx);
+    /// Signature of the function that evaluates the constraints.
+    /// @param  [in] lanes
+    ///         Instances to evaluate
+    /// @param  [in] x
+    ///         Decision variables @f$ x \in \mathbb{R}^{B\times n} @f$
+    /// @param  [out] gx
+    ///         Constraints @f$ g(x) \in \mathbb{R}^{B\times m} @f$
+    using g_sig = void(const lane_mask &lanes, crmat x, rmat gx);
+    /// Signature of the function that evaluates the gradients of the
+    /// constraints times vectors.
+    /// @param  [in] lanes
+    ///         Instances to evaluate
+    /// @param  [in] x
+    ///         Decision variables @f$ x \in \mathbb{R}^{B\times n} @f$
+    /// @param  [in] y
+    ///         Vectors to multiply by @f$ y \in \mathbb{R}^{B\times m} @f$
+    /// @param  [out] grad_gxy
+    ///         Gradients times vectors
+    ///         @f$ \nabla g(x)\ y \in \mathbb{R}^{B\times n} @f$
+    using grad_g_prod_sig = void(const lane_mask &lanes, crmat x, crmat y,
+                                 rmat grad_gxy);
+
+    /// Cost functions @f$ f(x) @f$
+    std::function<f_sig> f;
+    /// Gradients of the cost functions @f$ \nabla f(x) @f$
+    std::function<grad_f_sig> grad_f;
+    /// Constraint functions @f$ g(x) @f$
+    std::function<g_sig> g;
+    /// Gradients of the constraint functions times vectors
+    /// @f$ \nabla g(x)\ y @f$
+    std::function<grad_g_prod_sig> grad_g_prod;
+};
+
+namespace batch_util {
+
+/// Dot products of the corresponding rows of two batches.
+/// @returns @f$ \left(a_b^\top b_b\right)_{b=1}^B @f$
+template <class A, class B>
+auto rowwise_dot(const A &a, const B &b) {
+    return a.cwiseProduct(b).rowwise().sum();
+}
+
+/// Copy the rows of @p src that are selected by @p mask to @p dst.
+template <class Src, class Dst>
+void select_rows(const lane_mask &mask, const Src &src, Dst &&dst) {
+    for (Eigen::Index j = 0; j < dst.cols(); ++j)
+        dst.col(j) =
+            mask.select(src.col(j).array(), dst.col(j).array()).matrix();
+}
+
+/// Project each row of a batch onto the box @p C.
+template <class Src, class Dst>
+void project_rows(const Src &src, const Box &C, Dst &&dst) {
+    auto B = dst.rows();
+    for (Eigen::Index j = 0; j < dst.cols(); ++j)
+        dst.col(j) = clamp(src.col(j), vec::Constant(B, C.lowerbound(j)),
+                           vec::Constant(B, C.upperbound(j)));
+}
+
+} // namespace batch_util
+
+} // namespace alpaqa
@@ -2,6 +2,8 @@
 
 #include "vec.hpp"
 
+#include <cmath>
+
 namespace alpaqa {
 
 struct Box {
@@ -9,15 +11,42 @@ struct Box {
     vec lowerbound;
 };
 
+/// Clamp a vector element-wise between the given lower and upper bounds.
+/// @f[ \max\left(l, \min\left(v, u\right)\right) @f]
+/// As with `std::fmax` and `std::fmin`, NaN elements of @p v are replaced by
+/// the bounds.
+/// This expression is vectorized by Eigen, using the packet instructions of
+/// the target architecture (SSE, AVX, AVX-512, NEON, depending on the
+/// compiler flags). Eigen 3.4.0 doesn't expose the NaN propagation of
+/// `cwiseMax` and `cwiseMin` yet, so its internal functors are used directly.
+template <class Vec, class Lower, class Upper>
+inline auto clamp(const Vec &v,     ///< [in] The vector to clamp
+                  const Lower &lb,  ///< [in] Lower bound @f$ l @f$
+                  const Upper &ub   ///< [in] Upper bound @f$ u @f$
+) {
+#if EIGEN_VERSION_AT_LEAST(3, 4, 90)
+    return v.template cwiseMax<Eigen::PropagateNumbers>(lb)
+        .template cwiseMin<Eigen::PropagateNumbers>(ub);
+#elif EIGEN_VERSION_AT_LEAST(3, 4, 0)
+    using max_op =
+        Eigen::internal::scalar_max_op<real_t, real_t, Eigen::PropagateNumbers>;
+    using min_op =
+        Eigen::internal::scalar_min_op<real_t, real_t, Eigen::PropagateNumbers>;
+    return v.binaryExpr(lb, max_op{}).binaryExpr(ub, min_op{});
+#else
+    auto max = [](real_t a, real_t b) { return std::fmax(a, b); };
+    auto min = [](real_t a, real_t b) { return std::fmin(a, b); };
+    return v.binaryExpr(lb, max).binaryExpr(ub, min);
+#endif
+}
+
 /// Project a vector onto a box.
 /// @f[ \Pi_C(v) @f]
 template <class Vec>
 inline auto project(const Vec &v,  ///< [in] The vector to project
                     const Box &box ///< [in] The box to project onto
 ) {
-    using binary_real_f = real_t (*)(real_t, real_t);
-    return v.binaryExpr(box.lowerbound, binary_real_f(std::fmax))
-        .binaryExpr(box.upperbound, binary_real_f(std::fmin));
+    return clamp(v, box.lowerbound, box.upperbound);
 }
 
 /// Get the difference between the given vector and its projection.
@@ -49,10 +78,8 @@ inline real_t dist_squared(crvec v,        ///< [in] The vector to project
                            const Box &box, ///< [in] The box to project onto
                            crvec Σ ///< [in] Diagonal matrix defining norm
 ) {
-    // TODO: Does this allocate?
-    //       Does it have dangling references to temporaries?
-    auto d = v - project(v, box);
-    return d.dot(Σ.asDiagonal() * d);
+    // Single vectorized reduction, without evaluating the projection twice
+    return Σ.dot(projecting_difference(v, box).cwiseAbs2());
 }
 
 } // namespace alpaqa
\ No newline at end of file
@@ -2,17 +2,33 @@
 
 #include <alpaqa/util/vec.hpp>
 
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
 namespace alpaqa {
 
 struct LipschitzEstimateParams {
     /// Initial estimate of the Lipschitz constant of ∇ψ(x)
     real_t L₀ = 0;
     /// Relative step size for initial finite difference Lipschitz estimate.
-    real_t ε = 1e-6;
+    /// Defaults to @f$ 10^{-6} @f$ in double precision, and to
+    /// @f$ \epsilon_\text{mach}^{3/8} @f$ for other types (roughly
+    /// @f$ 3 \cdot 10^{-3} @f$ in single precision).
+    real_t ε = std::is_same_v<real_t, double>
+                   ? real_t(1e-6)
+                   : std::pow(std::numeric_limits<real_t>::epsilon(),
+                              real_t(3) / 8);
     /// Minimum step size for initial finite difference Lipschitz estimate.
-    real_t δ = 1e-12;
+    /// Defaults to @f$ 10^{-12} @f$ in double precision, and to
+    /// @f$ \epsilon_\text{mach}^{3/4} @f$ for other types (the square of the
+    /// default relative step size).
+    real_t δ = std::is_same_v<real_t, double>
+                   ? real_t(1e-12)
+                   : std::pow(std::numeric_limits<real_t>::epsilon(),
+                              real_t(3) / 4);
     /// Factor that relates step size γ and Lipschitz constant.
     real_t Lγ_factor = 0.95;
 };
 
-} // namespace alpaqa
\ No newline at end of file
+} // namespace alpaqa
@@ -1,15 +1,34 @@
 #pragma once
 
 #include "box.hpp"
+#include "sparsity.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <functional>
 #include <memory>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace alpaqa {
 
+/// Declares which functions of a problem are thread-safe, i.e. can be called
+/// from any thread, at the same time as the other functions of the problem
+/// and as other calls to the same function.
+/// Solvers only evaluate two independent functions in parallel (e.g. f(x)
+/// and g(x)) if both of them are declared thread-safe, see for example
+/// @ref PANOCParams::concurrent_evaluations and
+/// @ref PANOCParams::linesearch_parallel_candidates.
+struct ProblemThreadSafety {
+    bool f           = false; ///< @ref Problem::f
+    bool grad_f      = false; ///< @ref Problem::grad_f
+    bool g           = false; ///< @ref Problem::g
+    bool grad_g_prod = false; ///< @ref Problem::grad_g_prod
+    bool f_grad_f    = false; ///< @ref Problem::f_grad_f
+};
+
 /**
  * @class Problem
  * @brief   Problem description for minimization problems.
@@ -90,6 +109,106 @@ struct Problem {
     /// @param  [out] H
     ///         Hessian @f$ \nabla_{xx}^2 L(x, y) \in \mathbb{R}^{n\times n} @f$
     using hess_L_sig = void(crvec x, crvec y, rmat H);
+    /// Signature of the function that evaluates the cost and its gradient
+    /// @f$ f(x) @f$ and @f$ \nabla f(x) @f$ at the same time
+    /// @param  [in] x
+    ///         Decision variable @f$ x \in \mathbb{R}^n @f$
+    /// @param  [out] grad_fx
+    ///         Gradient of cost function @f$ \nabla f(x) \in \mathbb{R}^n @f$
+    /// @return The cost @f$ f(x) @f$
+    using f_grad_f_sig = real_t(crvec x, rvec grad_fx);
+    /// Signature of the function that evaluates the gradient of the Lagrangian
+    /// @f$ \nabla_x L(x, y) = \nabla f(x) + \nabla g(x)\ y @f$
+    /// @param  [in] x
+    ///         Decision variable @f$ x \in \mathbb{R}^n @f$
+    /// @param  [in] y
+    ///         Lagrange multipliers @f$ y \in \mathbb{R}^m @f$
+    /// @param  [out] grad_L
+    ///         Gradient of the Lagrangian
+    ///         @f$ \nabla_x L(x, y) \in \mathbb{R}^n @f$
+    using grad_L_sig = void(crvec x, crvec y, rvec grad_L);
+    /// Signature of the function that evaluates the augmented Lagrangian
+    /// function @f$ \psi(x) @f$ and the vector @f$ \hat{y}(x) @f$, without
+    /// its gradient
+    /// @f[ \psi(x) = f(x) + \frac{1}{2}
+    /// \text{dist}_\Sigma^2\left(g(x) + \Sigma^{-1}y,\;D\right) @f]
+    /// @param  [in] x
+    ///         Decision variable @f$ x \in \mathbb{R}^n @f$
+    /// @param  [in] y
+    ///         Lagrange multipliers @f$ y \in \mathbb{R}^m @f$
+    /// @param  [in] Σ
+    ///         Penalty weights @f$ \Sigma \in \mathbb{R}^m @f$
+    /// @param  [in] D
+    ///         Box constraints on @f$ g(x) @f$
+    /// @param  [out] ŷ
+    ///         @f$ \hat{y}(x) = \Sigma \left(g(x) + \Sigma^{-1}y - \Pi_D\left(
+    ///         g(x) + \Sigma^{-1}y\right)\right) \in \mathbb{R}^m @f$
+    /// @return The augmented Lagrangian @f$ \psi(x) @f$
+    using ψ_sig = real_t(crvec x, crvec y, crvec Σ, const Box &D, rvec ŷ);
+    /// Signature of the function that evaluates the augmented Lagrangian
+    /// function @f$ \psi(x) @f$ and its gradient @f$ \nabla \psi(x) @f$
+    /// @f[ \psi(x) = f(x) + \frac{1}{2}
+    /// \text{dist}_\Sigma^2\left(g(x) + \Sigma^{-1}y,\;D\right) @f]
+    /// @f[ \nabla \psi(x) = \nabla f(x) + \nabla g(x)\ \hat{y}(x) @f]
+    /// @param  [in] x
+    ///         Decision variable @f$ x \in \mathbb{R}^n @f$
+    /// @param  [in] y
+    ///         Lagrange multipliers @f$ y \in \mathbb{R}^m @f$
+    /// @param  [in] Σ
+    ///         Penalty weights @f$ \Sigma \in \mathbb{R}^m @f$
+    /// @param  [in] D
+    ///         Box constraints on @f$ g(x) @f$
+    /// @param  [out] grad_ψ
+    ///         Gradient @f$ \nabla \psi(x) \in \mathbb{R}^n @f$
+    /// @param  [out] ŷ
+    ///         @f$ \hat{y}(x) = \Sigma \left(g(x) + \Sigma^{-1}y - \Pi_D\left(
+    ///         g(x) + \Sigma^{-1}y\right)\right) \in \mathbb{R}^m @f$
+    /// @return The augmented Lagrangian @f$ \psi(x) @f$
+    using ψ_grad_ψ_sig = real_t(crvec x, crvec y, crvec Σ, const Box &D,
+                                rvec grad_ψ, rvec ŷ);
+    /// Signature of the function that evaluates the product of the
+    /// (generalized) Hessian of the augmented Lagrangian function with a vector
+    /// @f[ \nabla^2 \psi(x)\ v = \nabla_{xx}^2 L(x, \hat{y}(x))\ v +
+    /// \sum_{i \in \mathcal{K}} \Sigma_i \nabla g_i(x) \nabla g_i(x)^\top
+    /// v, @f]
+    /// where @f$ \mathcal{K} @f$ is the set of constraints for which
+    /// @f$ g_i(x) + \Sigma_i^{-1} y_i @f$ is not in the interior of @f$ D_i
+    /// @f$.
+    /// @param  [in] x
+    ///         Decision variable @f$ x \in \mathbb{R}^n @f$
+    /// @param  [in] y
+    ///         Lagrange multipliers @f$ y \in \mathbb{R}^m @f$
+    /// @param  [in] Σ
+    ///         Penalty weights @f$ \Sigma \in \mathbb{R}^m @f$
+    /// @param  [in] D
+    ///         Box constraints on @f$ g(x) @f$
+    /// @param  [in] v
+    ///         Vector to multiply by @f$ v \in \mathbb{R}^n @f$
+    /// @param  [out] Hv
+    ///         Hessian-vector product
+    ///         @f$ \nabla^2 \psi(x)\ v \in \mathbb{R}^{n} @f$
+    using hess_ψ_prod_sig = void(crvec x, crvec y, crvec Σ, const Box &D,
+                                 crvec v, rvec Hv);
+    /// Signature of the function that evaluates the nonzero elements of the
+    /// Jacobian of the constraints @f$ \nabla g(x)^\top \in
+    /// \mathbb{R}^{m\times n} @f$, see @ref jac_g_sparsity
+    /// @param  [in] x
+    ///         Decision variable @f$ x \in \mathbb{R}^n @f$
+    /// @param  [out] J_values
+    ///         Values of the nonzero elements of the Jacobian, in the order of
+    ///         the sparsity pattern
+    using jac_g_sig = void(crvec x, rvec J_values);
+    /// Signature of the function that evaluates the nonzero elements of the
+    /// Hessian of the Lagrangian @f$ \nabla_{xx}^2 L(x, y) \in
+    /// \mathbb{R}^{n\times n} @f$, see @ref hess_L_sparsity
+    /// @param  [in] x
+    ///         Decision variable @f$ x \in \mathbb{R}^n @f$
+    /// @param  [in] y
+    ///         Lagrange multipliers @f$ y \in \mathbb{R}^m @f$
+    /// @param  [out] H_values
+    ///         Values of the nonzero elements of the Hessian, in the order of
+    ///         the sparsity pattern
+    using hess_L_sparse_sig = void(crvec x, crvec y, rvec H_values);
 
     /// Cost function @f$ f(x) @f$
     std::function<f_sig> f;
@@ -107,6 +226,49 @@ struct Problem {
     /// Hessian of the Lagrangian function @f$ \nabla_{xx}^2 L(x, y) @f$
     std::function<hess_L_sig> hess_L;
 
+    /// @name   Optional fused evaluations
+    /// Evaluating several functions at the same point in a single call allows
+    /// the implementation to share common subexpressions. When these functions
+    /// are not set, the solvers fall back to the separate functions above.
+    /// @{
+
+    /// Cost function and its gradient @f$ f(x) @f$, @f$ \nabla f(x) @f$
+    std::function<f_grad_f_sig> f_grad_f;
+    /// Gradient of the Lagrangian @f$ \nabla f(x) + \nabla g(x)\ y @f$
+    std::function<grad_L_sig> grad_L;
+    /// Augmented Lagrangian @f$ \psi(x) @f$ and @f$ \hat{y}(x) @f$, used
+    /// where the gradient isn't needed (e.g. in @f$ \hat{x} @f$ in the line
+    /// search of PANOC)
+    std::function<ψ_sig> ψ;
+    /// Augmented Lagrangian and its gradient @f$ \psi(x) @f$,
+    /// @f$ \nabla \psi(x) @f$
+    std::function<ψ_grad_ψ_sig> ψ_grad_ψ;
+    /// Hessian-vector product of the augmented Lagrangian
+    /// @f$ \nabla^2 \psi(x)\ v @f$
+    std::function<hess_ψ_prod_sig> hess_ψ_prod;
+    /// Nonzero elements of the sparse constraint Jacobian
+    /// @f$ \nabla g(x)^\top @f$
+    std::function<jac_g_sig> jac_g;
+    /// Sparsity pattern of the constraint Jacobian evaluated by @ref jac_g
+    /// (@f$ m \times n @f$). It doesn't change between evaluations.
+    SparsityPattern jac_g_sparsity;
+    /// Nonzero elements of the sparse Hessian of the Lagrangian
+    /// @f$ \nabla_{xx}^2 L(x, y) @f$
+    std::function<hess_L_sparse_sig> hess_L_sparse;
+    /// Sparsity pattern of the Hessian evaluated by @ref hess_L_sparse
+    /// (@f$ n \times n @f$). It doesn't change between evaluations.
+    /// Only the elements in the upper triangle are used, elements below the
+    /// diagonal are ignored, so the pattern can contain either the upper
+    /// triangle only or the full symmetric matrix.
+    SparsityPattern hess_L_sparsity;
+
+    /// @}
+
+    /// Which of the functions above may be evaluated in parallel. Problems
+    /// with a static interface (see @ref is_static_problem) can declare this
+    /// using a data member with the same name.
+    ProblemThreadSafety thread_safe;
+
     Problem() = default;
     Problem(unsigned int n, unsigned int m)
         : n(n), m(m), C{vec::Constant(n, +inf), vec::Constant(n, -inf)},
@@ -123,6 +285,60 @@ struct Problem {
           hess_L_prod(std::move(hess_L_prod)), hess_L(std::move(hess_L)) {}
 };
 
+/// Checks whether the type @p P provides the static (compile-time) problem
+/// interface: data members `n`, `m`, `C` and `D`, and member functions `f`,
+/// `grad_f`, `g` and `grad_g_prod` that can be called with the same arguments
+/// as the corresponding members of @ref Problem.
+/// Solvers that accept such types directly (e.g. @ref PANOCSolver and
+/// @ref ALMSolver) can inline the function evaluations, avoiding the indirect
+/// calls through `std::function`.
+/// Types derived from @ref Problem are not considered static problems, they
+/// use the type-erased interface.
+template <class P, class = void>
+struct is_static_problem : std::false_type {};
+
+template <class P>
+struct is_static_problem<
+    P, std::void_t<decltype(std::declval<const P &>().n),
+                   decltype(std::declval<const P &>().m),
+                   decltype(std::declval<const P &>().C),
+                   decltype(std::declval<const P &>().D),
+                   decltype(std::declval<const P &>().f(std::declval<crvec>())),
+                   decltype(std::declval<const P &>().grad_f(
+                       std::declval<crvec>(), std::declval<rvec>())),
+                   decltype(std::declval<const P &>().g(
+                       std::declval<crvec>(), std::declval<rvec>())),
+                   decltype(std::declval<const P &>().grad_g_prod(
+                       std::declval<crvec>(), std::declval<crvec>(),
+                       std::declval<rvec>()))>>
+    : std::bool_constant<not std::is_base_of_v<Problem, P>> {};
+
+template <class P>
+inline constexpr bool is_static_problem_v = is_static_problem<P>::value;
+
+/// Create a type-erased @ref Problem that refers to the given problem with a
+/// static interface. Only the first-order functions (f, grad_f, g and
+/// grad_g_prod) are set.
+/// @note   The returned problem keeps a reference to @p p, so @p p should
+///         outlive it.
+template <class ProblemT>
+Problem make_problem_view(const ProblemT &p) {
+    static_assert(is_static_problem_v<ProblemT>);
+    return Problem{
+        static_cast<unsigned>(p.n),
+        static_cast<unsigned>(p.m),
+        p.C,
+        p.D,
+        [&p](crvec x) { return p.f(x); },
+        [&p](crvec x, rvec grad_fx) { p.grad_f(x, grad_fx); },
+        [&p](crvec x, rvec gx) { p.g(x, gx); },
+        [&p](crvec x, crvec y, rvec grad_gxy) { p.grad_g_prod(x, y, grad_gxy); },
+        {},
+        {},
+        {},
+    };
+}
+
 class ParamWrapper {
   public:
     ParamWrapper(unsigned p) : param(vec::Constant(p, NaN)) {}
@@ -174,6 +390,13 @@ struct EvalCounter {
     unsigned grad_gi{};
     unsigned hess_L_prod{};
     unsigned hess_L{};
+    unsigned f_grad_f{};
+    unsigned grad_L{};
+    unsigned ψ{};
+    unsigned ψ_grad_ψ{};
+    unsigned hess_ψ_prod{};
+    unsigned jac_g{};
+    unsigned hess_L_sparse{};
 
     struct EvalTimer {
         std::chrono::nanoseconds f{};
@@ -183,6 +406,13 @@ struct EvalCounter {
         std::chrono::nanoseconds grad_gi{};
         std::chrono::nanoseconds hess_L_prod{};
         std::chrono::nanoseconds hess_L{};
+        std::chrono::nanoseconds f_grad_f{};
+        std::chrono::nanoseconds grad_L{};
+        std::chrono::nanoseconds ψ{};
+        std::chrono::nanoseconds ψ_grad_ψ{};
+        std::chrono::nanoseconds hess_ψ_prod{};
+        std::chrono::nanoseconds jac_g{};
+        std::chrono::nanoseconds hess_L_sparse{};
     } time;
 
     void reset() { *this = {}; }
@@ -196,6 +426,13 @@ inline EvalCounter &operator+=(EvalCounter &a, const EvalCounter &b) {
     a.grad_gi += b.grad_gi;
     a.hess_L_prod += b.hess_L_prod;
     a.hess_L += b.hess_L;
+    a.f_grad_f += b.f_grad_f;
+    a.grad_L += b.grad_L;
+    a.ψ += b.ψ;
+    a.ψ_grad_ψ += b.ψ_grad_ψ;
+    a.hess_ψ_prod += b.hess_ψ_prod;
+    a.jac_g += b.jac_g;
+    a.hess_L_sparse += b.hess_L_sparse;
     return a;
 }
 
@@ -208,6 +445,13 @@ inline EvalCounter::EvalTimer &operator+=(EvalCounter::EvalTimer &a,
     a.grad_gi += b.grad_gi;
     a.hess_L_prod += b.hess_L_prod;
     a.hess_L += b.hess_L;
+    a.f_grad_f += b.f_grad_f;
+    a.grad_L += b.grad_L;
+    a.ψ += b.ψ;
+    a.ψ_grad_ψ += b.ψ_grad_ψ;
+    a.hess_ψ_prod += b.hess_ψ_prod;
+    a.jac_g += b.jac_g;
+    a.hess_L_sparse += b.hess_L_sparse;
     return a;
 }
 
@@ -256,6 +500,9 @@ void ProblemWithCounters<ProblemT>::attach_counters(
         }
     };
 
+    // The counters and timers are updated without synchronization, so the
+    // solvers must not evaluate these functions in parallel
+    wc.thread_safe = {};
     wc.f = [ev{wc.evaluations}, f{std::move(wc.f)}](crvec x) {
         ++ev->f;
         return timed(ev->time.f, [&] { return f(x); });
@@ -277,8 +524,8 @@ void ProblemWithCounters<ProblemT>::attach_counters(
     };
     wc.grad_gi = [ev{wc.evaluations}, grad_gi{std::move(wc.grad_gi)}](
                      crvec x, unsigned i, rvec grad) {
-        ++ev->grad_g_prod;
-        timed(ev->time.grad_g_prod, [&] { grad_gi(x, i, grad); });
+        ++ev->grad_gi;
+        timed(ev->time.grad_gi, [&] { grad_gi(x, i, grad); });
     };
     wc.hess_L_prod = [ev{wc.evaluations},
                       hess_L_prod{std::move(wc.hess_L_prod)}](
@@ -291,6 +538,206 @@ void ProblemWithCounters<ProblemT>::attach_counters(
         ++ev->hess_L;
         timed(ev->time.hess_L, [&] { hess_L(x, y, H); });
     };
+    // The optional fused functions are only wrapped if they are set, so the
+    // solvers can still check whether they are available.
+    if (wc.f_grad_f)
+        wc.f_grad_f = [ev{wc.evaluations}, f_grad_f{std::move(wc.f_grad_f)}](
+                          crvec x, rvec grad) {
+            ++ev->f_grad_f;
+            return timed(ev->time.f_grad_f, [&] { return f_grad_f(x, grad); });
+        };
+    if (wc.grad_L)
+        wc.grad_L = [ev{wc.evaluations}, grad_L{std::move(wc.grad_L)}](
+                        crvec x, crvec y, rvec grad) {
+            ++ev->grad_L;
+            timed(ev->time.grad_L, [&] { grad_L(x, y, grad); });
+        };
+    if (wc.ψ)
+        wc.ψ = [ev{wc.evaluations}, ψ{std::move(wc.ψ)}](
+                   crvec x, crvec y, crvec Σ, const Box &D, rvec ŷ) {
+            ++ev->ψ;
+            return timed(ev->time.ψ, [&] { return ψ(x, y, Σ, D, ŷ); });
+        };
+    if (wc.ψ_grad_ψ)
+        wc.ψ_grad_ψ = [ev{wc.evaluations}, ψ_grad_ψ{std::move(wc.ψ_grad_ψ)}](
+                          crvec x, crvec y, crvec Σ, const Box &D, rvec grad,
+                          rvec ŷ) {
+            ++ev->ψ_grad_ψ;
+            return timed(ev->time.ψ_grad_ψ,
+                         [&] { return ψ_grad_ψ(x, y, Σ, D, grad, ŷ); });
+        };
+    if (wc.hess_ψ_prod)
+        wc.hess_ψ_prod = [ev{wc.evaluations},
+                          hess_ψ_prod{std::move(wc.hess_ψ_prod)}](
+                             crvec x, crvec y, crvec Σ, const Box &D, crvec v,
+                             rvec Hv) {
+            ++ev->hess_ψ_prod;
+            timed(ev->time.hess_ψ_prod,
+                  [&] { hess_ψ_prod(x, y, Σ, D, v, Hv); });
+        };
+    if (wc.jac_g)
+        wc.jac_g = [ev{wc.evaluations}, jac_g{std::move(wc.jac_g)}](
+                       crvec x, rvec J_values) {
+            ++ev->jac_g;
+            timed(ev->time.jac_g, [&] { jac_g(x, J_values); });
+        };
+    if (wc.hess_L_sparse)
+        wc.hess_L_sparse = [ev{wc.evaluations},
+                            hess_L_sparse{std::move(wc.hess_L_sparse)}](
+                               crvec x, crvec y, rvec H_values) {
+            ++ev->hess_L_sparse;
+            timed(ev->time.hess_L_sparse,
+                  [&] { hess_L_sparse(x, y, H_values); });
+        };
+}
+
+/// Cache of the most recent evaluations of @f$ f(x) @f$, @f$ g(x) @f$ and
+/// @f$ \nabla f(x) @f$, keyed on the point @f$ x @f$, see
+/// @ref ProblemWithCache.
+class EvalCache {
+  public:
+    struct Entry {
+        vec x;
+        real_t f;
+        vec g;
+        vec grad_f;
+        bool has_f      = false;
+        bool has_g      = false;
+        bool has_grad_f = false;
+    };
+
+    /// @param  size
+    ///         The number of points to remember.
+    EvalCache(unsigned size) : entries(std::max(size, 1u)) {}
+
+    /// Get the entry for the point @p x. If @p x is not in the cache, the
+    /// least recently inserted entry is cleared and reused.
+    Entry &lookup(crvec x) {
+        for (auto &e : entries)
+            if (e.x.size() == x.size() && e.x == x)
+                return e;
+        auto &e = entries[next];
+        next    = next + 1 < entries.size() ? next + 1 : 0;
+        e.x     = x;
+        e.has_f = e.has_g = e.has_grad_f = false;
+        return e;
+    }
+    /// Forget all cached evaluations. Should be called when the problem
+    /// changes, e.g. when its parameters are updated.
+    void clear() {
+        for (auto &e : entries) {
+            e.x.resize(0);
+            e.has_f = e.has_g = e.has_grad_f = false;
+        }
+    }
+
+    /// Number of evaluations that were answered from the cache.
+    unsigned hits = 0;
+
+  private:
+    std::vector<Entry> entries;
+    size_t next = 0;
+};
+
+/// Problem adapter that remembers the values of @f$ f(x) @f$, @f$ g(x) @f$
+/// and @f$ \nabla f(x) @f$ for the last few points @f$ x @f$, so repeated
+/// evaluations at the same point (e.g. in the starting point, by the penalty
+/// initialization, the preconditioner and the inner solver, or in
+/// @f$ \hat x @f$ when computing the final constraint violation) are not
+/// carried out again. The functions that depend on other arguments than
+/// @f$ x @f$ are passed through unchanged.
+/// @note   The points are compared exactly, the cache only helps if the same
+///         point is evaluated again bit for bit. The (small) overhead of the
+///         comparisons and copies is only worth it for expensive functions.
+/// @note   All cached functions share the same (unsynchronized) cache, so
+///         none of them are thread-safe, regardless of the
+///         @ref Problem::thread_safe flags of the wrapped problem.
+template <class ProblemT>
+class ProblemWithCache : public ProblemT {
+  public:
+    ProblemWithCache(ProblemT &&p, unsigned size = 2)
+        : ProblemT(std::move(p)), cache(std::make_shared<EvalCache>(size)) {
+        attach_cache(*this);
+    }
+    ProblemWithCache(const ProblemT &p, unsigned size = 2)
+        : ProblemT(p), cache(std::make_shared<EvalCache>(size)) {
+        attach_cache(*this);
+    }
+
+    ProblemWithCache(const ProblemWithCache &) = delete;
+    ProblemWithCache &operator=(const ProblemWithCache &) = delete;
+    ProblemWithCache(ProblemWithCache &&)                 = default;
+    ProblemWithCache &operator=(ProblemWithCache &&) = default;
+
+    /// Update the parameters of the underlying problem (e.g.
+    /// @ref ProblemWithParam) and invalidate the cache.
+    template <class... Args>
+    void set_param(Args &&...args) {
+        cache->clear();
+        ProblemT::set_param(std::forward<Args>(args)...);
+    }
+
+  public:
+    std::shared_ptr<EvalCache> cache;
+
+  private:
+    static void attach_cache(ProblemWithCache &);
+};
+
+template <class ProblemT>
+void ProblemWithCache<ProblemT>::attach_cache(ProblemWithCache<ProblemT> &wc) {
+    // Looking up or inserting an entry modifies the shared cache, so the
+    // solvers must not evaluate these functions in parallel
+    wc.thread_safe = {};
+    wc.f = [c{wc.cache}, f{std::move(wc.f)}](crvec x) {
+        auto &e = c->lookup(x);
+        if (e.has_f) {
+            ++c->hits;
+        } else {
+            e.f     = f(x);
+            e.has_f = true;
+        }
+        return e.f;
+    };
+    wc.grad_f = [c{wc.cache}, grad_f{std::move(wc.grad_f)}](crvec x,
+                                                            rvec grad) {
+        auto &e = c->lookup(x);
+        if (e.has_grad_f) {
+            ++c->hits;
+        } else {
+            e.grad_f.resize(grad.size());
+            grad_f(x, e.grad_f);
+            e.has_grad_f = true;
+        }
+        grad = e.grad_f;
+    };
+    wc.g = [c{wc.cache}, g{std::move(wc.g)}](crvec x, rvec gx) {
+        auto &e = c->lookup(x);
+        if (e.has_g) {
+            ++c->hits;
+        } else {
+            e.g.resize(gx.size());
+            g(x, e.g);
+            e.has_g = true;
+        }
+        gx = e.g;
+    };
+    // The optional fused function is only wrapped if it is set, so the
+    // solvers can still check whether it is available.
+    if (wc.f_grad_f)
+        wc.f_grad_f = [c{wc.cache}, f_grad_f{std::move(wc.f_grad_f)}](
+                          crvec x, rvec grad) {
+            auto &e = c->lookup(x);
+            if (e.has_f && e.has_grad_f) {
+                ++c->hits;
+            } else {
+                e.grad_f.resize(grad.size());
+                e.f     = f_grad_f(x, e.grad_f);
+                e.has_f = e.has_grad_f = true;
+            }
+            grad = e.grad_f;
+            return e.f;
+        };
 }
 
 /// Moves the state constraints in the set C to the set D, resulting in an
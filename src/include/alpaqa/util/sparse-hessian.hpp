@@ -0,0 +1,125 @@
+#pragma once
+
+#include "sparse-jacobian.hpp"
+
+#include <algorithm>
+
+namespace alpaqa {
+
+/// Sparse symmetric matrix for assembling the Hessian of the augmented
+/// Lagrangian from @ref Problem::hess_L_sparse and @ref Problem::jac_g.
+/// Only the upper triangle is stored (column-major). The pattern is the union
+/// of the upper triangles of the Hessian of the Lagrangian, of
+/// @f$ J^\top J @f$ and of the diagonal. It covers the Hessian for any set of
+/// active constraints, so it never changes between iterations, and a
+/// symbolic factorization of it can be reused.
+class SparseHessian {
+  public:
+    using matrix_t = Eigen::SparseMatrix<real_t, Eigen::ColMajor>;
+
+    /// Build the compressed storage for the given patterns of the Hessian of
+    /// the Lagrangian and of the constraint Jacobian.
+    /// @return Whether the pattern changed since the previous call. If not,
+    ///         this is a no-op.
+    bool set_pattern(const SparsityPattern &hess_L,
+                     const SparsityPattern &jac_g) {
+        if (hess_L == hess_L_pattern && jac_g == jac_g_pattern)
+            return false;
+        hess_L_pattern = hess_L;
+        jac_g_pattern  = jac_g;
+        auto n         = hess_L.rows;
+        nonzeros.resize(hess_L.nnz());
+        // Store the index of each element of the Hessian pattern (plus one)
+        // as its value to recover the permutation after compression, the
+        // other elements are zero
+        std::vector<Eigen::Triplet<real_t>> triplets;
+        triplets.reserve(hess_L.nnz() + n);
+        for (Eigen::Index k = 0; k < hess_L.nnz(); ++k)
+            if (hess_L.row[k] <= hess_L.col[k])
+                triplets.emplace_back(hess_L.row[k], hess_L.col[k],
+                                      real_t(k + 1));
+        for (Eigen::Index i = 0; i < n; ++i)
+            triplets.emplace_back(i, i, real_t(0));
+        // Every pair of nonzeros in one row of the Jacobian results in a
+        // nonzero of Jᵀ Σ J
+        std::vector<std::vector<Eigen::Index>> jac_rows(jac_g.rows);
+        for (Eigen::Index k = 0; k < jac_g.nnz(); ++k)
+            jac_rows[jac_g.row[k]].push_back(jac_g.col[k]);
+        for (const auto &cols : jac_rows)
+            for (auto r : cols)
+                for (auto c : cols)
+                    if (r <= c)
+                        triplets.emplace_back(r, c, real_t(0));
+        H.resize(n, n);
+        // Duplicates are summed, but only one of them can be nonzero
+        H.setFromTriplets(triplets.begin(), triplets.end());
+        H.makeCompressed();
+        permutation.assign(hess_L.nnz(), -1);
+        for (Eigen::Index p = 0; p < H.nonZeros(); ++p)
+            if (auto k = static_cast<Eigen::Index>(H.valuePtr()[p]); k > 0)
+                permutation[k - 1] = p;
+        inactive.resize(n);
+        return true;
+    }
+
+    /// Overwrite the matrix by the Hessian of the Lagrangian, using the values
+    /// in @ref nonzeros.
+    void update() {
+        std::fill_n(H.valuePtr(), H.nonZeros(), real_t(0));
+        for (Eigen::Index k = 0; k < nonzeros.size(); ++k)
+            if (permutation[k] >= 0)
+                H.valuePtr()[permutation[k]] = nonzeros(k);
+    }
+
+    /// Add the rank-one term @f$ \Sigma_i \nabla g_i \nabla g_i^\top @f$,
+    /// where @f$ \nabla g_i^\top @f$ is the @f$ i @f$-th row of @p J.
+    void add_rank_one(const SparseJacobian::matrix_t &J, Eigen::Index i,
+                      real_t Σi) {
+        using It = SparseJacobian::matrix_t::InnerIterator;
+        for (It c(J, i); c; ++c) {
+            real_t Σ_Jic = Σi * c.value();
+            for (It r(J, i); r; ++r)
+                if (r.col() <= c.col())
+                    coeff(r.col(), c.col()) += r.value() * Σ_Jic;
+        }
+    }
+
+    /// Replace the rows and columns with the given indices by those of the
+    /// identity matrix, so that only the submatrix of the remaining indices
+    /// has to be factorized, while keeping the sparsity pattern fixed.
+    void eliminate(const std::vector<Eigen::Index> &K) {
+        std::fill(inactive.begin(), inactive.end(), true);
+        for (auto k : K)
+            inactive[k] = false;
+        for (Eigen::Index c = 0; c < H.outerSize(); ++c)
+            for (matrix_t::InnerIterator r(H, c); r; ++r)
+                if (not inactive[r.row()] || not inactive[c])
+                    r.valueRef() = r.row() == c ? 1 : 0;
+    }
+
+    /// The upper triangle of the Hessian.
+    const matrix_t &matrix() const { return H; }
+
+    /// Values of the nonzero elements of the Hessian of the Lagrangian, in the
+    /// order of its sparsity pattern. This is where
+    /// @ref Problem::hess_L_sparse should write its output.
+    vec nonzeros;
+
+  private:
+    /// Reference to element (r, c) of the upper triangle (it must be in the
+    /// pattern).
+    real_t &coeff(Eigen::Index r, Eigen::Index c) {
+        auto begin = H.innerIndexPtr() + H.outerIndexPtr()[c];
+        auto end   = H.innerIndexPtr() + H.outerIndexPtr()[c + 1];
+        auto it    = std::lower_bound(begin, end, r);
+        return H.valuePtr()[it - H.innerIndexPtr()];
+    }
+
+  private:
+    SparsityPattern hess_L_pattern, jac_g_pattern;
+    std::vector<Eigen::Index> permutation;
+    std::vector<bool> inactive;
+    matrix_t H;
+};
+
+} // namespace alpaqa
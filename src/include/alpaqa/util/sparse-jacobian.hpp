@@ -0,0 +1,56 @@
+#pragma once
+
+#include "sparsity.hpp"
+
+#include <Eigen/SparseCore>
+
+namespace alpaqa {
+
+/// Sparse matrix with a fixed sparsity pattern, for evaluating the constraint
+/// Jacobian through @ref Problem::jac_g. The compressed (row-major) storage is
+/// built only once, every evaluation simply copies the nonzero values into it.
+class SparseJacobian {
+  public:
+    using matrix_t = Eigen::SparseMatrix<real_t, Eigen::RowMajor>;
+
+    /// Build the compressed storage for the given pattern. No-op if the
+    /// pattern didn't change since the previous call.
+    void set_pattern(const SparsityPattern &sp) {
+        if (sp == pattern)
+            return;
+        pattern = sp;
+        nonzeros.resize(sp.nnz());
+        // Store the index of each element in the pattern as its value to
+        // recover the permutation after compression
+        std::vector<Eigen::Triplet<real_t>> triplets;
+        triplets.reserve(sp.nnz());
+        for (Eigen::Index k = 0; k < sp.nnz(); ++k)
+            triplets.emplace_back(sp.row[k], sp.col[k], real_t(k));
+        J.resize(sp.rows, sp.cols);
+        J.setFromTriplets(triplets.begin(), triplets.end());
+        J.makeCompressed();
+        permutation.resize(sp.nnz());
+        for (Eigen::Index p = 0; p < J.nonZeros(); ++p)
+            permutation[static_cast<Eigen::Index>(J.valuePtr()[p])] = p;
+    }
+
+    /// Copy the values in @ref nonzeros into the compressed matrix.
+    void update() {
+        for (Eigen::Index k = 0; k < nonzeros.size(); ++k)
+            J.valuePtr()[permutation[k]] = nonzeros(k);
+    }
+
+    /// The Jacobian matrix (as of the last call to @ref update).
+    const matrix_t &matrix() const { return J; }
+
+    /// Values of the nonzero elements, in the order of the sparsity pattern.
+    /// This is where @ref Problem::jac_g should write its output.
+    vec nonzeros;
+
+  private:
+    SparsityPattern pattern;
+    std::vector<Eigen::Index> permutation;
+    matrix_t J;
+};
+
+} // namespace alpaqa
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "vec.hpp"
+
+#include <vector>
+
+namespace alpaqa {
+
+/// Sparsity pattern of a matrix in coordinate (triplet) format: the
+/// @f$ k @f$-th nonzero element is at position `(row[k], col[k])`.
+/// Functions that evaluate a sparse matrix write the values of the nonzero
+/// elements in the same order. Duplicate entries are not allowed.
+struct SparsityPattern {
+    Eigen::Index rows = 0; ///< Number of rows of the matrix
+    Eigen::Index cols = 0; ///< Number of columns of the matrix
+    std::vector<Eigen::Index> row; ///< Row index of each nonzero element
+    std::vector<Eigen::Index> col; ///< Column index of each nonzero element
+
+    /// Number of (structurally) nonzero elements.
+    Eigen::Index nnz() const { return static_cast<Eigen::Index>(row.size()); }
+};
+
+inline bool operator==(const SparsityPattern &a, const SparsityPattern &b) {
+    return a.rows == b.rows && a.cols == b.cols && a.row == b.row &&
+           a.col == b.col;
+}
+inline bool operator!=(const SparsityPattern &a, const SparsityPattern &b) {
+    return !(a == b);
+}
+
+} // namespace alpaqa
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace alpaqa {
+
+/// Fixed number of worker threads that execute small batches of tasks, e.g.
+/// independent function evaluations within one solver iteration.
+///
+/// Copying a pool creates a new pool with the same number of threads, so that
+/// copies of a solver never share their threads (similar to
+/// @ref AtomicStopSignal). A single pool should not be used by multiple
+/// threads at the same time.
+class ThreadPool {
+  public:
+    explicit ThreadPool(size_t num_threads = 0) { start(num_threads); }
+    ThreadPool(const ThreadPool &o) : ThreadPool(o.size()) {}
+    ThreadPool &operator=(const ThreadPool &o) {
+        resize(o.size());
+        return *this;
+    }
+    ThreadPool(ThreadPool &&o) : ThreadPool(o.size()) {}
+    ThreadPool &operator=(ThreadPool &&o) {
+        resize(o.size());
+        return *this;
+    }
+    ~ThreadPool() { stop(); }
+
+    /// Number of worker threads (not including the calling thread).
+    size_t size() const { return workers.size(); }
+    /// Change the number of worker threads (no-op if it didn't change).
+    void resize(size_t num_threads) {
+        if (num_threads == size())
+            return;
+        stop();
+        start(num_threads);
+    }
+
+    /// Call `f(i)` for all `i` in `[0, num_tasks)`, using the worker threads
+    /// and the calling thread, and wait until all calls have returned.
+    /// If any of the calls throws, the first exception is rethrown after all
+    /// tasks have finished.
+    template <class F>
+    void run(size_t num_tasks, F &&f) {
+        if (workers.empty() || num_tasks <= 1) {
+            for (size_t i = 0; i < num_tasks; ++i)
+                f(i);
+            return;
+        }
+        std::function<void(size_t)> fun = std::ref(f);
+        std::unique_lock<std::mutex> lck{mtx};
+        job             = &fun;
+        this->num_tasks = num_tasks;
+        next_task       = 0;
+        completed       = 0;
+        error           = nullptr;
+        ++generation;
+        cv_start.notify_all();
+        execute_tasks(lck);
+        cv_done.wait(lck, [&] { return completed == this->num_tasks; });
+        job = nullptr;
+        if (auto e = std::exchange(error, nullptr))
+            std::rethrow_exception(e);
+    }
+
+  private:
+    void start(size_t num_threads) {
+        quit = false;
+        workers.reserve(num_threads);
+        for (size_t i = 0; i < num_threads; ++i)
+            workers.emplace_back([this] { worker_loop(); });
+    }
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lck{mtx};
+            quit = true;
+        }
+        cv_start.notify_all();
+        for (auto &t : workers)
+            t.join();
+        workers.clear();
+    }
+    void worker_loop() {
+        std::unique_lock<std::mutex> lck{mtx};
+        size_t seen = generation;
+        while (true) {
+            cv_start.wait(lck, [&] { return quit || generation != seen; });
+            if (quit)
+                return;
+            seen = generation;
+            execute_tasks(lck);
+        }
+    }
+    /// Claim and execute tasks of the current job until there are none left.
+    /// The lock is released while executing the tasks.
+    void execute_tasks(std::unique_lock<std::mutex> &lck) {
+        while (next_task < num_tasks) {
+            size_t i = next_task++;
+            lck.unlock();
+            try {
+                (*job)(i);
+            } catch (...) {
+                lck.lock();
+                if (not error)
+                    error = std::current_exception();
+                lck.unlock();
+            }
+            lck.lock();
+            if (++completed == num_tasks)
+                cv_done.notify_all();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::mutex mtx;
+    std::condition_variable cv_start, cv_done;
+    const std::function<void(size_t)> *job = nullptr;
+    size_t num_tasks = 0, next_task = 0, completed = 0, generation = 0;
+    std::exception_ptr error;
+    bool quit = false;
+};
+
+} // namespace alpaqa
@@ -2,10 +2,17 @@
 
 #include <Eigen/Core>
 
+#include <cassert>
+
 namespace alpaqa {
 
+#ifdef ALPAQA_SINGLE_PRECISION
+/// Default floating point type
+using real_t         = float;
+#else
 /// Default floating point type
-using real_t         = double; // TODO: make template?
+using real_t         = double;
+#endif
 /// Default type for floating point vectors.
 using realvec        = Eigen::Matrix<real_t, Eigen::Dynamic, 1>;
 /// Default type for floating point matrices.
@@ -50,6 +57,17 @@ real_t norm_1(const Vec &v) {
     return v.template lpNorm<1>();
 }
 
+/// Shift a vector that stores a horizon of equally-sized stages by one stage,
+/// for warm-starting receding-horizon problems. Stage k+1 is moved to stage k,
+/// and the last stage is repeated.
+template <class Vec>
+void shift_horizon(Vec &&v, Eigen::Index stage_size) {
+    auto n = v.size();
+    assert(stage_size > 0 && n % stage_size == 0);
+    for (Eigen::Index i = 0; i + stage_size < n; ++i)
+        v(i) = v(i + stage_size);
+}
+
 } // namespace vec_util
 
 } // namespace alpaqa
\ No newline at end of file
@@ -0,0 +1 @@
+#include <alpaqa/inner/directions/compact-lbfgs.hpp>
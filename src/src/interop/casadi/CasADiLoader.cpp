@@ -80,6 +80,23 @@ auto wrapped_load(const std::string &so_name, const char *name,
     });
 }
 
+/// Load the function @p name if it is present in the library, returns an
+/// empty optional otherwise. Functions that are present but that have the
+/// wrong dimensions still raise an exception.
+template <class T, class... Args>
+std::optional<T> try_wrapped_load(const std::string &so_name, const char *name,
+                                  Args &&...args) {
+    casadi::Function f;
+    try {
+        f = casadi::external(name, so_name);
+    } catch (const casadi::CasadiException &) {
+        return std::nullopt;
+    }
+    return wrap_load(so_name, name, [&] {
+        return T(std::move(f), std::forward<Args>(args)...);
+    });
+}
+
 constexpr static auto dims = [](auto... a) {
     return std::array<casadi_int, sizeof...(a)>{a...};
 };
@@ -141,7 +158,41 @@ alpaqa::Problem load_CasADi_problem(const std::string &so_name, unsigned n,
         prob.hess_L_prod =                                         //
             wrapped_load<CasADiFun_3Vi1Vo>(so_name, "hess_L_prod", //
                                            dims(n, m, n), n);      //
+        // Optional: exact Hessian-vector products of ψ(x)
+        auto hess_psi_prod = try_wrapped_load<CasADiFun_6Vi1Vo>(
+            so_name, "hess_psi_prod", dims(n, m, m, m, m, n), n);
+        if (hess_psi_prod)
+            prob.hess_ψ_prod = [hess_psi_prod{std::move(*hess_psi_prod)}](
+                                   crvec x, crvec y, crvec Σ, const Box &D,
+                                   crvec v, rvec Hv) {
+                hess_psi_prod(x, y, Σ, D.lowerbound, D.upperbound, v, Hv);
+            };
     }
+    // Optional: sparse Jacobian of the constraints
+    auto jac_g = try_wrapped_load<CasADiFun_1Vi1SMo>(so_name, "jac_g", n,
+                                                     dim(m, n));
+    if (jac_g) {
+        prob.jac_g_sparsity = jac_g->sparsity_out();
+        prob.jac_g          = std::move(*jac_g);
+    }
+    // Optional: ψ(x) and ŷ(x) in a single evaluation
+    auto psi = try_wrapped_load<CasADiFun_5Vi1So1Vo>(
+        so_name, "psi", dims(n, m, m, m, m), m);
+    if (psi)
+        prob.ψ = [psi{std::move(*psi)}](crvec x, crvec y, crvec Σ,
+                                        const Box &D, rvec ŷ) {
+            return psi(x, y, Σ, D.lowerbound, D.upperbound, ŷ);
+        };
+    // Optional: ψ(x), ∇ψ(x) and ŷ(x) in a single evaluation
+    auto psi_grad_psi = try_wrapped_load<CasADiFun_5Vi1So2Vo>(
+        so_name, "psi_grad_psi", dims(n, m, m, m, m), dims(n, m));
+    if (psi_grad_psi)
+        prob.ψ_grad_ψ = [psi_grad_psi{std::move(*psi_grad_psi)}](
+                            crvec x, crvec y, crvec Σ, const Box &D,
+                            rvec grad_ψ, rvec ŷ) {
+            return psi_grad_psi(x, y, Σ, D.lowerbound, D.upperbound, grad_ψ,
+                                ŷ);
+        };
     return prob;
 }
 
@@ -157,6 +208,10 @@ class CasADiParamWrapper
         CasADiFun_3Vi1Vo grad_g_prod;
         std::optional<CasADiFun_3Vi1Mo> hess_L;
         std::optional<CasADiFun_4Vi1Vo> hess_L_prod;
+        std::optional<CasADiFun_6Vi1So1Vo> psi;
+        std::optional<CasADiFun_6Vi1So2Vo> psi_grad_psi;
+        std::optional<CasADiFun_7Vi1Vo> hess_psi_prod;
+        std::optional<CasADiFun_2Vi1SMo> jac_g;
     } cs;
 
   private:
@@ -202,6 +257,34 @@ class CasADiParamWrapper
                 (*param->cs.hess_L_prod)(x, param->param, y, v, g);
             };
         }
+        if (param->cs.jac_g) {
+            prob.jac_g_sparsity = param->cs.jac_g->sparsity_out();
+            prob.jac_g          = [param](crvec x, rvec J_values) {
+                (*param->cs.jac_g)(x, param->param, J_values);
+            };
+        }
+        if (param->cs.psi) {
+            prob.ψ = [param](crvec x, crvec y, crvec Σ, const Box &D,
+                             rvec ŷ) {
+                return (*param->cs.psi)(x, param->param, y, Σ, D.lowerbound,
+                                        D.upperbound, ŷ);
+            };
+        }
+        if (param->cs.psi_grad_psi) {
+            prob.ψ_grad_ψ = [param](crvec x, crvec y, crvec Σ, const Box &D,
+                                    rvec grad_ψ, rvec ŷ) {
+                return (*param->cs.psi_grad_psi)(x, param->param, y, Σ,
+                                                 D.lowerbound, D.upperbound,
+                                                 grad_ψ, ŷ);
+            };
+        }
+        if (param->cs.hess_psi_prod) {
+            prob.hess_ψ_prod = [param](crvec x, crvec y, crvec Σ, const Box &D,
+                                       crvec v, rvec Hv) {
+                (*param->cs.hess_psi_prod)(x, param->param, y, Σ, D.lowerbound,
+                                           D.upperbound, v, Hv);
+            };
+        }
     }
 
     std::shared_ptr<ParamWrapper> clone() const override {
@@ -265,6 +348,17 @@ ProblemWithParam load_CasADi_problem_with_param(const std::string &so_name,
             second_order ? std::make_optional(wrapped_load<CasADiFun_4Vi1Vo>(
                                so_name, "hess_L_prod", dims(n, p, m, n), n))
                          : std::nullopt,
+            try_wrapped_load<CasADiFun_6Vi1So1Vo>(
+                so_name, "psi", dims(n, p, m, m, m, m), m),
+            try_wrapped_load<CasADiFun_6Vi1So2Vo>(so_name, "psi_grad_psi",
+                                                  dims(n, p, m, m, m, m),
+                                                  dims(n, m)),
+            second_order ? try_wrapped_load<CasADiFun_7Vi1Vo>(
+                               so_name, "hess_psi_prod",
+                               dims(n, p, m, m, m, m, n), n)
+                         : std::nullopt,
+            try_wrapped_load<CasADiFun_2Vi1SMo>(so_name, "jac_g", dims(n, p),
+                                                dim(m, n)),
         });
     prob.wrapper->wrap(prob);
     return prob;
@@ -8,6 +8,7 @@
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <vector>
 
 using namespace std::string_literals;
 
@@ -95,6 +96,34 @@ class CUTEstLoader {
         eval_lagr_hess_p        = ncon > 0                         //
                                       ? dlfun<void>("cutest_cdh_") //
                                       : dlfun<void>("cutest_udh_");
+        eval_constr_jac_p       = ncon > 0                               //
+                                      ? dlfun<void>("cutest_cint_csgr_") //
+                                      : nullptr;
+        if (ncon > 0)
+            setup_constraints_jac();
+    }
+
+    /// Determine the sparsity pattern of the constraint Jacobian. The entries
+    /// returned by cutest_csgr also include the gradient of the objective,
+    /// those are filtered out.
+    void setup_constraints_jac() {
+        integer status;
+        auto fptr_cdimsj = dlfun<decltype(CUTEST_cdimsj)>("cutest_cdimsj_");
+        fptr_cdimsj(&status, &nnzj);
+        throw_if_error("Failed to call cutest_cdimsj", status);
+        jac_val.resize(nnzj);
+        jac_var.resize(nnzj);
+        jac_fun.resize(nnzj);
+        call_constraints_jac(x);
+        jac_sparsity.rows = ncon;
+        jac_sparsity.cols = nvar;
+        for (integer k = 0; k < nnzj; ++k) {
+            if (jac_fun(k) == 0) // gradient of the objective
+                continue;
+            jac_constr_entries.push_back(k);
+            jac_sparsity.row.push_back(jac_fun(k) - 1);
+            jac_sparsity.col.push_back(jac_var(k) - 1);
+        }
     }
 
     template <class F>
@@ -192,6 +221,27 @@ class CUTEstLoader {
         throw_if_error("Failed to call cutest_ccifg", status);
     }
 
+    void call_constraints_jac(alpaqa::crvec x) const {
+        integer status;
+        integer nnz;
+        logical grlagf = false;
+        // The multipliers are not used because grlagf is false
+        call_as<decltype(CUTEST_csgr)>(eval_constr_jac_p)(
+            &status, &nvar, &ncon, x.data(), work.data(), &grlagf, &nnz, &nnzj,
+            jac_val.data(), jac_var.data(), jac_fun.data());
+        throw_if_error("Failed to call cutest_csgr", status);
+        assert(nnz == nnzj);
+    }
+
+    void eval_constraints_jac(alpaqa::crvec x, alpaqa::rvec J_values) const {
+        assert(x.size() == nvar);
+        assert(J_values.size() == jac_sparsity.nnz());
+        call_constraints_jac(x);
+        // The order of the entries is the same for every evaluation
+        for (size_t k = 0; k < jac_constr_entries.size(); ++k)
+            J_values(k) = jac_val(jac_constr_entries[k]);
+    }
+
     void eval_lagr_hess_prod(alpaqa::crvec x, alpaqa::crvec y, alpaqa::crvec v,
                              alpaqa::rvec Hv) const {
         assert(x.size() == nvar);
@@ -316,6 +366,17 @@ class CUTEstLoader {
     logical_vec linear;   ///< whether the constraint is linear
     mutable alpaqa::vec work; ///< work vector
 
+    using integer_vec = Eigen::Matrix<integer, Eigen::Dynamic, 1>;
+    integer nnzj = 0;              ///< number of nonzeros returned by csgr
+    mutable alpaqa::vec jac_val;   ///< values of the Jacobian entries
+    mutable integer_vec jac_var;   ///< variable indices of the entries
+    mutable integer_vec jac_fun;   ///< function indices of the entries
+    /// indices of the entries that belong to the constraints (not the
+    /// objective)
+    std::vector<integer> jac_constr_entries;
+    /// sparsity pattern of the constraint Jacobian
+    alpaqa::SparsityPattern jac_sparsity;
+
     void *eval_obj_p              = nullptr;
     void *eval_obj_grad_p         = nullptr;
     void *eval_constr_p           = nullptr;
@@ -323,6 +384,7 @@ class CUTEstLoader {
     void *eval_constr_i_grad_p    = nullptr;
     void *eval_lagr_hess_prod_p   = nullptr;
     void *eval_lagr_hess_p        = nullptr;
+    void *eval_constr_jac_p       = nullptr;
 };
 
 CUTEstProblem::CUTEstProblem(const char *so_fname, const char *outsdif_fname) {
@@ -355,6 +417,11 @@ CUTEstProblem::CUTEstProblem(const char *so_fname, const char *outsdif_fname) {
     problem.hess_L_prod =
         std::bind(&CUTEstLoader::eval_lagr_hess_prod, l, _1, _2, _3, _4);
     problem.hess_L = std::bind(&CUTEstLoader::eval_lagr_hess, l, _1, _2, _3);
+    if (problem.m > 0) {
+        problem.jac_g_sparsity = l->jac_sparsity;
+        problem.jac_g =
+            std::bind(&CUTEstLoader::eval_constraints_jac, l, _1, _2);
+    }
     x0             = std::move(l->x);
     y0             = std::move(l->y);
 }
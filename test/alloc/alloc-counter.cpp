@@ -0,0 +1,72 @@
+#include "alloc-counter.hpp"
+
+#include <gtest/gtest.h>
+
+#include <alpaqa/util/vec.hpp>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <memory>
+
+#ifndef __GLIBC__
+#error "Allocation counting requires glibc"
+#endif
+
+namespace {
+std::atomic<bool> counting_allocations{false};
+std::atomic<size_t> num_allocations{0};
+void count_allocation() {
+    if (counting_allocations.load(std::memory_order_relaxed))
+        num_allocations.fetch_add(1, std::memory_order_relaxed);
+}
+} // namespace
+
+AllocationCounter::AllocationCounter() {
+    num_allocations      = 0;
+    counting_allocations = true;
+}
+AllocationCounter::~AllocationCounter() { counting_allocations = false; }
+size_t AllocationCounter::count() const { return num_allocations; }
+
+// Replace the C allocation functions of glibc, so that all allocations are
+// counted, including the ones by operator new and by Eigen (which uses
+// std::malloc directly)
+extern "C" {
+void *__libc_malloc(size_t);
+void *__libc_calloc(size_t, size_t);
+void *__libc_realloc(void *, size_t);
+void *__libc_memalign(size_t, size_t);
+
+void *malloc(size_t size) noexcept {
+    count_allocation();
+    return __libc_malloc(size);
+}
+void *calloc(size_t num, size_t size) noexcept {
+    count_allocation();
+    return __libc_calloc(num, size);
+}
+void *realloc(void *ptr, size_t size) noexcept {
+    count_allocation();
+    return __libc_realloc(ptr, size);
+}
+void *aligned_alloc(size_t alignment, size_t size) noexcept {
+    count_allocation();
+    return __libc_memalign(alignment, size);
+}
+int posix_memalign(void **ptr, size_t alignment, size_t size) noexcept {
+    count_allocation();
+    *ptr = __libc_memalign(alignment, size);
+    return *ptr ? 0 : ENOMEM;
+}
+}
+
+TEST(Alloc, counter) {
+    AllocationCounter counter;
+    EXPECT_EQ(counter.count(), 0u);
+    alpaqa::vec v(10);
+    v.resize(10); // same size, no allocation
+    EXPECT_EQ(counter.count(), 1u);
+    auto p = std::make_unique<int>(42);
+    EXPECT_EQ(counter.count(), 2u);
+}
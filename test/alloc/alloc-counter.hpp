@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+
+/// Counts the heap allocations (`malloc`, `calloc`, `realloc`, aligned
+/// allocations and everything built on top of them, e.g. `operator new` and
+/// Eigen's dynamic matrices) made by all threads while it is alive.
+/// The allocation functions of glibc are replaced in alloc-counter.cpp, for
+/// the whole executable, which is why these tests have their own executable
+/// (see CMakeLists.txt).
+class AllocationCounter {
+  public:
+    AllocationCounter();
+    ~AllocationCounter();
+    AllocationCounter(const AllocationCounter &)            = delete;
+    AllocationCounter &operator=(const AllocationCounter &) = delete;
+
+    /// Number of allocations since the counter was created.
+    size_t count() const;
+};
@@ -0,0 +1,118 @@
+#include <alpaqa/alm.hpp>
+#include <alpaqa/inner/directions/lbfgs.hpp>
+#include <alpaqa/inner/guarded-aa-pga.hpp>
+#include <alpaqa/inner/panoc.hpp>
+#include <alpaqa/inner/second-order-panoc.hpp>
+#include <alpaqa/inner/structured-panoc-lbfgs.hpp>
+
+#include "alloc-counter.hpp"
+#include "eigen-matchers.hpp"
+#include "equality-problem.hpp"
+
+namespace {
+
+/// Solve the problem twice with the same solver, and check that the second
+/// solve (which reuses the workspaces of the ALM and inner solvers) gives
+/// identical results without allocating any memory.
+template <class InnerSolver>
+void check_reuse_workspace(alpaqa::ALMSolver<InnerSolver> &solver,
+                           const alpaqa::Problem &p) {
+    using namespace alpaqa;
+    SCOPED_TRACE(solver.get_name());
+    vec x₀(2), y₀(1);
+    x₀ << 0.5, 0.5;
+    y₀ << 1;
+    vec x1 = x₀, y1 = y₀;
+    auto stats1 = solver(p, y1, x1);
+    vec x2 = x₀, y2 = y₀;
+    size_t allocations;
+    typename ALMSolver<InnerSolver>::Stats stats2;
+    {
+        AllocationCounter counter;
+        stats2      = solver(p, y2, x2);
+        allocations = counter.count();
+    }
+
+    EXPECT_EQ(stats1.status, SolverStatus::Converged);
+    EXPECT_EQ(stats1.status, stats2.status);
+    EXPECT_EQ(stats1.outer_iterations, stats2.outer_iterations);
+    EXPECT_EQ(stats1.inner.iterations, stats2.inner.iterations);
+    EXPECT_THAT(print_wrap(x2), EigenEqual(print_wrap(x1)));
+    EXPECT_THAT(print_wrap(y2), EigenEqual(print_wrap(y1)));
+    EXPECT_NEAR(x1(0), -10. / 22, 1e-6);
+    EXPECT_EQ(allocations, 0u);
+}
+
+} // namespace
+
+TEST(ALM, reuseWorkspace) {
+    using namespace alpaqa;
+    auto p        = build_equality_problem();
+    auto almparam = build_equality_alm_params();
+
+    PANOCParams panocparam;
+    panocparam.max_iter = 100;
+    LBFGSParams lbfgsparam;
+    lbfgsparam.memory = 5;
+
+    ALMSolver<> panoc{almparam, {panocparam, lbfgsparam}};
+    check_reuse_workspace(panoc, p);
+
+    StructuredPANOCLBFGSParams spanocparam;
+    spanocparam.max_iter = 100;
+    ALMSolver<StructuredPANOCLBFGSSolver> spanoc{almparam,
+                                                 {spanocparam, lbfgsparam}};
+    check_reuse_workspace(spanoc, p);
+
+    GAAPGAParams gaapgaparam;
+    gaapgaparam.max_iter = 1000;
+    ALMSolver<GAAPGASolver> gaapga{almparam, gaapgaparam};
+    check_reuse_workspace(gaapga, p);
+
+    SecondOrderPANOCParams sopanocparam;
+    sopanocparam.max_iter = 100;
+    ALMSolver<SecondOrderPANOCSolver> sopanoc{almparam, sopanocparam};
+    check_reuse_workspace(sopanoc, p);
+    sopanocparam.hessian_update_interval = 3;
+    ALMSolver<SecondOrderPANOCSolver> sopanoc_reuse{almparam, sopanocparam};
+    check_reuse_workspace(sopanoc_reuse, p);
+
+    // The preconditioned problem is kept in the ALM workspace as well
+    almparam.preconditioning = true;
+    ALMSolver<> prec_panoc{almparam, {panocparam, lbfgsparam}};
+    check_reuse_workspace(prec_panoc, p);
+}
+
+TEST(ALM, warmStartStateNoAllocations) {
+    using namespace alpaqa;
+    auto p        = build_equality_problem();
+    auto almparam = build_equality_alm_params();
+
+    PANOCParams panocparam;
+    panocparam.max_iter                 = 100;
+    panocparam.keep_direction_history   = true;
+    panocparam.reuse_lipschitz_estimate = true;
+    LBFGSParams lbfgsparam;
+    lbfgsparam.memory = 5;
+
+    ALMSolver<> solver{almparam, {panocparam, lbfgsparam}};
+    ALMSolver<>::State state;
+    vec x(2), y(1);
+    x << 0.5, 0.5;
+    y << 1;
+    auto stats1 = solver(p, y, x, state);
+    EXPECT_EQ(stats1.status, SolverStatus::Converged);
+
+    // Solving a perturbed problem from the previous state, and saving the
+    // state again, reuses the storage of the solver and of the state
+    p = build_equality_problem(0.6);
+    size_t allocations;
+    ALMSolver<>::Stats stats2;
+    {
+        AllocationCounter counter;
+        stats2      = solver(p, y, x, state);
+        allocations = counter.count();
+    }
+    EXPECT_EQ(stats2.status, SolverStatus::Converged);
+    EXPECT_EQ(allocations, 0u);
+}
@@ -0,0 +1,36 @@
+#include <alpaqa/inner/directions/lbfgs.hpp>
+
+#include "alloc-counter.hpp"
+#include "eigen-matchers.hpp"
+
+TEST(LBFGS, packedSubspaceNoAllocations) {
+    using namespace alpaqa;
+    const size_t n = 8;
+    LBFGSParams param;
+    param.memory          = 3;
+    param.packed_subspace = true;
+    LBFGS lbfgs(param, n);
+
+    vec x = vec::LinSpaced(n, -1, 1), x_new(n);
+    vec r = 2 * x, r_new(n), q(n);
+    std::vector<vec::Index> J1{0, 2, 3, 5, 7}, J2{1, 2, 3, 4, 5, 6}, J3{4};
+    size_t allocations;
+    {
+        AllocationCounter counter;
+        for (size_t i = 0; i < 6; ++i) {
+            x_new = x - 0.1 * r;
+            r_new = 2 * x_new;
+            EXPECT_TRUE(
+                lbfgs.update(x, x_new, r, r_new, LBFGS::Sign::Positive));
+            x.swap(x_new);
+            r.swap(r_new);
+            // Changing the size of the index set J reuses the packed storage
+            for (const auto *J : {&J1, &J2, &J3}) {
+                q = r;
+                EXPECT_TRUE(lbfgs.apply(q, -1, *J));
+            }
+        }
+        allocations = counter.count();
+    }
+    EXPECT_EQ(allocations, 0);
+}
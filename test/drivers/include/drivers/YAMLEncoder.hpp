@@ -216,6 +216,9 @@ inline YAML::Emitter &operator<<(
     out << YAML::Key << "τ_1_accepted" << YAML::Value << s.τ_1_accepted;
     out << YAML::Key << "sum_τ" << YAML::Value << s.sum_τ;
     out << YAML::Key << "count_τ" << YAML::Value << s.count_τ;
+    out << YAML::Key << "factorizations" << YAML::Value << s.factorizations;
+    out << YAML::Key << "factorization_updates" << YAML::Value
+        << s.factorization_updates;
     out << YAML::EndMap;
     return out;
 }
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <alpaqa/decl/alm.hpp>
+#include <alpaqa/util/problem.hpp>
+
+#include <algorithm>
+
+/// minimize 10 x₁² + x₀²  s.t.  -1 ≤ x₀ ≤ 1,  c + x₀ - x₁ = 0
+inline alpaqa::Problem build_equality_problem(alpaqa::real_t c = 0.5) {
+    using namespace alpaqa;
+    Problem p{2, 1};
+    p.C.lowerbound << -1, -inf;
+    p.C.upperbound << 1, inf;
+    p.D.lowerbound << 0;
+    p.D.upperbound << 0;
+    p.f      = [](crvec ux) { return 10 * ux(1) * ux(1) + ux(0) * ux(0); };
+    p.grad_f = [](crvec ux, rvec grad_f) {
+        grad_f(0) = 2 * ux(0);
+        grad_f(1) = 20 * ux(1);
+    };
+    p.g           = [c](crvec ux, rvec g_u) { g_u(0) = c + ux(0) - ux(1); };
+    p.grad_g_prod = [](crvec, crvec v, rvec grad_u_v) {
+        grad_u_v(0) = v(0);
+        grad_u_v(1) = -v(0);
+    };
+    p.grad_gi = [](crvec, unsigned, rvec grad_gi) {
+        grad_gi(0) = 1;
+        grad_gi(1) = -1;
+    };
+    p.hess_L_prod = [](crvec, crvec, crvec v, rvec Hv) {
+        Hv(0) = 2 * v(0);
+        Hv(1) = 20 * v(1);
+    };
+    p.hess_L = [](crvec, crvec, rmat H) {
+        H.setZero();
+        H(0, 0) = 2;
+        H(1, 1) = 20;
+    };
+    return p;
+}
+
+/// ALM parameters for @ref build_equality_problem, with the given tolerance
+/// on the stationarity and the constraint violation.
+inline alpaqa::ALMParams build_equality_alm_params(alpaqa::real_t tol = 1e-8) {
+    alpaqa::ALMParams almparam;
+    almparam.ε        = tol;
+    almparam.δ        = tol;
+    almparam.Δ        = 5;
+    almparam.Σ₀       = 1;
+    almparam.ε₀       = std::max<alpaqa::real_t>(1e-4, tol);
+    almparam.max_iter = 20;
+    return almparam;
+}
@@ -1,8 +1,12 @@
-#include <alpaqa/decl/alm.hpp>
-#include <alpaqa/inner/decl/panoc.hpp>
-#include <alpaqa/inner/directions/decl/lbfgs.hpp>
+#include <alpaqa/alm.hpp>
+#include <alpaqa/inner/directions/lbfgs.hpp>
+#include <alpaqa/inner/guarded-aa-pga.hpp>
+#include <alpaqa/inner/panoc.hpp>
+#include <alpaqa/inner/second-order-panoc.hpp>
+#include <alpaqa/inner/structured-panoc-lbfgs.hpp>
 
 #include "eigen-matchers.hpp"
+#include "equality-problem.hpp"
 
 TEST(ALM, singleshooting1D) {
     using namespace alpaqa;
@@ -291,3 +295,242 @@ TEST(ALM, multipleshooting8D) {
     // EXPECT_NEAR(y(6), 3.54023, ε);
     // EXPECT_NEAR(y(7), 22.8086, ε);
 }
+
+namespace {
+struct StaticTestProblem {
+    unsigned n = 2, m = 1;
+    alpaqa::Box C, D;
+    alpaqa::real_t f(alpaqa::crvec ux) const {
+        return 10 * ux(1) * ux(1) + ux(0) * ux(0);
+    }
+    void grad_f(alpaqa::crvec ux, alpaqa::rvec grad_f) const {
+        grad_f(0) = 2 * ux(0);
+        grad_f(1) = 20 * ux(1);
+    }
+    void g(alpaqa::crvec ux, alpaqa::rvec g_u) const {
+        g_u(0) = 0.5 + ux(0) - ux(1);
+    }
+    void grad_g_prod(alpaqa::crvec, alpaqa::crvec v,
+                     alpaqa::rvec grad_u_v) const {
+        grad_u_v(0) = v(0);
+        grad_u_v(1) = -v(0);
+    }
+};
+} // namespace
+
+static_assert(alpaqa::is_static_problem_v<StaticTestProblem>);
+static_assert(not alpaqa::is_static_problem_v<alpaqa::Problem>);
+
+TEST(ALM, staticProblem) {
+    using namespace alpaqa;
+
+    StaticTestProblem sp;
+    sp.C = Box{vec(2), vec(2)};
+    sp.C.lowerbound << -1, -inf;
+    sp.C.upperbound << 1, inf;
+    sp.D = Box{vec(1), vec(1)};
+    sp.D.lowerbound << 0;
+    sp.D.upperbound << 0;
+    Problem p = make_problem_view(sp);
+
+    ALMParams almparam;
+    almparam.ε        = 1e-8;
+    almparam.δ        = 1e-8;
+    almparam.Δ        = 5;
+    almparam.Σ₀       = 1;
+    almparam.ε₀       = 1e-4;
+    almparam.max_iter = 20;
+
+    PANOCParams panocparam;
+    panocparam.max_iter = 100;
+
+    LBFGSParams lbfgsparam;
+    lbfgsparam.memory = 5;
+
+    ALMSolver<> solver{almparam, {panocparam, lbfgsparam}};
+
+    // The static and type-erased interfaces should give identical results
+    vec x₀(2), y₀(1);
+    x₀ << 0.5, 0.5;
+    y₀ << 1;
+    vec x1 = x₀, y1 = y₀;
+    auto stats1 = solver(p, y1, x1);
+    vec x2 = x₀, y2 = y₀;
+    auto stats2 = solver(sp, y2, x2);
+
+    EXPECT_EQ(stats1.status, SolverStatus::Converged);
+    EXPECT_EQ(stats1.status, stats2.status);
+    EXPECT_EQ(stats1.inner.iterations, stats2.inner.iterations);
+    EXPECT_THAT(print_wrap(x2), EigenEqual(print_wrap(x1)));
+    EXPECT_THAT(print_wrap(y2), EigenEqual(print_wrap(y1)));
+    EXPECT_NEAR(x2(0), -10. / 22, 1e-6);
+}
+
+TEST(ALM, keepDirectionHistory) {
+    using namespace alpaqa;
+
+    auto p        = build_equality_problem();
+    auto almparam = build_equality_alm_params();
+
+    PANOCParams panocparam;
+    panocparam.max_iter = 100;
+
+    LBFGSParams lbfgsparam;
+    lbfgsparam.memory                 = 5;
+    lbfgsparam.rescale_when_γ_changes = true;
+
+    ALMSolver<> solver{almparam, {panocparam, lbfgsparam}};
+    panocparam.keep_direction_history = true;
+    ALMSolver<> solver_keep{almparam, {panocparam, lbfgsparam}};
+
+    vec x₀(2), y₀(1);
+    x₀ << 0.5, 0.5;
+    y₀ << 1;
+    vec x1 = x₀, y1 = y₀;
+    auto stats1 = solver(p, y1, x1);
+    vec x2 = x₀, y2 = y₀;
+    auto stats2 = solver_keep(p, y2, x2);
+
+    EXPECT_EQ(stats1.status, SolverStatus::Converged);
+    EXPECT_EQ(stats2.status, SolverStatus::Converged);
+    EXPECT_THAT(print_wrap(x2), EigenAlmostEqual(print_wrap(x1), 1e-6));
+    EXPECT_THAT(print_wrap(y2), EigenAlmostEqual(print_wrap(y1), 1e-6));
+    EXPECT_LT(stats2.inner.iterations, stats1.inner.iterations);
+
+    // Without a warm-start state, the history of the previous solve is
+    // discarded, so the next solve should be identical to the first one
+    vec x3 = x₀, y3 = y₀;
+    auto stats3 = solver_keep(p, y3, x3);
+    EXPECT_EQ(stats3.inner.iterations, stats2.inner.iterations);
+    EXPECT_THAT(print_wrap(x3), EigenEqual(print_wrap(x2)));
+    EXPECT_THAT(print_wrap(y3), EigenEqual(print_wrap(y2)));
+}
+
+TEST(ALM, reuseLipschitzEstimate) {
+    using namespace alpaqa;
+
+    ProblemWithCounters<Problem> p1{build_equality_problem()};
+    ProblemWithCounters<Problem> p2{build_equality_problem()};
+    auto almparam = build_equality_alm_params();
+
+    PANOCParams panocparam;
+    panocparam.max_iter = 100;
+
+    LBFGSParams lbfgsparam;
+    lbfgsparam.memory = 5;
+
+    ALMSolver<> solver{almparam, {panocparam, lbfgsparam}};
+    panocparam.reuse_lipschitz_estimate = true;
+    ALMSolver<> solver_reuse{almparam, {panocparam, lbfgsparam}};
+
+    vec x₀(2), y₀(1);
+    x₀ << 0.5, 0.5;
+    y₀ << 1;
+    vec x1 = x₀, y1 = y₀;
+    auto stats1 = solver(p1, y1, x1);
+    vec x2 = x₀, y2 = y₀;
+    auto stats2 = solver_reuse(p2, y2, x2);
+
+    EXPECT_EQ(stats1.status, SolverStatus::Converged);
+    EXPECT_EQ(stats2.status, SolverStatus::Converged);
+    EXPECT_THAT(print_wrap(x2), EigenAlmostEqual(print_wrap(x1), 1e-6));
+    EXPECT_THAT(print_wrap(y2), EigenAlmostEqual(print_wrap(y1), 1e-6));
+    // Only the first inner solve needs a finite-difference estimate
+    EXPECT_LT(p2.evaluations->grad_f, p1.evaluations->grad_f);
+}
+
+TEST(ALM, warmStartState) {
+    using namespace alpaqa;
+    auto p        = build_equality_problem();
+    auto almparam = build_equality_alm_params();
+
+    PANOCParams panocparam;
+    panocparam.max_iter                 = 100;
+    panocparam.keep_direction_history   = true;
+    panocparam.reuse_lipschitz_estimate = true;
+
+    LBFGSParams lbfgsparam;
+    lbfgsparam.memory = 5;
+
+    ALMSolver<> solver{almparam, {panocparam, lbfgsparam}};
+    ALMSolver<>::State state;
+
+    vec x₀(2), y₀(1);
+    x₀ << 0.5, 0.5;
+    y₀ << 1;
+    vec x1 = x₀, y1 = y₀;
+    auto stats1 = solver(p, y1, x1, state);
+    EXPECT_EQ(stats1.status, SolverStatus::Converged);
+    EXPECT_TRUE(state.valid);
+    ASSERT_EQ(state.Σ.size(), 1);
+    EXPECT_LE(state.ε, almparam.ε);
+    EXPECT_TRUE(state.inner.prev_call.valid);
+    EXPECT_TRUE(state.inner.direction_provider.has_value());
+
+    // Solving a perturbed problem starting from the previous state should
+    // use the final penalty and tolerance of the previous solve right away
+    solver.inner_solver.reset_warm_start();
+    p           = build_equality_problem(0.6);
+    vec x2      = x₀, y2 = y₀;
+    auto stats2 = solver(p, y2, x2, state);
+    solver.inner_solver.reset_warm_start();
+    vec x3 = x₀, y3 = y₀;
+    auto stats3 = solver(p, y3, x3);
+
+    EXPECT_EQ(stats2.status, SolverStatus::Converged);
+    EXPECT_EQ(stats3.status, SolverStatus::Converged);
+    EXPECT_THAT(print_wrap(x2), EigenAlmostEqual(print_wrap(x3), 1e-6));
+    EXPECT_THAT(print_wrap(y2), EigenAlmostEqual(print_wrap(y3), 1e-6));
+    EXPECT_LT(stats2.outer_iterations, stats3.outer_iterations);
+}
+
+TEST(ALM, warmStartStateUnconstrained) {
+    using namespace alpaqa;
+    auto equality = build_equality_problem();
+    Problem p{2, 0};
+    p.C           = equality.C;
+    p.f           = equality.f;
+    p.grad_f      = equality.grad_f;
+    p.g           = [](crvec, rvec) {};
+    p.grad_g_prod = [](crvec, crvec, rvec grad_u_v) { grad_u_v.setZero(); };
+    ProblemWithCounters<Problem> p1{p}, p2{p};
+    auto almparam = build_equality_alm_params();
+
+    PANOCParams panocparam;
+    panocparam.max_iter                 = 100;
+    panocparam.keep_direction_history   = true;
+    panocparam.reuse_lipschitz_estimate = true;
+
+    LBFGSParams lbfgsparam;
+    lbfgsparam.memory = 5;
+
+    ALMSolver<> solver1{almparam, {panocparam, lbfgsparam}};
+    ALMSolver<> solver2{almparam, {panocparam, lbfgsparam}};
+    ALMSolver<>::State state;
+
+    vec x₀(2), y₀(0);
+    x₀ << 0.5, 0.5;
+    vec x1 = x₀, y1 = y₀;
+    auto stats1 = solver1(p1, y1, x1, state);
+    EXPECT_EQ(stats1.status, SolverStatus::Converged);
+    EXPECT_TRUE(state.valid);
+    EXPECT_TRUE(state.inner.prev_call.valid);
+
+    // The state of the inner solver is restored even without constraints, so
+    // a different solver continues where the first one left off
+    vec x2 = x₀, y2 = y₀;
+    auto stats2 = solver2(p2, y2, x2, state);
+    EXPECT_EQ(stats2.status, SolverStatus::Converged);
+    EXPECT_THAT(print_wrap(x2), EigenAlmostEqual(print_wrap(x1), 1e-6));
+    EXPECT_LT(p2.evaluations->grad_f, p1.evaluations->grad_f);
+}
+
+TEST(ALM, shiftHorizon) {
+    using namespace alpaqa;
+    vec v(6);
+    v << 1, 2, 3, 4, 5, 6;
+    vec_util::shift_horizon(v, 2);
+    vec expected(6);
+    expected << 3, 4, 5, 6, 5, 6;
+    EXPECT_THAT(print_wrap(v), EigenEqual(print_wrap(expected)));
+}
@@ -0,0 +1,127 @@
+#include <alpaqa/batch-alm.hpp>
+#include <alpaqa/inner/directions/lbfgs.hpp>
+#include <alpaqa/inner/panoc.hpp>
+
+#include "eigen-matchers.hpp"
+
+#include <memory>
+#include <stdexcept>
+
+using namespace alpaqa;
+
+namespace {
+
+/// minimize (x₀ - p)² + x₁² + x₂²  s.t.  x₀ + x₁ + x₂ = 1
+class ShiftedQuadratic : public ParamWrapper {
+  public:
+    ShiftedQuadratic() : ParamWrapper(1) {}
+
+    void wrap(Problem &p) override {
+        p.f = [this](crvec x) {
+            return (x(0) - param(0)) * (x(0) - param(0)) + x(1) * x(1) +
+                   x(2) * x(2);
+        };
+        p.grad_f = [this](crvec x, rvec g) {
+            if (param(0) < 0)
+                throw std::domain_error("negative parameter");
+            g(0) = 2 * (x(0) - param(0));
+            g(1) = 2 * x(1);
+            g(2) = 2 * x(2);
+        };
+        p.g           = [](crvec x, rvec g) { g(0) = x.sum() - 1; };
+        p.grad_g_prod = [](crvec, crvec y, rvec g) { g.fill(y(0)); };
+    }
+    std::shared_ptr<ParamWrapper> clone() const override {
+        return std::make_shared<ShiftedQuadratic>(*this);
+    }
+
+    static ProblemWithParam create() {
+        ProblemWithParam p{3, 1};
+        p.C.lowerbound = vec::Constant(3, -10);
+        p.C.upperbound = vec::Constant(3, +10);
+        p.D.lowerbound = vec::Zero(1);
+        p.D.upperbound = vec::Zero(1);
+        p.wrapper      = std::make_shared<ShiftedQuadratic>();
+        p.wrapper->wrap(p);
+        return p;
+    }
+};
+
+/// Solve the batch in parallel with different numbers of threads and check
+/// that the results are identical to those of the serial solves.
+void check_matches_serial(const PANOCParams &panocparam) {
+    auto problem = ShiftedQuadratic::create();
+
+    ALMParams almparam;
+    almparam.ε        = 1e-8;
+    almparam.δ        = 1e-8;
+    almparam.max_iter = 50;
+    LBFGSParams lbfgsparam;
+    ALMSolver<> solver{almparam, {panocparam, lbfgsparam}};
+
+    const Eigen::Index N = 11;
+    mat param            = mat::Zero(1, N);
+    for (Eigen::Index i = 0; i < N; ++i)
+        param(0, i) = 0.5 * static_cast<real_t>(i);
+
+    // Reference solutions, solved one after the other
+    mat x_ref = mat::Zero(3, N), y_ref = mat::Zero(1, N);
+    for (Eigen::Index i = 0; i < N; ++i) {
+        problem.set_param(crvec{param.col(i)});
+        auto stats = solver(problem, y_ref.col(i), x_ref.col(i));
+        ASSERT_EQ(stats.status, SolverStatus::Converged);
+    }
+
+    for (unsigned num_threads : {1, 2, 3}) {
+        for (bool work_stealing : {false, true}) {
+            BatchALMParams batchparam;
+            batchparam.num_threads   = num_threads;
+            batchparam.chunk_size    = 2;
+            batchparam.work_stealing = work_stealing;
+            BatchALMSolver<> batch{batchparam, solver};
+
+            mat x = mat::Zero(3, N), y = mat::Zero(1, N);
+            auto stats = batch(problem, param, y, x);
+            ASSERT_EQ(stats.size(), static_cast<size_t>(N));
+            for (auto &s : stats)
+                EXPECT_EQ(s.status, SolverStatus::Converged);
+            EXPECT_THAT(print_wrap(x), EigenAlmostEqual(print_wrap(x_ref), 0));
+            EXPECT_THAT(print_wrap(y), EigenAlmostEqual(print_wrap(y_ref), 0));
+        }
+    }
+
+    // Analytical solution: x₀ = (1 + 2p) / 3, x₁ = x₂ = (1 - p) / 3
+    for (Eigen::Index i = 0; i < N; ++i) {
+        real_t p = param(0, i);
+        EXPECT_NEAR(x_ref(0, i), (1 + 2 * p) / 3, 1e-6);
+        EXPECT_NEAR(x_ref(1, i), (1 - p) / 3, 1e-6);
+        EXPECT_NEAR(x_ref(2, i), (1 - p) / 3, 1e-6);
+    }
+}
+
+} // namespace
+
+TEST(BatchALM, matchesSerial) { check_matches_serial(PANOCParams{}); }
+
+TEST(BatchALM, matchesSerialWarmStartOptions) {
+    // The state that these options keep between calls of the inner solver
+    // must not leak from one instance to the next one of the same worker
+    PANOCParams panocparam;
+    panocparam.keep_direction_history   = true;
+    panocparam.reuse_lipschitz_estimate = true;
+    check_matches_serial(panocparam);
+}
+
+TEST(BatchALM, exception) {
+    auto problem = ShiftedQuadratic::create();
+
+    ALMSolver<> solver{ALMParams{}, {PANOCParams{}, LBFGSParams{}}};
+    BatchALMParams batchparam;
+    batchparam.num_threads = 4;
+    BatchALMSolver<> batch{batchparam, solver};
+
+    mat param(1, 8);
+    param << 1, 2, 3, -1, 5, 6, 7, 8;
+    mat x = mat::Zero(3, 8), y = mat::Zero(1, 8);
+    EXPECT_THROW(batch(problem, param, y, x), std::domain_error);
+}
@@ -0,0 +1,211 @@
+#include "eigen-matchers.hpp"
+#include <gtest/gtest.h>
+
+#include <alpaqa/inner/batched-panoc.hpp>
+#include <alpaqa/inner/directions/lbfgs.hpp>
+#include <alpaqa/inner/panoc.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace alpaqa;
+
+namespace {
+
+/// minimize  Σⱼ aⱼ (xⱼ - cⱼ)² + ½ x₀ x₁   s.t.  -1 ≤ x ≤ 1,  Σⱼ xⱼ ≤ ½
+/// with different a and c for each instance (one row per instance).
+struct TestData {
+    mat a, c;
+
+    TestData() : a(5, 3), c(5, 3) {
+        a << 1, 2, 3,     //
+            4, 1, 1,      //
+            1, 1, 1,      //
+            10, 0.5, 2,   //
+            1, 5, 1;      //
+        c << 0.5, 0.5, 0, //
+            -2, 1, 0.3,   //
+            0, 0, 0,      //
+            0.7, 0.7, 0.7, //
+            3, -3, 0.2;   //
+    }
+
+    /// Number of evaluations of each instance.
+    struct Evaluations {
+        Eigen::Matrix<unsigned, Eigen::Dynamic, 1> f, grad_f, g, grad_g_prod;
+    };
+    std::shared_ptr<Evaluations> evaluations = std::make_shared<Evaluations>();
+
+    /// Only evaluates the selected instances, and counts their evaluations.
+    BatchedProblem batched() const {
+        auto B = a.rows();
+        for (auto *c : {&evaluations->f, &evaluations->grad_f, &evaluations->g,
+                        &evaluations->grad_g_prod})
+            c->setZero(B);
+        auto count = [](auto &c, const lane_mask &lanes) {
+            c += lanes.cast<unsigned>().matrix();
+        };
+        BatchedProblem p;
+        p.n            = 3;
+        p.m            = 1;
+        p.C.lowerbound = vec::Constant(3, -1);
+        p.C.upperbound = vec::Constant(3, +1);
+        p.D.lowerbound = vec::Constant(1, -inf);
+        p.D.upperbound = vec::Constant(1, 0.5);
+        p.f = [this, count](const lane_mask &lanes, crmat x, rvec f) {
+            count(evaluations->f, lanes);
+            for (Eigen::Index b = 0; b < x.rows(); ++b)
+                if (lanes(b))
+                    f(b) = a.row(b).dot((x.row(b) - c.row(b)).cwiseAbs2()) +
+                           0.5 * x(b, 0) * x(b, 1);
+        };
+        p.grad_f = [this, count](const lane_mask &lanes, crmat x, rmat grad) {
+            count(evaluations->grad_f, lanes);
+            for (Eigen::Index b = 0; b < x.rows(); ++b) {
+                if (not lanes(b))
+                    continue;
+                grad.row(b) = 2 * a.row(b).cwiseProduct(x.row(b) - c.row(b));
+                grad(b, 0) += 0.5 * x(b, 1);
+                grad(b, 1) += 0.5 * x(b, 0);
+            }
+        };
+        p.g = [this, count](const lane_mask &lanes, crmat x, rmat g) {
+            count(evaluations->g, lanes);
+            for (Eigen::Index b = 0; b < x.rows(); ++b)
+                if (lanes(b))
+                    g(b, 0) = x.row(b).sum();
+        };
+        p.grad_g_prod = [this, count](const lane_mask &lanes, crmat, crmat y,
+                                      rmat grad) {
+            count(evaluations->grad_g_prod, lanes);
+            for (Eigen::Index b = 0; b < y.rows(); ++b)
+                if (lanes(b))
+                    grad.row(b).fill(y(b, 0));
+        };
+        return p;
+    }
+
+    Problem instance(Eigen::Index b) const {
+        Problem p{3, 1};
+        p.C.lowerbound = vec::Constant(3, -1);
+        p.C.upperbound = vec::Constant(3, +1);
+        p.D.lowerbound = vec::Constant(1, -inf);
+        p.D.upperbound = vec::Constant(1, 0.5);
+        vec ab = a.row(b).transpose(), cb = c.row(b).transpose();
+        p.f    = [ab, cb](crvec x) {
+            return ab.dot((x - cb).cwiseAbs2()) + 0.5 * x(0) * x(1);
+        };
+        p.grad_f = [ab, cb](crvec x, rvec grad) {
+            grad = 2 * ab.cwiseProduct(x - cb);
+            grad(0) += 0.5 * x(1);
+            grad(1) += 0.5 * x(0);
+        };
+        p.g           = [](crvec x, rvec g) { g(0) = x.sum(); };
+        p.grad_g_prod = [](crvec, crvec y, rvec grad) { grad.fill(y(0)); };
+        return p;
+    }
+};
+
+/// Solve all instances with the batched solver and with PANOCSolver, and check
+/// that the iterates, the number of iterations and the number of evaluations
+/// of each instance are the same.
+void check_matches_panoc(const PANOCParams &params,
+                         const LBFGSParams &lbfgsparams) {
+    TestData data;
+    auto problem         = data.batched();
+    const Eigen::Index B = data.a.rows();
+    real_t ε             = 1e-10;
+
+    mat Σ = mat::Constant(B, 1, 10);
+    mat x = mat::Zero(B, 3), y = mat::Zero(B, 1), err_z(B, 1);
+    y(1, 0) = 1;
+
+    std::vector<std::vector<vec>> iterates(B);
+    BatchedPANOCSolver solver{params, lbfgsparams};
+    solver.set_progress_callback([&](const BatchedPANOCSolver::ProgressInfo &i) {
+        for (Eigen::Index b = 0; b < B; ++b)
+            if (i.active(b))
+                iterates[b].push_back(i.x.row(b).transpose());
+    });
+    auto stats = solver(problem, Σ, ε, false, x, y, err_z);
+
+    unsigned lbfgs_rejected = 0;
+    PANOCSolver<LBFGS> ref_solver{params, lbfgsparams};
+    for (Eigen::Index b = 0; b < B; ++b) {
+        SCOPED_TRACE("instance " + std::to_string(b));
+        ProblemWithCounters<Problem> ref_problem{data.instance(b)};
+        vec x_ref = vec::Zero(3), y_ref(1), err_z_ref(1);
+        y_ref(0)  = b == 1 ? 1 : 0;
+        vec Σ_ref = Σ.row(b).transpose();
+        std::vector<vec> ref_iterates;
+        ref_solver.set_progress_callback(
+            [&](const PANOCSolver<LBFGS>::ProgressInfo &i) {
+                ref_iterates.push_back(i.x);
+            });
+        auto ref_stats = ref_solver(ref_problem, Σ_ref, ε, false, x_ref, y_ref,
+                                    err_z_ref);
+        lbfgs_rejected += ref_stats.lbfgs_rejected;
+
+        ASSERT_EQ(ref_stats.status, SolverStatus::Converged);
+        EXPECT_EQ(stats.status[b], SolverStatus::Converged);
+        EXPECT_EQ(stats.iterations[b], ref_stats.iterations);
+        EXPECT_LE(stats.ε(b), ε);
+        ASSERT_EQ(iterates[b].size(), ref_iterates.size());
+        for (size_t k = 0; k < ref_iterates.size(); ++k)
+            EXPECT_THAT(print_wrap(iterates[b][k]),
+                        EigenAlmostEqual(print_wrap(ref_iterates[k]), 1e-10))
+                << "k = " << k;
+        EXPECT_THAT(print_wrap(x.row(b).transpose()),
+                    EigenAlmostEqual(print_wrap(x_ref), 1e-10));
+        EXPECT_THAT(print_wrap(y.row(b).transpose()),
+                    EigenAlmostEqual(print_wrap(y_ref), 1e-10));
+        EXPECT_THAT(print_wrap(err_z.row(b).transpose()),
+                    EigenAlmostEqual(print_wrap(err_z_ref), 1e-10));
+
+        // Instances are only evaluated while they are still running
+        auto &evals = *data.evaluations;
+        EXPECT_EQ(evals.f(b), ref_problem.evaluations->f);
+        EXPECT_EQ(evals.grad_f(b), ref_problem.evaluations->grad_f);
+        EXPECT_EQ(evals.g(b), ref_problem.evaluations->g);
+        EXPECT_EQ(evals.grad_g_prod(b), ref_problem.evaluations->grad_g_prod);
+    }
+    EXPECT_EQ(stats.lbfgs_rejected, lbfgs_rejected);
+    EXPECT_EQ(stats.batch_iterations, *std::max_element(
+                                          stats.iterations.begin(),
+                                          stats.iterations.end()));
+}
+
+} // namespace
+
+TEST(BatchedPANOC, matchesPANOC) {
+    PANOCParams params;
+    params.max_iter = 200;
+    LBFGSParams lbfgsparams;
+    lbfgsparams.memory = 5;
+    check_matches_panoc(params, lbfgsparams);
+}
+
+TEST(BatchedPANOC, matchesPANOCRejectedUpdates) {
+    PANOCParams params;
+    params.max_iter       = 200;
+    params.lbfgs_stepsize = LBFGSStepSize::BasedOnGradientStepSize;
+    LBFGSParams lbfgsparams;
+    lbfgsparams.memory  = 3;
+    lbfgsparams.cbfgs.ϵ = 10;
+    check_matches_panoc(params, lbfgsparams);
+}
+
+TEST(BatchedPANOC, unsupportedStopCrit) {
+    TestData data;
+    auto problem = data.batched();
+    PANOCParams params;
+    params.stop_crit = PANOCStopCrit::Ipopt;
+    BatchedPANOCSolver solver{params, LBFGSParams{}};
+    mat Σ = mat::Ones(5, 1), x = mat::Zero(5, 3), y = mat::Zero(5, 1),
+        err_z(5, 1);
+    EXPECT_THROW(solver(problem, Σ, 1e-8, false, x, y, err_z),
+                 std::invalid_argument);
+}
@@ -16,3 +16,31 @@ TEST(Box, project) {
     result = alpaqa::project(v, b);
     EXPECT_THAT(print_wrap(result), EigenEqual(print_wrap(expected)));
 }
+
+TEST(Box, projectNaNInf) {
+    using alpaqa::inf;
+    // Odd size, so both the packet operations and the scalar operations for
+    // the remaining element are exercised (when vectorization is enabled)
+    alpaqa::Box b{alpaqa::vec(5), alpaqa::vec(5)};
+    b.upperbound << 1, inf, 2, inf, 3;
+    b.lowerbound << -1, -inf, -inf, 0, -3;
+    alpaqa::vec v(5);
+    v << std::numeric_limits<alpaqa::real_t>::quiet_NaN(), 5, 7, -inf, -2;
+
+    alpaqa::vec expected(5);
+    expected << -1, 5, 2, 0, -2;
+    alpaqa::vec result = alpaqa::project(v, b);
+    EXPECT_THAT(print_wrap(result), EigenEqual(print_wrap(expected)));
+}
+
+TEST(Box, distSquared) {
+    alpaqa::Box b{alpaqa::vec(3), alpaqa::vec(3)};
+    b.upperbound << 10, 11, 12;
+    b.lowerbound << -12, -11, -10;
+    alpaqa::vec v(3), Σ(3);
+    v << 11, -14, -5;
+    Σ << 2, 3, 4;
+
+    EXPECT_DOUBLE_EQ(alpaqa::dist_squared(v, b), 1 + 9);
+    EXPECT_DOUBLE_EQ(alpaqa::dist_squared(v, b, Σ), 2 * 1 + 3 * 9);
+}
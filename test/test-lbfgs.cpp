@@ -1,3 +1,4 @@
+#include <alpaqa/inner/directions/compact-lbfgs.hpp>
 #include <alpaqa/inner/directions/lbfgs.hpp>
 
 #include <limits>
@@ -62,3 +63,99 @@ TEST(LBFGS, quadratic) {
     EXPECT_NEAR(x(0), 0, 1e-10);
     EXPECT_NEAR(x(1), 0, 1e-10);
 }
+
+TEST(CompactLBFGS, sameAsTwoLoop) {
+    using namespace alpaqa;
+    const size_t n = 6;
+    LBFGSParams param;
+    param.memory = 3;
+    LBFGS lbfgs(param, n);
+    CompactLBFGS compact(param, n);
+
+    // f(x) = ½ xᵀAx + ¼ ∑ xᵢ⁴, so the updates are accepted and the circular
+    // buffer wraps around
+    mat A = mat::Random(n, n);
+    A     = A.transpose() * A + mat::Identity(n, n);
+    auto grad_f = [&A](crvec x) {
+        return vec(A * x + vec(x.array().pow(3)));
+    };
+    vec x = vec::LinSpaced(n, -1, 1);
+    vec r = grad_f(x);
+    for (size_t i = 0; i < 5; ++i) {
+        vec d = r;
+        lbfgs.apply(d, 0.1);
+        vec x_new = x - d;
+        vec r_new = grad_f(x_new);
+        EXPECT_TRUE(lbfgs.update(x, x_new, r, r_new, LBFGS::Sign::Positive));
+        EXPECT_TRUE(
+            compact.update(x, x_new, r, r_new, CompactLBFGS::Sign::Positive));
+        x = std::move(x_new);
+        r = std::move(r_new);
+
+        vec q = vec::Random(n), q_compact = q;
+        EXPECT_TRUE(lbfgs.apply(q, 0.1));
+        EXPECT_TRUE(compact.apply(q_compact, 0.1));
+        EXPECT_THAT(print_wrap(q_compact),
+                    EigenAlmostEqual(print_wrap(q), 1e-10));
+        // Step size based on the most recent pair
+        q = q_compact = vec::Random(n);
+        lbfgs.apply(q, -1);
+        compact.apply(q_compact, -1);
+        EXPECT_THAT(print_wrap(q_compact),
+                    EigenAlmostEqual(print_wrap(q), 1e-10));
+    }
+
+    lbfgs.scale_y(0.5);
+    compact.scale_y(0.5);
+    vec q = vec::Random(n), q_compact = q;
+    lbfgs.apply(q, 0.1);
+    compact.apply(q_compact, 0.1);
+    EXPECT_THAT(print_wrap(q_compact),
+                EigenAlmostEqual(print_wrap(q), 1e-10));
+
+    compact.reset();
+    EXPECT_FALSE(compact.apply(q_compact, 0.1));
+}
+
+TEST(LBFGS, packedSubspace) {
+    using namespace alpaqa;
+    const size_t n = 8;
+    LBFGSParams param;
+    param.memory = 3;
+    LBFGS lbfgs(param, n);
+    param.packed_subspace = true;
+    LBFGS packed(param, n);
+
+    mat A = mat::Random(n, n);
+    A     = A.transpose() * A + mat::Identity(n, n);
+    auto grad_f = [&A](crvec x) {
+        return vec(A * x + vec(x.array().pow(3)));
+    };
+    std::vector<vec::Index> J1{0, 2, 3, 5, 7}, J2{1, 2, 3, 4, 5, 6};
+    vec x = vec::LinSpaced(n, -1, 1);
+    vec r = grad_f(x);
+    for (size_t i = 0; i < 6; ++i) {
+        vec x_new = x - 0.1 * r;
+        vec r_new = grad_f(x_new);
+        EXPECT_TRUE(lbfgs.update(x, x_new, r, r_new, LBFGS::Sign::Positive));
+        EXPECT_TRUE(packed.update(x, x_new, r, r_new, LBFGS::Sign::Positive));
+        x = std::move(x_new);
+        r = std::move(r_new);
+
+        // Apply twice with the same index set (only the newest pair has to be
+        // gathered) and once with a different one, with a given and with
+        // a computed step size
+        for (const auto *J : {&J1, &J1, &J2}) {
+            for (real_t γ : {0.1, -1.}) {
+                vec q = vec::Random(n), q_packed = q;
+                bool success        = lbfgs.apply(q, γ, *J);
+                bool success_packed = packed.apply(q_packed, γ, *J);
+                EXPECT_EQ(success, success_packed);
+                if (success) {
+                    EXPECT_THAT(print_wrap(q_packed),
+                                EigenAlmostEqual(print_wrap(q), 1e-12));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,160 @@
+#include <alpaqa/inner/directions/lbfgs.hpp>
+#include <alpaqa/inner/panoc.hpp>
+#include <alpaqa/multistart-alm.hpp>
+
+#include "eigen-matchers.hpp"
+
+#include <stdexcept>
+
+using namespace alpaqa;
+
+namespace {
+
+/// minimize (x₀² - 1)² + 0.3 x₀ + x₁²  s.t.  -2 ≤ x ≤ 2,  -2 ≤ x₀ + x₁ ≤ 2
+/// Local minima near x₀ = -1 (global, f ≈ -0.31) and x₀ = 1 (f ≈ 0.29).
+Problem build_double_well() {
+    Problem p{2, 1};
+    p.C.lowerbound = vec::Constant(2, -2);
+    p.C.upperbound = vec::Constant(2, +2);
+    p.D.lowerbound = vec::Constant(1, -2);
+    p.D.upperbound = vec::Constant(1, +2);
+    p.f            = [](crvec x) {
+        return std::pow(x(0) * x(0) - 1, 2) + 0.3 * x(0) + x(1) * x(1);
+    };
+    p.grad_f = [](crvec x, rvec g) {
+        g(0) = 4 * x(0) * (x(0) * x(0) - 1) + 0.3;
+        g(1) = 2 * x(1);
+    };
+    p.g           = [](crvec x, rvec g) { g(0) = x(0) + x(1); };
+    p.grad_g_prod = [](crvec, crvec y, rvec g) { g.fill(y(0)); };
+    return p;
+}
+
+ALMSolver<> build_solver(bool preconditioning = false) {
+    ALMParams almparam;
+    almparam.ε               = 1e-8;
+    almparam.δ               = 1e-8;
+    almparam.max_iter        = 50;
+    almparam.preconditioning = preconditioning;
+    return {almparam, {PANOCParams{}, LBFGSParams{}}};
+}
+
+} // namespace
+
+TEST(MultiStartALM, bestOfAll) {
+    auto problem = build_double_well();
+    mat x₀(2, 3);
+    x₀ << 1.2, -1.2, 0.8, //
+        0, 0, 0.1;
+
+    for (unsigned num_threads : {1, 3}) {
+        MultiStartALMParams params;
+        params.num_threads = num_threads;
+        MultiStartALMSolver<> solver{params, build_solver()};
+        vec x = vec::Zero(2), y = vec::Zero(1);
+        auto stats = solver(problem, x₀, y, x);
+        for (auto &run : stats.runs)
+            EXPECT_EQ(run.status, SolverStatus::Converged);
+        ASSERT_TRUE(stats.best);
+        EXPECT_EQ(*stats.best, 1u);
+        EXPECT_NEAR(x(0), -1.04, 1e-2);
+        EXPECT_NEAR(x(1), 0, 1e-6);
+        EXPECT_DOUBLE_EQ(stats.objective(1), problem.f(x));
+        EXPECT_GT(stats.objective(0), stats.objective(1));
+    }
+}
+
+TEST(MultiStartALM, firstGoodEnough) {
+    auto problem = build_double_well();
+    mat x₀(2, 3);
+    x₀ << -1.2, 1.2, 0.8, //
+        0, 0, 0;
+
+    MultiStartALMParams params;
+    params.num_threads = 1;
+    params.policy      = MultiStartPolicy::FirstGoodEnough;
+    MultiStartALMSolver<> solver{params, build_solver()};
+    vec x = vec::Zero(2), y = vec::Zero(1);
+    auto stats = solver(problem, x₀, y, x);
+    EXPECT_EQ(stats.runs[0].status, SolverStatus::Converged);
+    EXPECT_EQ(stats.runs[1].status, SolverStatus::Interrupted);
+    EXPECT_EQ(stats.runs[2].status, SolverStatus::Interrupted);
+    ASSERT_TRUE(stats.best);
+    EXPECT_EQ(*stats.best, 0u);
+    EXPECT_NEAR(x(0), -1.04, 1e-2);
+}
+
+TEST(MultiStartALM, cancelDominated) {
+    auto problem = build_double_well();
+    mat x₀(2, 2);
+    x₀ << -1.2, 1.2, //
+        0, 0;
+
+    MultiStartALMParams params;
+    params.num_threads              = 1;
+    params.dominance_tolerance      = 0.1;
+    params.dominance_check_interval = 1;
+    MultiStartALMSolver<> solver{params, build_solver()};
+    vec x = vec::Zero(2), y = vec::Zero(1);
+    auto stats = solver(problem, x₀, y, x);
+    EXPECT_EQ(stats.runs[0].status, SolverStatus::Converged);
+    EXPECT_FALSE(stats.dominated[0]);
+    EXPECT_EQ(stats.runs[1].status, SolverStatus::Interrupted);
+    EXPECT_TRUE(stats.dominated[1]);
+    ASSERT_TRUE(stats.best);
+    EXPECT_EQ(*stats.best, 0u);
+}
+
+TEST(MultiStartALM, cancelDominatedPreconditioned) {
+    // The offset doesn't change the minimizers, but the preconditioning
+    // scales it down in the inner problem, so the dominance check has to use
+    // the original objective to compare it to the incumbent
+    auto problem = build_double_well();
+    problem.f    = [f{problem.f}](crvec x) { return f(x) + 10; };
+    mat x₀(2, 2);
+    x₀ << -1.2, 1.2, //
+        0, 0;
+
+    MultiStartALMParams params;
+    params.num_threads              = 1;
+    params.dominance_tolerance      = 0.01;
+    params.dominance_check_interval = 1;
+    MultiStartALMSolver<> solver{params, build_solver(true)};
+    vec x = vec::Zero(2), y = vec::Zero(1);
+    auto stats = solver(problem, x₀, y, x);
+    EXPECT_EQ(stats.runs[0].status, SolverStatus::Converged);
+    EXPECT_FALSE(stats.dominated[0]);
+    EXPECT_EQ(stats.runs[1].status, SolverStatus::Interrupted);
+    EXPECT_TRUE(stats.dominated[1]);
+}
+
+TEST(MultiStartALM, exception) {
+    auto problem = build_double_well();
+    problem.grad_f = [grad_f{problem.grad_f}](crvec x, rvec g) {
+        if (x(0) > 0)
+            throw std::domain_error("positive x₀");
+        grad_f(x, g);
+    };
+    mat x₀(2, 4);
+    x₀ << -1, -1, 1, -1, //
+        0, 0, 0, 0;
+    MultiStartALMParams params;
+    params.num_threads = 2;
+    MultiStartALMSolver<> solver{params, build_solver()};
+    vec x = vec::Zero(2), y = vec::Zero(1);
+    EXPECT_THROW(solver(problem, x₀, y, x), std::domain_error);
+}
+
+TEST(MultiStartALM, perturbedStarts) {
+    Box C{vec::Constant(3, 1), vec::Constant(3, -1)};
+    vec x₀ = vec::Constant(3, 0.5);
+    auto starts = MultiStartALMSolver<>::perturbed_starts(x₀, C, 20, 1, 42);
+    ASSERT_EQ(starts.rows(), 3);
+    ASSERT_EQ(starts.cols(), 20);
+    EXPECT_THAT(print_wrap(starts.col(0)), EigenEqual(print_wrap(x₀)));
+    EXPECT_LE(starts.maxCoeff(), 1);
+    EXPECT_GE(starts.minCoeff(), -1);
+    EXPECT_GT((starts.rightCols(19).colwise() - x₀).norm(), 0);
+    auto again = MultiStartALMSolver<>::perturbed_starts(x₀, C, 20, 1, 42);
+    EXPECT_THAT(print_wrap(again), EigenEqual(print_wrap(starts)));
+}
@@ -8,6 +8,11 @@
 #include <alpaqa/inner/detail/panoc-helpers.hpp>
 #include <alpaqa/inner/directions/decl/lbfgs.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <utility>
+
 using alpaqa::crvec;
 using alpaqa::inf;
 using alpaqa::mat;
@@ -208,6 +213,28 @@ Problem build_test_problem2() {
     return p;
 }
 
+// Test the blocked projected gradient step against the plain expressions
+TEST(PANOC, calc_x̂) {
+    // Not a multiple of the block size
+    const auto n = 1000;
+    alpaqa::Box C{vec::Constant(n, 0.5), vec::Constant(n, -0.5)};
+    C.lowerbound(3) = -inf;
+    C.upperbound(4) = +inf;
+    vec x      = vec::Random(n);
+    vec grad_ψ = 10 * vec::Random(n);
+    real_t γ   = 0.03;
+
+    vec x̂(n), p(n);
+    real_t grad_ψᵀp, pᵀp;
+    alpaqa::detail::calc_x̂(C, γ, x, grad_ψ, x̂, p, grad_ψᵀp, pᵀp);
+
+    vec p_expected = alpaqa::project(x - γ * grad_ψ, C) - x;
+    EXPECT_THAT(print_wrap(p), EigenAlmostEqual(print_wrap(p_expected), 1e-15));
+    EXPECT_THAT(print_wrap(x̂), EigenAlmostEqual(print_wrap(x + p), 0));
+    EXPECT_NEAR(grad_ψᵀp, grad_ψ.dot(p), 1e-12);
+    EXPECT_NEAR(pᵀp, p.squaredNorm(), 1e-12);
+}
+
 // Test the evaluation of PANOC's augmented Lagrangian hessian
 TEST(PANOC, hessian) {
     auto p = build_test_problem2();
@@ -529,3 +556,171 @@ TEST(PANOC, ref) {
     EXPECT_THAT(print_wrap(λ), EigenAlmostEqual(print_wrap(λ_ref), 1e-8 * 9e3));
     // TODO: they're not _exactly_ equal, is that a problem?
 }
+
+/// Rosenbrock function with a bound on x₀ and a nonlinear constraint. All
+/// functions are declared thread-safe.
+Problem build_rosenbrock_problem() {
+    using alpaqa::Box;
+    auto f = [](crvec x) {
+        return 100 * std::pow(x(1) - x(0) * x(0), 2) + std::pow(1 - x(0), 2);
+    };
+    auto grad_f = [](crvec x, rvec grad) {
+        grad(0) = -400 * x(0) * (x(1) - x(0) * x(0)) - 2 * (1 - x(0));
+        grad(1) = 200 * (x(1) - x(0) * x(0));
+    };
+    auto g = [](crvec x, rvec g) { g(0) = x(0) * x(0) + x(1) * x(1); };
+    auto grad_g_prod = [](crvec x, crvec y, rvec grad) {
+        grad = 2 * y(0) * x;
+    };
+    Box C{vec::Constant(2, inf), vec::Constant(2, -inf)};
+    C.upperbound(0) = 0.9;
+    Box D{vec::Constant(1, 1.5), vec::Constant(1, -inf)};
+    Problem p{2, 1, C, D, f, grad_f, g, grad_g_prod, {}, {}, {}};
+    p.thread_safe = {true, true, true, true, true};
+    return p;
+}
+
+/// Iterates and solution of @ref solve_rosenbrock_problem.
+struct RosenbrockResult {
+    std::vector<vec> x;
+    std::vector<real_t> τ;
+    alpaqa::PANOCSolver<>::Stats stats;
+    vec x_sol, y_sol;
+};
+
+/// Solve the problem from @ref build_rosenbrock_problem (or a variant of it)
+/// with L-BFGS PANOC, recording all iterates.
+RosenbrockResult solve_rosenbrock_problem(const Problem &p,
+                                          alpaqa::PANOCParams params) {
+    params.max_iter = 500;
+    alpaqa::LBFGSParams lbfgsparams;
+    lbfgsparams.memory = 5;
+    alpaqa::PANOCSolver<> solver{params, lbfgsparams};
+    RosenbrockResult r;
+    solver.set_progress_callback([&](const auto &info) {
+        r.x.emplace_back(info.x);
+        r.τ.push_back(info.τ);
+    });
+    r.x_sol   = vec::Constant(2, -1);
+    r.y_sol   = vec::Constant(1, 0.5);
+    vec err_z = vec::Constant(1, alpaqa::NaN);
+    vec Σ     = vec::Constant(1, 10);
+    r.stats   = solver(p, Σ, 1e-10, true, r.x_sol, r.y_sol, err_z);
+    return r;
+}
+
+/// Check that both solves produced exactly the same iterates.
+void expect_same_iterates(const RosenbrockResult &a,
+                          const RosenbrockResult &b) {
+    EXPECT_EQ(a.stats.status, b.stats.status);
+    EXPECT_EQ(a.stats.iterations, b.stats.iterations);
+    EXPECT_EQ(a.stats.linesearch_failures, b.stats.linesearch_failures);
+    EXPECT_EQ(a.stats.sum_τ, b.stats.sum_τ);
+    ASSERT_EQ(a.x.size(), b.x.size());
+    for (size_t k = 0; k < a.x.size(); ++k) {
+        EXPECT_THAT(print_wrap(a.x[k]), EigenEqual(print_wrap(b.x[k])));
+        if (k > 0) { // τ is NaN before the first line search
+            EXPECT_EQ(a.τ[k], b.τ[k]);
+        }
+    }
+    EXPECT_THAT(print_wrap(a.x_sol), EigenEqual(print_wrap(b.x_sol)));
+    EXPECT_THAT(print_wrap(a.y_sol), EigenEqual(print_wrap(b.y_sol)));
+}
+
+TEST(PANOC, parallelLinesearch) {
+    // Records whether f is ever evaluated by several threads at once
+    std::atomic<unsigned> f_active{0};
+    std::atomic<bool> f_concurrent{false};
+
+    Problem p = build_rosenbrock_problem();
+    p.f       = [&, f{p.f}](crvec x) {
+        if (++f_active > 1)
+            f_concurrent = true;
+        // Give the other threads the time to start evaluating f as well
+        std::this_thread::sleep_for(std::chrono::microseconds(20));
+        --f_active;
+        return f(x);
+    };
+
+    alpaqa::PANOCParams params;
+    auto solve = [&](const Problem &p, unsigned num_candidates) {
+        params.linesearch_parallel_candidates = num_candidates;
+        return solve_rosenbrock_problem(p, params);
+    };
+    auto seq = solve(p, 1);
+    ASSERT_EQ(seq.stats.status, alpaqa::SolverStatus::Converged);
+    // The test is only meaningful if the line search had to backtrack
+    ASSERT_LT(seq.stats.τ_1_accepted, seq.stats.count_τ);
+    EXPECT_FALSE(f_concurrent);
+    for (unsigned num_candidates : {2u, 3u, 8u})
+        expect_same_iterates(solve(p, num_candidates), seq);
+    // Otherwise, the parallel line search wasn't actually used
+    EXPECT_TRUE(f_concurrent);
+
+    // Problems that aren't thread-safe use the sequential line search
+    Problem p_unsafe     = p;
+    p_unsafe.thread_safe = {};
+    f_concurrent         = false;
+    expect_same_iterates(solve(p_unsafe, 8), seq);
+    EXPECT_FALSE(f_concurrent);
+}
+
+TEST(PANOC, concurrentEvaluations) {
+    // Records whether any of the problem functions are ever evaluated by
+    // several threads at once
+    std::atomic<unsigned> active{0};
+    std::atomic<bool> concurrent{false};
+    auto track = [&](auto fun) {
+        return [&active, &concurrent, fun](auto &&...args) {
+            if (++active > 1)
+                concurrent = true;
+            // Give the other thread the time to start its evaluation as well
+            std::this_thread::sleep_for(std::chrono::microseconds(20));
+            struct Done {
+                std::atomic<unsigned> &active;
+                ~Done() { --active; }
+            } done{active};
+            return fun(std::forward<decltype(args)>(args)...);
+        };
+    };
+
+    Problem p     = build_rosenbrock_problem();
+    p.f           = track(p.f);
+    p.grad_f      = track(p.grad_f);
+    p.g           = track(p.g);
+    p.grad_g_prod = track(p.grad_g_prod);
+
+    alpaqa::PANOCParams params;
+    auto solve = [&](const Problem &p, bool concurrent) {
+        params.concurrent_evaluations = concurrent;
+        return solve_rosenbrock_problem(p, params);
+    };
+
+    // ApproxKKT requires ∇ψ(x̂ₖ), which is computed alongside the
+    // quasi-Newton step
+    for (auto crit : {alpaqa::PANOCStopCrit::ProjGradUnitNorm,
+                      alpaqa::PANOCStopCrit::ApproxKKT}) {
+        params.stop_crit = crit;
+        concurrent       = false;
+        auto seq         = solve(p, false);
+        ASSERT_EQ(seq.stats.status, alpaqa::SolverStatus::Converged);
+        EXPECT_FALSE(concurrent);
+        expect_same_iterates(solve(p, true), seq);
+        EXPECT_TRUE(concurrent);
+
+        // Fused evaluation of f and ∇f
+        Problem p_fused  = p;
+        p_fused.f_grad_f = [f{p.f}, grad_f{p.grad_f}](crvec x, rvec grad) {
+            grad_f(x, grad);
+            return f(x);
+        };
+        expect_same_iterates(solve(p_fused, true), seq);
+
+        // Nothing is evaluated in parallel if the problem isn't thread-safe
+        Problem p_unsafe     = p;
+        p_unsafe.thread_safe = {};
+        concurrent           = false;
+        expect_same_iterates(solve(p_unsafe, true), seq);
+        EXPECT_FALSE(concurrent);
+    }
+}
@@ -0,0 +1,138 @@
+#include <alpaqa/inner/directions/lbfgs.hpp>
+#include <alpaqa/inner/guarded-aa-pga.hpp>
+#include <alpaqa/inner/panoc.hpp>
+#include <alpaqa/inner/second-order-panoc.hpp>
+#include <alpaqa/inner/structured-panoc-lbfgs.hpp>
+#include <alpaqa/portfolio-alm.hpp>
+
+#include "eigen-matchers.hpp"
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+using namespace alpaqa;
+
+namespace {
+
+/// minimize ½‖x - a‖²  s.t.  -1 ≤ x ≤ 1,  x₀² + x₁x₂ ≤ ½
+Problem build_test_problem() {
+    Problem p(3, 1);
+    p.C.lowerbound = vec::Constant(3, -1);
+    p.C.upperbound = vec::Constant(3, +1);
+    p.D.lowerbound << -inf;
+    p.D.upperbound << 0.5;
+    p.f = [](crvec x) {
+        vec a(3);
+        a << 2, -1, 0.5;
+        return 0.5 * (x - a).squaredNorm();
+    };
+    p.grad_f = [](crvec x, rvec grad) {
+        vec a(3);
+        a << 2, -1, 0.5;
+        grad = x - a;
+    };
+    p.g = [](crvec x, rvec g) { g(0) = x(0) * x(0) + x(1) * x(2); };
+    p.grad_g_prod = [](crvec x, crvec y, rvec grad) {
+        grad << 2 * x(0) * y(0), x(2) * y(0), x(1) * y(0);
+    };
+    p.grad_gi = [](crvec x, unsigned, rvec grad) {
+        grad << 2 * x(0), x(2), x(1);
+    };
+    p.hess_L_prod = [](crvec, crvec y, crvec v, rvec Hv) {
+        Hv = v;
+        Hv(0) += 2 * y(0) * v(0);
+        Hv(1) += y(0) * v(2);
+        Hv(2) += y(0) * v(1);
+    };
+    p.hess_L = [](crvec, crvec y, rmat H) {
+        H.setIdentity();
+        H(0, 0) += 2 * y(0);
+        H(1, 2) += y(0);
+        H(2, 1) += y(0);
+    };
+    return p;
+}
+
+ALMParams build_alm_params() {
+    ALMParams almparam;
+    almparam.ε        = 1e-8;
+    almparam.δ        = 1e-8;
+    almparam.max_iter = 100;
+    return almparam;
+}
+
+} // namespace
+
+TEST(PortfolioALM, race) {
+    auto problem  = build_test_problem();
+    auto almparam = build_alm_params();
+    GAAPGAParams gaapgaparam;
+    gaapgaparam.max_iter = 1000;
+
+    PortfolioALMSolver<PANOCSolver<LBFGS>, StructuredPANOCLBFGSSolver,
+                       GAAPGASolver, SecondOrderPANOCSolver>
+        solver{
+            {almparam, {PANOCParams{}, LBFGSParams{}}},
+            {almparam, {StructuredPANOCLBFGSParams{}, LBFGSParams{}}},
+            {almparam, gaapgaparam},
+            {almparam, SecondOrderPANOCParams{}},
+        };
+    EXPECT_EQ(solver.get_name(),
+              "PortfolioALMSolver<" + std::get<0>(solver.solvers).get_name() +
+                  ", " + std::get<1>(solver.solvers).get_name() + ", " +
+                  std::get<2>(solver.solvers).get_name() + ", " +
+                  std::get<3>(solver.solvers).get_name() + ">");
+
+    vec x = vec::Zero(3), y = vec::Zero(1);
+    auto stats = solver(problem, y, x);
+    ASSERT_TRUE(stats.winner);
+
+    ALMSolver<> ref_solver{almparam, {PANOCParams{}, LBFGSParams{}}};
+    vec x_ref = vec::Zero(3), y_ref = vec::Zero(1);
+    auto ref_stats = ref_solver(problem, y_ref, x_ref);
+    ASSERT_EQ(ref_stats.status, SolverStatus::Converged);
+    EXPECT_THAT(print_wrap(x), EigenAlmostEqual(print_wrap(x_ref), 1e-6));
+    EXPECT_THAT(print_wrap(y), EigenAlmostEqual(print_wrap(y_ref), 1e-6));
+}
+
+TEST(PortfolioALM, stopsOthers) {
+    // The first solver runs on the calling thread, the evaluations of the
+    // second solver are made artificially slow, so it would need much longer
+    // than the first one if it weren't stopped
+    auto problem = build_test_problem();
+    auto main_id = std::this_thread::get_id();
+    problem.grad_f = [main_id, grad_f{problem.grad_f}](crvec x, rvec grad) {
+        if (std::this_thread::get_id() != main_id)
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        grad_f(x, grad);
+    };
+    auto almparam = build_alm_params();
+    PortfolioALMSolver<PANOCSolver<LBFGS>, PANOCSolver<LBFGS>> solver{
+        {almparam, {PANOCParams{}, LBFGSParams{}}},
+        {almparam, {PANOCParams{}, LBFGSParams{}}},
+    };
+
+    vec x = vec::Zero(3), y = vec::Zero(1);
+    auto stats = solver(problem, y, x);
+    ASSERT_TRUE(stats.winner);
+    EXPECT_EQ(*stats.winner, 0u);
+    EXPECT_EQ(std::get<0>(stats.solvers).status, SolverStatus::Converged);
+    EXPECT_EQ(std::get<1>(stats.solvers).status, SolverStatus::Interrupted);
+    EXPECT_LT(std::get<1>(stats.solvers).inner.iterations,
+              std::get<0>(stats.solvers).inner.iterations);
+}
+
+TEST(PortfolioALM, exception) {
+    auto problem   = build_test_problem();
+    problem.grad_f = [](crvec, rvec) {
+        throw std::domain_error("no gradient");
+    };
+    auto almparam = build_alm_params();
+    PortfolioALMSolver<PANOCSolver<LBFGS>, GAAPGASolver> solver{
+        {almparam, {PANOCParams{}, LBFGSParams{}}},
+        {almparam, GAAPGAParams{}},
+    };
+    vec x = vec::Zero(3), y = vec::Zero(1);
+    EXPECT_THROW(solver(problem, y, x), std::domain_error);
+}
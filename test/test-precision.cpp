@@ -0,0 +1,141 @@
+#include <alpaqa/alm.hpp>
+#include <alpaqa/inner/directions/lbfgs.hpp>
+#include <alpaqa/inner/directions/specialized-lbfgs.hpp>
+#include <alpaqa/inner/panoc.hpp>
+#include <alpaqa/inner/structured-panoc-lbfgs.hpp>
+
+#include "eigen-matchers.hpp"
+#include "equality-problem.hpp"
+
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+/// @file
+/// Smoke tests that are also built when alpaqa uses a different floating
+/// point type (see `WITH_SINGLE_PRECISION` and `LBFGS_HISTORY_TYPE`), so all
+/// tolerances are relative to the machine epsilon of alpaqa::real_t and
+/// alpaqa::lbfgs_history_t.
+
+namespace {
+
+/// Tolerance of the solvers, relative to the precision of real_t.
+alpaqa::real_t precision_tolerance() {
+    return std::sqrt(std::numeric_limits<alpaqa::real_t>::epsilon());
+}
+
+/// Solve @ref build_equality_problem with the given solver, and check the
+/// solution with a tolerance that is relative to the precision of real_t.
+template <class InnerSolver>
+void check_precision_solve(alpaqa::ALMSolver<InnerSolver> &solver) {
+    using namespace alpaqa;
+    SCOPED_TRACE(solver.get_name());
+    const real_t tol = precision_tolerance();
+
+    auto p = build_equality_problem();
+    vec x(2), y(1);
+    x << real_t(0.5), real_t(0.5);
+    y << 1;
+    auto stats = solver(p, y, x);
+
+    vec x_sol(2);
+    x_sol << real_t(-10) / 22, real_t(1) / 22;
+    EXPECT_EQ(stats.status, SolverStatus::Converged);
+    EXPECT_THAT(print_wrap(x), EigenAlmostEqual(print_wrap(x_sol), 10 * tol));
+    EXPECT_LE(stats.δ, tol);
+}
+
+} // namespace
+
+TEST(Precision, PANOC) {
+    using namespace alpaqa;
+    PANOCParams panocparam;
+    panocparam.max_iter = 200;
+    LBFGSParams lbfgsparam;
+    lbfgsparam.memory = 5;
+    auto almparam = build_equality_alm_params(precision_tolerance());
+    ALMSolver<> solver{almparam, {panocparam, lbfgsparam}};
+    check_precision_solve(solver);
+}
+
+TEST(Precision, StructuredPANOCLBFGS) {
+    using namespace alpaqa;
+    StructuredPANOCLBFGSParams panocparam;
+    panocparam.max_iter = 200;
+    LBFGSParams lbfgsparam;
+    lbfgsparam.memory = 5;
+    auto almparam = build_equality_alm_params(precision_tolerance());
+    ALMSolver<StructuredPANOCLBFGSSolver> solver{almparam,
+                                                 {panocparam, lbfgsparam}};
+    check_precision_solve(solver);
+}
+
+TEST(Precision, lbfgsHistory) {
+    using namespace alpaqa;
+    mat H(3, 3);
+    H << 4, 1, 0, //
+        1, 3, real_t(0.5), //
+        0, real_t(0.5), 2;
+    auto grad_f = [&H](crvec x) { return vec(H * x); };
+
+    LBFGSParams param;
+    param.memory = 3;
+    LBFGS lbfgs(param, 3);
+    vec x(3);
+    x << 1, real_t(-0.3), real_t(0.7);
+    vec r = grad_f(x);
+    for (size_t i = 0; i < 3; ++i) {
+        vec d = r;
+        if (i > 0) {
+            ASSERT_TRUE(lbfgs.apply(d, -1));
+        }
+        // The direction is a descent direction
+        EXPECT_GT(r.dot(d), 0);
+        vec x_new = x - real_t(0.25) * d;
+        vec r_new = grad_f(x_new);
+        ASSERT_TRUE(lbfgs.update(x, x_new, r, r_new, LBFGS::Sign::Positive));
+        // ρ is consistent with the stored vectors, which are rounded to
+        // lbfgs_history_t
+        real_t sᵀy = lbfgs.s(i).cast<real_t>().dot(lbfgs.y(i).cast<real_t>());
+        EXPECT_EQ(lbfgs.ρ(i), 1 / sᵀy);
+        x = std::move(x_new);
+        r = std::move(r_new);
+    }
+}
+
+TEST(Precision, specializedLbfgsHistory) {
+    using namespace alpaqa;
+    mat H(3, 3);
+    H << 4, 1, 0, //
+        1, 3, real_t(0.5), //
+        0, real_t(0.5), 2;
+    auto grad_f = [&H](crvec x) { return vec(H * x); };
+    Box C{vec::Constant(3, inf), vec::Constant(3, -inf)};
+
+    LBFGSParams param;
+    SpecializedLBFGS lbfgs(param, 3, 5); // memory for all pairs
+    vec x(3);
+    x << 1, real_t(-0.3), real_t(0.7);
+    vec grad = grad_f(x);
+    lbfgs.initialize(x, grad);
+    // The step size changes in the third iteration, so the stored y vectors
+    // (and their ρ) are recomputed by full_update
+    const real_t γs[] = {real_t(0.25), real_t(0.25), real_t(0.2), real_t(0.2)};
+    for (size_t k = 0; k < std::size(γs); ++k) {
+        real_t γ     = γs[k];
+        vec p        = -γ * grad;
+        vec x_new    = x + p;
+        vec grad_new = grad_f(x_new);
+        vec p_new    = -γ * grad_new;
+        ASSERT_TRUE(lbfgs.update(x, x_new, p, p_new, grad_new, C, γ));
+        // ρ is consistent with the stored vectors, which are rounded to
+        // lbfgs_history_t
+        for (size_t i = 0; i <= k; ++i) {
+            real_t sᵀy =
+                lbfgs.s(i).cast<real_t>().dot(lbfgs.y(i).cast<real_t>());
+            EXPECT_EQ(lbfgs.ρ(i), 1 / sᵀy);
+        }
+        x    = std::move(x_new);
+        grad = std::move(grad_new);
+    }
+}
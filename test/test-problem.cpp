@@ -1,5 +1,7 @@
 #include <iomanip>
 #include <alpaqa-ref/fd.hpp>
+#include <alpaqa/detail/alm-helpers.hpp>
+#include <alpaqa/inner/detail/panoc-helpers.hpp>
 #include <alpaqa/util/problem.hpp>
 
 #include "eigen-matchers.hpp"
@@ -113,3 +115,307 @@ TEST(Problem, onlyD) {
     EXPECT_THAT(print_wrap(gr_gD3), EigenAlmostEqual(print_wrap(fd_gD3), 1e-4));
     EXPECT_THAT(print_wrap(gr_gD4), EigenAlmostEqual(print_wrap(fd_gD4), 1e-4));
 }
+
+TEST(Problem, fusedEvaluations) {
+    Problem split(3, 2);
+    split.D.lowerbound << -1, 0;
+    split.D.upperbound << 1, 0;
+    split.f      = [](crvec x) { return x.squaredNorm() + x(0) * x(2); };
+    split.grad_f = [](crvec x, rvec g) {
+        g = 2 * x;
+        g(0) += x(2);
+        g(2) += x(0);
+    };
+    split.g = [](crvec x, rvec g) {
+        g(0) = x(0) * x(1);
+        g(1) = x(1) + x(2) * x(2);
+    };
+    split.grad_g_prod = [](crvec x, crvec y, rvec g) {
+        g(0) = x(1) * y(0);
+        g(1) = x(0) * y(0) + y(1);
+        g(2) = 2 * x(2) * y(1);
+    };
+
+    Problem fused = split;
+    fused.f_grad_f = [&split](crvec x, rvec g) {
+        split.grad_f(x, g);
+        return split.f(x);
+    };
+    fused.grad_L = [&split](crvec x, crvec y, rvec g) {
+        vec work(3);
+        split.grad_f(x, g);
+        split.grad_g_prod(x, y, work);
+        g += work;
+    };
+
+    vec x(3), y(2), Σ(2);
+    x << 0.3, -1.7, 2.1;
+    y << 0.5, -0.25;
+    Σ << 10, 20;
+    vec grad_split(3), grad_fused(3), work_n(3), work_m(2);
+
+    real_t ψ_split = detail::calc_ψ_grad_ψ(split, x, y, Σ, grad_split, work_n,
+                                           work_m);
+    vec ŷ_split    = work_m;
+
+    ProblemWithCounters<Problem> counted(fused);
+    real_t ψ_fused = detail::calc_ψ_grad_ψ(counted, x, y, Σ, grad_fused,
+                                           work_n, work_m);
+    EXPECT_NEAR(ψ_fused, ψ_split, 1e-12);
+    EXPECT_THAT(print_wrap(grad_fused),
+                EigenAlmostEqual(print_wrap(grad_split), 1e-12));
+    EXPECT_THAT(print_wrap(work_m), EigenAlmostEqual(print_wrap(ŷ_split), 1e-12));
+    EXPECT_EQ(counted.evaluations->f_grad_f, 1);
+    EXPECT_EQ(counted.evaluations->f, 0);
+    EXPECT_EQ(counted.evaluations->grad_f, 0);
+
+    detail::calc_grad_ψ_from_ŷ(counted, x, ŷ_split, grad_fused, work_n);
+    EXPECT_THAT(print_wrap(grad_fused),
+                EigenAlmostEqual(print_wrap(grad_split), 1e-12));
+    EXPECT_EQ(counted.evaluations->grad_L, 1);
+    EXPECT_EQ(counted.evaluations->grad_f, 0);
+    EXPECT_EQ(counted.evaluations->grad_g_prod, 1);
+
+    fused.ψ_grad_ψ = [&split](crvec x, crvec y, crvec Σ, const Box &,
+                              rvec grad_ψ, rvec ŷ) {
+        vec work_n(3);
+        return detail::calc_ψ_grad_ψ(split, x, y, Σ, grad_ψ, work_n, ŷ);
+    };
+    ProblemWithCounters<Problem> counted_ψ(fused);
+    real_t ψ_ψ = detail::calc_ψ_grad_ψ(counted_ψ, x, y, Σ, grad_fused, work_n,
+                                       work_m);
+    EXPECT_EQ(ψ_ψ, ψ_split);
+    EXPECT_THAT(print_wrap(grad_fused), EigenEqual(print_wrap(grad_split)));
+    EXPECT_EQ(counted_ψ.evaluations->ψ_grad_ψ, 1);
+    EXPECT_EQ(counted_ψ.evaluations->f_grad_f, 0);
+    EXPECT_EQ(counted_ψ.evaluations->g, 0);
+
+    fused.ψ = [&split](crvec x, crvec y, crvec Σ, const Box &, rvec ŷ) {
+        return detail::calc_ψ_ŷ(split, x, y, Σ, ŷ);
+    };
+    ProblemWithCounters<Problem> counted_ψ_ŷ(fused);
+    real_t ψ_ŷ = detail::calc_ψ_ŷ(counted_ψ_ŷ, x, y, Σ, work_m);
+    EXPECT_EQ(ψ_ŷ, ψ_split);
+    EXPECT_THAT(print_wrap(work_m), EigenEqual(print_wrap(ŷ_split)));
+    EXPECT_EQ(counted_ψ_ŷ.evaluations->ψ, 1);
+    EXPECT_EQ(counted_ψ_ŷ.evaluations->f, 0);
+    EXPECT_EQ(counted_ψ_ŷ.evaluations->g, 0);
+
+    // The preconditioned problem scales and forwards the fused evaluations
+    fused.thread_safe.g = fused.thread_safe.grad_g_prod = true;
+    detail::Preconditioning prec_split, prec_fused;
+    detail::apply_preconditioning(split, x, prec_split);
+    detail::apply_preconditioning(fused, x, prec_fused);
+    EXPECT_TRUE(prec_fused.problem.thread_safe.g);
+    EXPECT_FALSE(prec_fused.problem.thread_safe.f);
+    // The scaled ∇g(x) y uses a work vector in prec_fused
+    EXPECT_FALSE(prec_fused.problem.thread_safe.grad_g_prod);
+    ASSERT_NE(prec_fused.f, 1);
+    ProblemWithCounters<Problem> counted_prec(prec_fused.problem);
+    vec grad_prec(3), ŷ_prec(2);
+    real_t ψ_prec = detail::calc_ψ_grad_ψ(prec_split.problem, x, y, Σ,
+                                          grad_prec, work_n, ŷ_prec);
+    real_t ψ_prec_fused = detail::calc_ψ_grad_ψ(counted_prec, x, y, Σ,
+                                                grad_fused, work_n, work_m);
+    EXPECT_NEAR(ψ_prec_fused, ψ_prec, 1e-12);
+    EXPECT_THAT(print_wrap(grad_fused),
+                EigenAlmostEqual(print_wrap(grad_prec), 1e-12));
+    EXPECT_THAT(print_wrap(work_m), EigenAlmostEqual(print_wrap(ŷ_prec), 1e-12));
+    ψ_prec_fused = detail::calc_ψ_ŷ(counted_prec, x, y, Σ, work_m);
+    EXPECT_NEAR(ψ_prec_fused, ψ_prec, 1e-12);
+    EXPECT_THAT(print_wrap(work_m), EigenAlmostEqual(print_wrap(ŷ_prec), 1e-12));
+    detail::calc_grad_ψ_from_ŷ(counted_prec, x, ŷ_prec, grad_fused, work_n);
+    EXPECT_THAT(print_wrap(grad_fused),
+                EigenAlmostEqual(print_wrap(grad_prec), 1e-12));
+    real_t f_prec_fused = counted_prec.f_grad_f(x, grad_fused);
+    prec_split.problem.grad_f(x, grad_prec);
+    EXPECT_NEAR(f_prec_fused, prec_split.problem.f(x), 1e-12);
+    EXPECT_THAT(print_wrap(grad_fused),
+                EigenAlmostEqual(print_wrap(grad_prec), 1e-12));
+    EXPECT_EQ(counted_prec.evaluations->ψ_grad_ψ, 1);
+    EXPECT_EQ(counted_prec.evaluations->ψ, 1);
+    EXPECT_EQ(counted_prec.evaluations->grad_L, 1);
+    EXPECT_EQ(counted_prec.evaluations->f_grad_f, 1);
+    EXPECT_EQ(counted_prec.evaluations->f, 0);
+    EXPECT_EQ(counted_prec.evaluations->g, 0);
+}
+
+TEST(Problem, sparseJacobian) {
+    Problem p(3, 2);
+    p.D.lowerbound << -1, 0;
+    p.D.upperbound << 1, 0;
+    p.f      = [](crvec x) { return 0.5 * x.squaredNorm(); };
+    p.grad_f = [](crvec x, rvec g) { g = x; };
+    p.g      = [](crvec x, rvec g) {
+        g(0) = x(0) * x(1);
+        g(1) = x(1) + x(2) * x(2);
+    };
+    p.grad_g_prod = [](crvec x, crvec y, rvec g) {
+        g(0) = x(1) * y(0);
+        g(1) = x(0) * y(0) + y(1);
+        g(2) = 2 * x(2) * y(1);
+    };
+    p.grad_gi = [](crvec x, unsigned i, rvec g) {
+        if (i == 0)
+            g << x(1), x(0), 0;
+        else
+            g << 0, 1, 2 * x(2);
+    };
+    p.hess_L = [](crvec x, crvec y, rmat H) {
+        (void)x;
+        H.setIdentity();
+        H(0, 1) += y(0);
+        H(1, 0) += y(0);
+        H(2, 2) += 2 * y(1);
+    };
+    Problem p_sparse = p;
+    // Pattern deliberately not in row- or column-major order
+    p_sparse.jac_g_sparsity.rows = 2;
+    p_sparse.jac_g_sparsity.cols = 3;
+    p_sparse.jac_g_sparsity.row  = {1, 0, 1, 0};
+    p_sparse.jac_g_sparsity.col  = {2, 0, 1, 1};
+    p_sparse.jac_g               = [](crvec x, rvec J) {
+        J << 2 * x(2), x(1), 1, x(0);
+    };
+
+    vec x(3), y(2), Σ(2);
+    x << 1.3, -2.7, 0.9;
+    y << 0.5, -0.25;
+    Σ << 10, 20;
+
+    // Jacobian matrix
+    mat J_dense(2, 3);
+    vec grad_gi(3);
+    for (unsigned i = 0; i < 2; ++i) {
+        p.grad_gi(x, i, grad_gi);
+        J_dense.row(i) = grad_gi.transpose();
+    }
+    SparseJacobian jac;
+    jac.set_pattern(p_sparse.jac_g_sparsity);
+    p_sparse.jac_g(x, jac.nonzeros);
+    jac.update();
+    mat J_sparse = jac.matrix();
+    EXPECT_THAT(print_wrap(J_sparse), EigenEqual(print_wrap(J_dense)));
+
+    // Hessian of the augmented Lagrangian
+    vec ŷ(2), g(2), work_n(3);
+    detail::calc_ψ_ŷ(p, x, y, Σ, ŷ);
+    mat H_dense(3, 3), H_sparse(3, 3);
+    ProblemWithCounters<Problem> p_dense_counted(p);
+    detail::calc_augmented_lagrangian_hessian(p_dense_counted, x, ŷ, y, Σ, g,
+                                              H_dense, work_n);
+    // Without a sparsity pattern, the gradient of each active constraint is
+    // evaluated separately
+    EXPECT_GT(p_dense_counted.evaluations->grad_gi, 0);
+    EXPECT_EQ(p_dense_counted.evaluations->jac_g, 0);
+    ProblemWithCounters<Problem> p_counted(p_sparse);
+    SparseJacobian jac_work;
+    detail::calc_augmented_lagrangian_hessian(p_counted, x, ŷ, y, Σ, g,
+                                              H_sparse, work_n, jac_work);
+    EXPECT_THAT(print_wrap(H_sparse),
+                EigenAlmostEqual(print_wrap(H_dense), 1e-12));
+    EXPECT_EQ(p_counted.evaluations->jac_g, 1);
+    EXPECT_EQ(p_counted.evaluations->grad_gi, 0);
+
+    // Row norms for preconditioning
+    detail::Preconditioning prec_dense, prec_sparse;
+    detail::apply_preconditioning(p, x, prec_dense);
+    detail::apply_preconditioning(p_counted, x, prec_sparse);
+    EXPECT_EQ(prec_sparse.f, prec_dense.f);
+    EXPECT_THAT(print_wrap(prec_sparse.g), EigenEqual(print_wrap(prec_dense.g)));
+    EXPECT_EQ(p_counted.evaluations->jac_g, 2);
+    EXPECT_EQ(p_counted.evaluations->grad_g_prod, 0);
+    vec prec_J(4), expected_prec_J(4);
+    prec_sparse.problem.jac_g(x, prec_J);
+    p_sparse.jac_g(x, expected_prec_J);
+    for (Eigen::Index k = 0; k < 4; ++k)
+        expected_prec_J(k) *= prec_dense.g(p_sparse.jac_g_sparsity.row[k]);
+    EXPECT_THAT(print_wrap(prec_J), EigenEqual(print_wrap(expected_prec_J)));
+}
+
+TEST(Problem, evalCache) {
+    Problem p(3, 2);
+    p.D.lowerbound << -1, 0;
+    p.D.upperbound << 1, 0;
+    p.f      = [](crvec x) { return x.squaredNorm() + x(0) * x(2); };
+    p.grad_f = [](crvec x, rvec g) {
+        g = 2 * x;
+        g(0) += x(2);
+        g(2) += x(0);
+    };
+    p.g = [](crvec x, rvec g) {
+        g(0) = x(0) * x(1);
+        g(1) = x(1) + x(2) * x(2);
+    };
+    p.grad_g_prod = [](crvec x, crvec y, rvec g) {
+        g(0) = x(1) * y(0);
+        g(1) = x(0) * y(0) + y(1);
+        g(2) = 2 * x(2) * y(1);
+    };
+
+    ProblemWithCounters<Problem> counted(p);
+    ProblemWithCache<Problem> cached(counted, 2);
+    auto &ev = *counted.evaluations;
+
+    vec x0(3), x1(3), x2(3), y(2), Σ(2);
+    x0 << 0.3, -1.7, 2.1;
+    x1 << 0.4, -1.6, 2.0;
+    x2 << 0.5, -1.5, 1.9;
+    y << 0.5, -0.25;
+    Σ << 10, 20;
+
+    // Penalty initialization and the first PANOC evaluation in x0
+    vec Σ_init(2), ŷ(2), ŷ_ref(2);
+    ALMParams almparams;
+    almparams.Σ₀ = 0;
+    vec work_m(2);
+    detail::initialize_penalty(cached, almparams, x0, Σ_init, work_m);
+    real_t ψ     = detail::calc_ψ_ŷ(cached, x0, y, Σ, ŷ);
+    real_t ψ_ref = detail::calc_ψ_ŷ(p, x0, y, Σ, ŷ_ref);
+    EXPECT_EQ(ψ, ψ_ref);
+    EXPECT_THAT(print_wrap(ŷ), EigenEqual(print_wrap(ŷ_ref)));
+    EXPECT_EQ(ev.f, 1);
+    EXPECT_EQ(ev.g, 1);
+    EXPECT_EQ(cached.cache->hits, 2);
+
+    // Gradient in x0 is not cached yet, in x1 nothing is cached
+    vec grad(3), grad_ref(3);
+    cached.grad_f(x0, grad);
+    cached.grad_f(x0, grad);
+    p.grad_f(x0, grad_ref);
+    EXPECT_THAT(print_wrap(grad), EigenEqual(print_wrap(grad_ref)));
+    EXPECT_EQ(ev.grad_f, 1);
+    EXPECT_EQ(cached.f(x1), p.f(x1));
+    EXPECT_EQ(ev.f, 2);
+
+    // x0 and x1 are both remembered, evaluating in x2 evicts x0
+    cached.f(x0);
+    cached.f(x1);
+    EXPECT_EQ(ev.f, 2);
+    cached.f(x2);
+    cached.f(x1);
+    EXPECT_EQ(ev.f, 3);
+    cached.f(x0);
+    EXPECT_EQ(ev.f, 4);
+
+    // Functions of other arguments than x are not cached
+    cached.grad_g_prod(x0, y, grad);
+    cached.grad_g_prod(x0, y, grad);
+    EXPECT_EQ(ev.grad_g_prod, 2);
+
+    cached.cache->clear();
+    cached.f(x0);
+    EXPECT_EQ(ev.f, 5);
+
+    // The shared cache isn't synchronized, so nothing can be evaluated in
+    // parallel, even if the original problem allows it
+    Problem p_thread_safe       = p;
+    p_thread_safe.thread_safe.f = p_thread_safe.thread_safe.g = true;
+    ProblemWithCache<Problem> cached_thread_safe(p_thread_safe);
+    EXPECT_FALSE(detail::thread_safety(cached_thread_safe).f);
+    EXPECT_FALSE(detail::thread_safety(cached_thread_safe).g);
+    // Neither are the counters
+    ProblemWithCounters<Problem> counted_thread_safe(p_thread_safe);
+    EXPECT_FALSE(detail::thread_safety(counted_thread_safe).f);
+    EXPECT_FALSE(detail::thread_safety(counted_thread_safe).g);
+}
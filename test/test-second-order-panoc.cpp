@@ -0,0 +1,292 @@
+#include <alpaqa/inner/second-order-panoc.hpp>
+
+#include "eigen-matchers.hpp"
+
+namespace {
+alpaqa::Problem build_second_order_test_problem() {
+    using namespace alpaqa;
+    // f(x) = ½‖x - a‖² + ¼ ∑ (xᵢ₊₁ - xᵢ)⁴,
+    // g(x) = (x₀² + x₁² + x₂², xₙ₋₂ + xₙ₋₁)
+    const unsigned n = 8;
+    Problem p(n, 2);
+    p.C.lowerbound = vec::Constant(n, -1);
+    p.C.upperbound = vec::Constant(n, +1);
+    p.D.lowerbound << -inf, -inf;
+    p.D.upperbound << 0.5, 0.25;
+    auto a = [] { return vec::LinSpaced(n, 2, -2); };
+    p.f    = [a](crvec x) {
+        auto d = x.tail(n - 1) - x.head(n - 1);
+        return 0.5 * (x - a()).squaredNorm() + 0.25 * d.array().pow(4).sum();
+    };
+    p.grad_f = [a](crvec x, rvec grad) {
+        vec d3 = (x.tail(n - 1) - x.head(n - 1)).array().pow(3);
+        grad   = x - a();
+        grad.tail(n - 1) += d3;
+        grad.head(n - 1) -= d3;
+    };
+    p.g = [](crvec x, rvec g) {
+        g(0) = x.head(3).squaredNorm();
+        g(1) = x(n - 2) + x(n - 1);
+    };
+    p.grad_gi = [](crvec x, unsigned i, rvec grad) {
+        grad.setZero();
+        if (i == 0) {
+            grad.head(3) = 2 * x.head(3);
+        } else {
+            grad(n - 2) = 1;
+            grad(n - 1) = 1;
+        }
+    };
+    p.grad_g_prod = [gi{p.grad_gi}](crvec x, crvec y, rvec grad) {
+        vec grad_gi(x.size());
+        grad.setZero();
+        for (unsigned i = 0; i < 2; ++i) {
+            gi(x, i, grad_gi);
+            grad += y(i) * grad_gi;
+        }
+    };
+    p.hess_L = [](crvec x, crvec y, rmat H) {
+        vec d2 = 3 * (x.tail(n - 1) - x.head(n - 1)).array().square();
+        H.setIdentity();
+        for (unsigned i = 0; i + 1 < n; ++i) {
+            H(i, i) += d2(i);
+            H(i + 1, i + 1) += d2(i);
+            H(i, i + 1) -= d2(i);
+            H(i + 1, i) -= d2(i);
+        }
+        H.diagonal().head(3).array() += 2 * y(0);
+    };
+    // Tridiagonal pattern, including the elements below the diagonal
+    for (unsigned i = 0; i < n; ++i) {
+        for (unsigned j = i > 0 ? i - 1 : 0; j < std::min(i + 2, n); ++j) {
+            p.hess_L_sparsity.row.push_back(i);
+            p.hess_L_sparsity.col.push_back(j);
+        }
+    }
+    p.hess_L_sparsity.rows = p.hess_L_sparsity.cols = n;
+    p.hess_L_sparse = [hess_L{p.hess_L}, sp{p.hess_L_sparsity}](
+                          crvec x, crvec y, rvec H_values) {
+        mat H(x.size(), x.size());
+        hess_L(x, y, H);
+        for (Eigen::Index k = 0; k < sp.nnz(); ++k)
+            H_values(k) = H(sp.row[k], sp.col[k]);
+    };
+    p.jac_g_sparsity.rows = 2;
+    p.jac_g_sparsity.cols = n;
+    p.jac_g_sparsity.row  = {0, 0, 0, 1, 1};
+    p.jac_g_sparsity.col  = {0, 1, 2, n - 2, n - 1};
+    p.jac_g               = [](crvec x, rvec J_values) {
+        J_values << 2 * x(0), 2 * x(1), 2 * x(2), 1, 1;
+    };
+    return p;
+}
+} // namespace
+
+TEST(SecondOrderPANOC, sparseHessian) {
+    using namespace alpaqa;
+
+    Problem p_sparse = build_second_order_test_problem();
+    Problem p_dense  = p_sparse;
+    p_dense.hess_L_sparse = nullptr;
+    ProblemWithCounters<Problem> p_sparse_counted(p_sparse);
+    ProblemWithCounters<Problem> p_dense_counted(p_dense);
+
+    SecondOrderPANOCParams params;
+    params.max_iter = 200;
+
+    vec Σ(2);
+    Σ << 1e2, 1e2;
+    real_t ε = 1e-10;
+
+    vec x_sparse = vec::Zero(p_sparse.n), y_sparse = vec::Zero(2);
+    vec err_z_sparse(2);
+    SecondOrderPANOCSolver solver_sparse{params};
+    auto stats_sparse = solver_sparse(p_sparse_counted, Σ, ε, true, x_sparse,
+                                      y_sparse, err_z_sparse);
+    // A second solve reuses the symbolic factorization
+    vec x_sparse2 = vec::Zero(p_sparse.n), y_sparse2 = vec::Zero(2);
+    vec err_z_sparse2(2);
+    auto stats_sparse2 = solver_sparse(p_sparse_counted, Σ, ε, true, x_sparse2,
+                                       y_sparse2, err_z_sparse2);
+
+    vec x_dense = vec::Zero(p_dense.n), y_dense = vec::Zero(2);
+    vec err_z_dense(2);
+    SecondOrderPANOCSolver solver_dense{params};
+    auto stats_dense = solver_dense(p_dense_counted, Σ, ε, true, x_dense,
+                                    y_dense, err_z_dense);
+
+    EXPECT_EQ(stats_sparse.status, SolverStatus::Converged);
+    EXPECT_EQ(stats_sparse2.status, SolverStatus::Converged);
+    EXPECT_EQ(stats_dense.status, SolverStatus::Converged);
+    EXPECT_EQ(stats_sparse.newton_failures, 0);
+    EXPECT_THAT(print_wrap(x_sparse),
+                EigenAlmostEqual(print_wrap(x_dense), 1e-8));
+    EXPECT_THAT(print_wrap(y_sparse),
+                EigenAlmostEqual(print_wrap(y_dense), 1e-6));
+    EXPECT_THAT(print_wrap(x_sparse2),
+                EigenAlmostEqual(print_wrap(x_sparse), 1e-12));
+    EXPECT_EQ(stats_sparse.iterations, stats_sparse2.iterations);
+
+    // The dense Hessian is never evaluated when the sparse one is available
+    EXPECT_GT(p_sparse_counted.evaluations->hess_L_sparse, 0);
+    EXPECT_EQ(p_sparse_counted.evaluations->hess_L, 0);
+    EXPECT_EQ(p_dense_counted.evaluations->hess_L_sparse, 0);
+    EXPECT_GT(p_dense_counted.evaluations->hess_L, 0);
+}
+
+TEST(SecondOrderPANOC, reuseHessian) {
+    using namespace alpaqa;
+
+    Problem p = build_second_order_test_problem();
+    p.hess_L_sparse = nullptr;
+    ProblemWithCounters<Problem> p_reuse_counted(p);
+    ProblemWithCounters<Problem> p_counted(p);
+
+    SecondOrderPANOCParams params;
+    params.max_iter = 200;
+
+    vec Σ(2);
+    Σ << 1e2, 1e2;
+    real_t ε = 1e-10;
+
+    vec x = vec::Zero(p.n), y = vec::Zero(2), err_z(2);
+    SecondOrderPANOCSolver solver{params};
+    auto stats = solver(p_counted, Σ, ε, true, x, y, err_z);
+
+    params.hessian_update_interval = 4;
+    vec x_reuse = vec::Zero(p.n), y_reuse = vec::Zero(2), err_z_reuse(2);
+    SecondOrderPANOCSolver solver_reuse{params};
+    auto stats_reuse = solver_reuse(p_reuse_counted, Σ, ε, true, x_reuse,
+                                    y_reuse, err_z_reuse);
+
+    EXPECT_EQ(stats.status, SolverStatus::Converged);
+    EXPECT_EQ(stats_reuse.status, SolverStatus::Converged);
+    EXPECT_THAT(print_wrap(x_reuse), EigenAlmostEqual(print_wrap(x), 1e-8));
+    EXPECT_THAT(print_wrap(y_reuse), EigenAlmostEqual(print_wrap(y), 1e-6));
+
+    // The Hessian is evaluated at most once every four iterations
+    EXPECT_EQ(p_counted.evaluations->hess_L, stats.iterations);
+    EXPECT_LE(p_reuse_counted.evaluations->hess_L,
+              (stats_reuse.iterations + 3) / 4);
+    // Without reuse, every Newton step is factorized from scratch
+    EXPECT_EQ(stats.factorizations, p_counted.evaluations->hess_L);
+    EXPECT_EQ(stats.factorization_updates, 0u);
+    // With reuse, every new Hessian is factorized once, and in between, the
+    // factorization is updated when the inactive indices change
+    EXPECT_GE(stats_reuse.factorizations, p_reuse_counted.evaluations->hess_L);
+    EXPECT_LT(stats_reuse.factorizations, stats_reuse.iterations);
+    EXPECT_GT(stats_reuse.factorization_updates, 0u);
+}
+
+TEST(SecondOrderPANOC, singularHessian) {
+    using namespace alpaqa;
+
+    // f(x) = ½ (x₀ + x₁ - 1)², with a positive semidefinite, singular Hessian
+    Problem p(2, 0);
+    p.f = [](crvec x) { return 0.5 * std::pow(x(0) + x(1) - 1, 2); };
+    p.grad_f = [](crvec x, rvec grad) { grad.fill(x(0) + x(1) - 1); };
+    p.g           = [](crvec, rvec) {};
+    p.grad_g_prod = [](crvec, crvec, rvec grad) { grad.setZero(); };
+    p.grad_gi     = [](crvec, unsigned, rvec grad) { grad.setZero(); };
+    p.hess_L      = [](crvec, crvec, rmat H) { H.setOnes(); };
+
+    SecondOrderPANOCParams params;
+    params.max_iter = 100;
+
+    vec Σ(0), y(0), err_z(0);
+    vec x(2);
+    x << 3, -1;
+    SecondOrderPANOCSolver solver{params};
+    auto stats = solver(p, Σ, 1e-10, true, x, y, err_z);
+
+    // The LDLᵀ factorization accepts the semidefinite Hessian, and its
+    // solution is the exact Newton step
+    EXPECT_EQ(stats.status, SolverStatus::Converged);
+    EXPECT_EQ(stats.newton_failures, 0u);
+    EXPECT_GT(stats.factorizations, 0u);
+    EXPECT_LE(stats.iterations, 2u);
+    EXPECT_NEAR(x(0) + x(1), 1, 1e-10);
+}
+
+TEST(SecondOrderPANOC, matrixFree) {
+    using namespace alpaqa;
+
+    Problem p = build_second_order_test_problem();
+    p.hess_L_sparse = nullptr;
+    p.hess_L_prod   = [hess_L{p.hess_L}](crvec x, crvec y, crvec v, rvec Hv) {
+        mat H(x.size(), x.size());
+        hess_L(x, y, H);
+        Hv = H * v;
+    };
+    ProblemWithCounters<Problem> p_counted(p);
+    Problem p_no_jac = p;
+    p_no_jac.jac_g   = nullptr;
+    ProblemWithCounters<Problem> p_no_jac_counted(p_no_jac);
+
+    SecondOrderPANOCParams params;
+    params.max_iter = 200;
+
+    vec Σ(2);
+    Σ << 1e2, 1e2;
+    real_t ε = 1e-10;
+
+    vec x = vec::Zero(p.n), y = vec::Zero(2), err_z(2);
+    SecondOrderPANOCSolver solver{params};
+    auto stats = solver(p, Σ, ε, true, x, y, err_z);
+
+    params.matrix_free = true;
+    vec x_cg = vec::Zero(p.n), y_cg = vec::Zero(2), err_z_cg(2);
+    SecondOrderPANOCSolver solver_cg{params};
+    auto stats_cg = solver_cg(p_counted, Σ, ε, true, x_cg, y_cg, err_z_cg);
+    // Without the sparse Jacobian, the gradients of the active constraints
+    // are evaluated in each product, and there is no preconditioner
+    vec x_gi = vec::Zero(p.n), y_gi = vec::Zero(2), err_z_gi(2);
+    auto stats_gi =
+        solver_cg(p_no_jac_counted, Σ, ε, true, x_gi, y_gi, err_z_gi);
+
+    EXPECT_EQ(stats.status, SolverStatus::Converged);
+    EXPECT_EQ(stats_cg.status, SolverStatus::Converged);
+    EXPECT_EQ(stats_gi.status, SolverStatus::Converged);
+    EXPECT_THAT(print_wrap(x_cg), EigenAlmostEqual(print_wrap(x), 1e-8));
+    EXPECT_THAT(print_wrap(y_cg), EigenAlmostEqual(print_wrap(y), 1e-6));
+    EXPECT_THAT(print_wrap(x_gi), EigenAlmostEqual(print_wrap(x), 1e-8));
+    EXPECT_GT(stats_cg.cg_iterations, 0);
+
+    // The Hessian matrix is never evaluated
+    EXPECT_EQ(p_counted.evaluations->hess_L, 0);
+    EXPECT_GT(p_counted.evaluations->hess_L_prod, 0);
+    EXPECT_EQ(p_no_jac_counted.evaluations->hess_L, 0);
+    EXPECT_EQ(p_no_jac_counted.evaluations->jac_g, 0);
+}
+
+TEST(NewtonCG, steihaug) {
+    using namespace alpaqa;
+
+    mat A(4, 4);
+    A << 4, 1, 0, 0, //
+        1, 3, 1, 0,  //
+        0, 1, 2, 1,  //
+        0, 0, 1, 5;
+    vec b(4);
+    b << 1, -2, 3, 0.5;
+    vec M = A.diagonal();
+    vec x(4), r(4), z(4), p(4), Hp(4);
+    auto hess_prod = [&](crvec v, rvec Hv) { Hv = A * v; };
+
+    NewtonCGParams params;
+    params.η_max = 1e-12;
+    auto stats   = steihaug_cg(params, hess_prod, b, M, x, r, z, p, Hp);
+    EXPECT_FALSE(stats.negative_curvature);
+    EXPECT_LE(stats.iterations, 4);
+    EXPECT_THAT(print_wrap(x),
+                EigenAlmostEqual(print_wrap(A.ldlt().solve(b)), 1e-10));
+
+    // Truncate on negative curvature in the first iteration
+    params.preconditioning = false;
+    A(0, 0) = -4;
+    b       = vec::Unit(4, 0);
+    stats   = steihaug_cg(params, hess_prod, b, M, x, r, z, p, Hp);
+    EXPECT_TRUE(stats.negative_curvature);
+    EXPECT_EQ(stats.iterations, 1);
+    EXPECT_THAT(print_wrap(x), EigenAlmostEqual(print_wrap(b), 0));
+}
@@ -0,0 +1,103 @@
+#include <alpaqa/inner/structured-panoc-lbfgs.hpp>
+
+#include "eigen-matchers.hpp"
+
+namespace {
+alpaqa::Problem build_structured_test_problem() {
+    using namespace alpaqa;
+    // f(x) = ½‖x - a‖², g(x) = x₀² + x₁x₂
+    Problem p(3, 1);
+    p.C.lowerbound = vec::Constant(3, -1);
+    p.C.upperbound = vec::Constant(3, +1);
+    p.D.lowerbound << -inf;
+    p.D.upperbound << 0.5;
+    p.f = [](crvec x) {
+        vec a(3);
+        a << 2, -1, 0.5;
+        return 0.5 * (x - a).squaredNorm();
+    };
+    p.grad_f = [](crvec x, rvec grad) {
+        vec a(3);
+        a << 2, -1, 0.5;
+        grad = x - a;
+    };
+    p.g = [](crvec x, rvec g) { g(0) = x(0) * x(0) + x(1) * x(2); };
+    p.grad_g_prod = [](crvec x, crvec y, rvec grad) {
+        grad << 2 * x(0) * y(0), x(2) * y(0), x(1) * y(0);
+    };
+    p.grad_gi = [](crvec x, unsigned, rvec grad) {
+        grad << 2 * x(0), x(2), x(1);
+    };
+    p.hess_L_prod = [](crvec, crvec y, crvec v, rvec Hv) {
+        Hv = v;
+        Hv(0) += 2 * y(0) * v(0);
+        Hv(1) += y(0) * v(2);
+        Hv(2) += y(0) * v(1);
+    };
+    return p;
+}
+} // namespace
+
+TEST(StructuredPANOCLBFGS, exactHessianProd) {
+    using namespace alpaqa;
+
+    Problem p_loop = build_structured_test_problem();
+    Problem p_ψ    = p_loop;
+    p_ψ.hess_ψ_prod = [&p_loop](crvec x, crvec y, crvec Σ, const Box &D,
+                                crvec v, rvec Hv) {
+        vec g(1), ŷ(1), grad_g(3);
+        p_loop.g(x, g);
+        real_t ζ = g(0) + y(0) / Σ(0);
+        ŷ(0)     = Σ(0) * (ζ - std::clamp(ζ, D.lowerbound(0), D.upperbound(0)));
+        p_loop.hess_L_prod(x, ŷ, v, Hv);
+        if (not(D.lowerbound(0) < ζ && ζ < D.upperbound(0))) {
+            p_loop.grad_gi(x, 0, grad_g);
+            Hv += Σ(0) * grad_g.dot(v) * grad_g;
+        }
+    };
+    ProblemWithCounters<Problem> p_ψ_counted(p_ψ);
+    ProblemWithCounters<Problem> p_loop_counted(p_loop);
+
+    StructuredPANOCLBFGSParams params;
+    params.max_iter                       = 200;
+    params.hessian_vec_finite_differences = false;
+    LBFGSParams lbfgsparams;
+    lbfgsparams.memory = 5;
+
+    vec Σ(1);
+    Σ << 1e2;
+    real_t ε = 1e-10;
+
+    vec x_ψ(3), y_ψ(1), err_z_ψ(1);
+    x_ψ << 0, 0, 0;
+    y_ψ << 0;
+    StructuredPANOCLBFGSSolver solver_ψ{params, lbfgsparams};
+    auto stats_ψ = solver_ψ(p_ψ_counted, Σ, ε, true, x_ψ, y_ψ, err_z_ψ);
+
+    vec x_loop(3), y_loop(1), err_z_loop(1);
+    x_loop << 0, 0, 0;
+    y_loop << 0;
+    StructuredPANOCLBFGSSolver solver_loop{params, lbfgsparams};
+    auto stats_loop =
+        solver_loop(p_loop_counted, Σ, ε, true, x_loop, y_loop, err_z_loop);
+
+    EXPECT_EQ(stats_ψ.status, SolverStatus::Converged);
+    EXPECT_EQ(stats_loop.status, SolverStatus::Converged);
+    EXPECT_THAT(print_wrap(x_ψ), EigenAlmostEqual(print_wrap(x_loop), 1e-8));
+    EXPECT_THAT(print_wrap(y_ψ), EigenAlmostEqual(print_wrap(y_loop), 1e-6));
+
+    // The exact product replaces the per-constraint gradient evaluations
+    EXPECT_GT(p_ψ_counted.evaluations->hess_ψ_prod, 0);
+    EXPECT_EQ(p_ψ_counted.evaluations->hess_L_prod, 0);
+    EXPECT_EQ(p_ψ_counted.evaluations->grad_gi, 0);
+    EXPECT_EQ(p_loop_counted.evaluations->hess_ψ_prod, 0);
+
+    // Gradients of single constraints are counted separately from the
+    // gradient-vector products
+    vec grad_gi(3);
+    unsigned grad_g_prod_evals = p_loop_counted.evaluations->grad_g_prod;
+    unsigned grad_gi_evals     = p_loop_counted.evaluations->grad_gi;
+    p_loop_counted.grad_gi(x_loop, 0, grad_gi);
+    EXPECT_EQ(p_loop_counted.evaluations->grad_gi, grad_gi_evals + 1);
+    EXPECT_EQ(p_loop_counted.evaluations->grad_g_prod, grad_g_prod_evals);
+}